@@ -0,0 +1,454 @@
+// Author: Jason Tennyson
+// File: AutoTuner.cpp
+// Date: 10/19/26
+//
+// This file contains the implementation of the tuner. A trial runs the
+// workload the way the duration test does, for TUNE_TRIAL_MSECS, and its
+// score is the operations per second. A configuration's score is the mean of
+// its trials, and every round runs one trial of every configuration before
+// it runs a second of any, so that a slow stretch of the machine hits all of
+// them and not just one.
+//
+// The budget is split over the rounds that are left each time a round
+// starts, so time lost to starting threads in one round comes out of the
+// ones after it instead of running over. A configuration whose workload
+// comes out wrong (data hazards) is dropped, no matter how fast it was.
+
+#include "AutoTuner.h"
+#include "ThreadTutorial.h"
+#include "FastRandom.h"
+#include "TimedRun.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include <sched.h>
+
+using namespace std;
+
+// These are the names of the placements, in the order of placementType.
+static const char* placementNames[PLACEMENT_TYPES] = { "none", "compact", "spread" };
+
+// These are Student's t values for 95% confidence, by degrees of freedom
+// from 1 to 30. After 30 the normal value of 1.96 is close enough.
+static const double tValues[30] = { 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+				    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+				    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042 };
+
+// This structure is one configuration and what its trials came to.
+struct tuneArm
+{
+	unsigned int threads;		// Threads to run.
+	placementType placement;	// Where to put them.
+	syncType strategy;		// How to protect the shared variable.
+	unsigned int chunk;		// Operations between stop flag checks.
+	unsigned int rounds;		// Rounds it made it into.
+	unsigned int trials;		// Trials run.
+	double sum;			// Sum of the trial scores.
+	double sumSquares;		// Sum of their squares.
+	float result;			// Worst result of any trial.
+};
+
+// This structure is what each thread owns during a trial.
+struct tuneSlot
+{
+	unsigned long long ops;		// Operations done so far.
+	unsigned int index;		// Index of the thread.
+	char pad[CACHE_LINE_SIZE - sizeof(unsigned long long) - sizeof(unsigned int)];
+};
+
+// This is the configuration that the trial being run is for.
+static workload* tuneKernel;
+static unsigned int tuneThreads, tuneChunk;
+static placementType tunePlacement;
+static vector<int> tuneCpus;
+
+// This function returns the name of a placement.
+const char* placementName(placementType type)
+{
+	return ((type < PLACEMENT_TYPES) ? placementNames[type] : "unknown");
+}
+
+// This function returns the mean score of a configuration.
+static double armMean(const tuneArm& arm)
+{
+	return (arm.trials ? arm.sum/arm.trials : 0);
+}
+
+// This function returns how far the 95% confidence bounds of a
+// configuration's mean go on either side of it. With one trial there is no
+// telling, so it returns the mean itself.
+static double armMargin(const tuneArm& arm)
+{
+	if(arm.trials < 2)
+	{
+		return armMean(arm);
+	}
+
+	double mean = armMean(arm);
+	double variance = (arm.sumSquares - arm.trials*mean*mean)/(arm.trials - 1);
+	double t = (arm.trials <= 30) ? tValues[arm.trials - 2] : 1.96;
+
+	return t*sqrt((variance > 0) ? variance : 0)/sqrt((double)arm.trials);
+}
+
+// This function returns the low 95% confidence bound of a configuration's
+// mean. A wide margin can reach below zero, but a rate can't, so the bound
+// stops at zero.
+static double armLow(const tuneArm& arm)
+{
+	double low = armMean(arm) - armMargin(arm);
+
+	return ((low > 0) ? low : 0);
+}
+
+// This function returns the score used to rank a configuration. Ones that
+// came out wrong go to the bottom.
+static double armScore(const tuneArm& arm)
+{
+	return ((arm.result < 1.0f) ? -1 : armMean(arm));
+}
+
+// This function orders configurations from the best score down.
+static bool betterArm(const tuneArm* a, const tuneArm* b)
+{
+	return (armScore(*a) > armScore(*b));
+}
+
+// This function orders configurations for the spreadsheet: the ones that
+// lasted longest first, and the best score first among those.
+static bool laterArm(const tuneArm& a, const tuneArm& b)
+{
+	return ((a.rounds != b.rounds) ? (a.rounds > b.rounds) : (armScore(a) > armScore(b)));
+}
+
+// This function returns how many rounds are left when count configurations
+// are still in, counting the one about to start. Every round halves them,
+// and the last round is the one with two left.
+static unsigned int roundsLeft(unsigned int count)
+{
+	unsigned int rounds = 1;
+
+	while(count > 2)
+	{
+		count = (count + 1)/2;
+		rounds++;
+	}
+
+	return rounds;
+}
+
+// This is the function that each thread runs during a trial.
+static void* tuneGenerator(void* slotObject)
+{
+	tuneSlot* slot = (tuneSlot*)slotObject;
+
+	// Pin ourselves first, if we are supposed to be pinned.
+	if((tunePlacement != PLACE_NONE) && !tuneCpus.empty())
+	{
+		unsigned int cpuCount = tuneCpus.size();
+		unsigned int position = slot->index%cpuCount;
+
+		if(tunePlacement == PLACE_SPREAD)
+		{
+			position = ((unsigned long long)slot->index*cpuCount/tuneThreads)%cpuCount;
+		}
+
+		cpu_set_t cpus;
+		CPU_ZERO(&cpus);
+		CPU_SET(tuneCpus[position], &cpus);
+		pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+	}
+
+	timedRunBegin();
+
+	// Run the kernel a chunk at a time until we are told to stop.
+	while(!timedRunOver())
+	{
+		tuneKernel->run(slot->index, tuneChunk);
+		slot->ops += tuneChunk;
+	}
+
+	return (NULL);
+}
+
+// This function runs one trial of a configuration and adds it to the
+// configuration's scores.
+static void runTrial(tuneArm* arm, const char* kernelName, const workloadConfig& config)
+{
+	workloadConfig armConfig = config;
+	armConfig.strategy = arm->strategy;
+
+	tuneKernel = createWorkload(kernelName, armConfig);
+	tuneThreads = arm->threads;
+	tuneChunk = arm->chunk;
+	tunePlacement = arm->placement;
+
+	tuneSlot* slots = allocateThreadSlots<tuneSlot>(tuneThreads);
+	if(!slots)
+	{
+		delete tuneKernel;
+		arm->result = 0;
+		return;
+	}
+
+	tuneKernel->prepare(tuneThreads);
+
+	for(unsigned int i = 0; i < tuneThreads; i++)
+	{
+		slots[i].index = i;
+	}
+
+	double elapsedSecs;
+	if(!runTimedThreads(tuneGenerator, slots, sizeof(tuneSlot), tuneThreads, TUNE_TRIAL_MSECS,
+			    &elapsedSecs, NULL, NULL, 0))
+	{
+		cout << "Could not create the threads!\n";
+		delete tuneKernel;
+		freeThreadSlots(slots);
+		arm->result = 0;
+		return;
+	}
+
+	unsigned long long totalOps = 0;
+	for(unsigned int i = 0; i < tuneThreads; i++)
+	{
+		totalOps += slots[i].ops;
+	}
+
+	float result = tuneKernel->finish(totalOps);
+	double score = totalOps/elapsedSecs;
+
+	arm->trials++;
+	arm->sum += score;
+	arm->sumSquares += score*score;
+	arm->result = (result < arm->result) ? result : arm->result;
+
+	delete tuneKernel;
+	freeThreadSlots(slots);
+}
+
+// This function prints a configuration on one line.
+static void printArm(const tuneArm& arm, bool locked)
+{
+	cout << arm.threads << " threads, " << placementName(arm.placement) << " placement, ";
+	if(locked)
+	{
+		cout << syncName(arm.strategy) << ", ";
+	}
+	cout << "chunk " << arm.chunk << ": " << (unsigned long long)armMean(arm) << " ops/sec";
+}
+
+// This function runs the tuner.
+bool runAutoTune(const char* filename, const char* kernelName, const workloadConfig& config,
+		 const syncType* strategies, unsigned int strategyCount,
+		 unsigned int maxThreads, unsigned int budgetSecs)
+{
+	// Make sure that we know the workload before doing anything else.
+	workload* probe = createWorkload(kernelName, config);
+	if(!probe)
+	{
+		return false;
+	}
+	delete probe;
+
+	// Find the CPUs that we are allowed on. There is nothing to place
+	// if there is only one.
+	cpu_set_t allowed;
+	tuneCpus.clear();
+	if(sched_getaffinity(0, sizeof(allowed), &allowed) == 0)
+	{
+		for(int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+		{
+			if(CPU_ISSET(cpu, &allowed))
+			{
+				tuneCpus.push_back(cpu);
+			}
+		}
+	}
+	unsigned int placementCount = (tuneCpus.size() > 1) ? PLACEMENT_TYPES : 1;
+
+	// The strategy only matters if there is a safe shared variable.
+	bool locked = config.shared && config.safe;
+	if(!locked || (strategyCount == 0))
+	{
+		strategies = &config.strategy;
+		strategyCount = 1;
+	}
+
+	// Build the whole grid.
+	vector<tuneArm> grid;
+	for(unsigned int threadNo = MIN_THREADS; threadNo <= maxThreads; threadNo++)
+	{
+		for(unsigned int p = 0; p < placementCount; p++)
+		{
+			for(unsigned int s = 0; s < strategyCount; s++)
+			{
+				unsigned int chunk = TUNE_MIN_CHUNK;
+
+				for(unsigned int c = 0; c < TUNE_CHUNKS; c++)
+				{
+					tuneArm arm;
+					memset(&arm, 0, sizeof(arm));
+					arm.threads = threadNo;
+					arm.placement = (placementType)p;
+					arm.strategy = strategies[s];
+					arm.chunk = chunk;
+					arm.result = 1.0f;
+					grid.push_back(arm);
+
+					chunk *= TUNE_CHUNK_STEP;
+				}
+			}
+		}
+	}
+
+	unsigned long long budgetNsecs = (unsigned long long)budgetSecs*1000000000ULL;
+	unsigned long long trialNsecs = (unsigned long long)TUNE_TRIAL_MSECS*1000000ULL;
+	unsigned long long startNsecs = timeStamp::monotonicNsecs();
+
+	// If the first round can't give every configuration a trial, pick
+	// the ones that get in at random. The rounds after the first need
+	// about as much time again, since each has half as many in it.
+	unsigned int affordable = budgetNsecs/(2*trialNsecs);
+	affordable = (affordable < 2) ? 2 : affordable;
+	unsigned int gridSize = grid.size();
+
+	if(grid.size() > affordable)
+	{
+		fastRandom random;
+		random.seed(DEFAULT_RANDOM_SEED);
+
+		for(unsigned int i = 0; i < affordable; i++)
+		{
+			swap(grid[i], grid[i + random.below(grid.size() - i)]);
+		}
+		grid.resize(affordable);
+	}
+
+	cout << "Searching " << grid.size() << " of " << gridSize << " configurations for about "
+	     << budgetSecs << " sec...\n";
+
+	vector<tuneArm*> alive;
+	for(unsigned int i = 0; i < grid.size(); i++)
+	{
+		alive.push_back(&grid[i]);
+	}
+
+	for(unsigned int round = 1; ; round++)
+	{
+		// Split what is left of the budget over the rounds that are left.
+		unsigned long long usedNsecs = timeStamp::monotonicNsecs() - startNsecs;
+		unsigned long long leftNsecs = (usedNsecs < budgetNsecs) ? (budgetNsecs - usedNsecs) : 0;
+		bool last = (alive.size() <= 2);
+		unsigned int trials = leftNsecs/roundsLeft(alive.size())/(alive.size()*trialNsecs);
+
+		if(trials < (last ? TUNE_FINAL_TRIALS : 1))
+		{
+			trials = (last ? TUNE_FINAL_TRIALS : 1);
+		}
+
+		cout << "Round " << round << ": " << alive.size() << " configurations, "
+		     << trials << " trial(s) each\n";
+
+		for(unsigned int t = 0; t < trials; t++)
+		{
+			for(unsigned int i = 0; i < alive.size(); i++)
+			{
+				if(alive[i]->result >= 1.0f)
+				{
+					runTrial(alive[i], kernelName, config);
+				}
+			}
+		}
+
+		for(unsigned int i = 0; i < alive.size(); i++)
+		{
+			alive[i]->rounds = round;
+		}
+
+		sort(alive.begin(), alive.end(), betterArm);
+
+		if(last)
+		{
+			break;
+		}
+
+		// Keep the better half.
+		alive.resize((alive.size() + 1)/2);
+	}
+
+	// Save every configuration that was tried.
+	string tempFilename = SPREADSHEET_FOLDER;
+	tempFilename += "/";
+	tempFilename += filename;
+
+	ofstream dataDump(tempFilename.c_str());
+
+	// Write the top line of the data file.
+	dataDump << "Threads,Placement,Strategy,Chunk,Rounds,Trials,Mean Ops/Sec,"
+		 << "Low Ops/Sec (95%),High Ops/Sec (95%),Result\n";
+
+	vector<tuneArm> tried(grid);
+	sort(tried.begin(), tried.end(), laterArm);
+
+	for(unsigned int i = 0; i < tried.size(); i++)
+	{
+		double mean = armMean(tried[i]);
+		double margin = armMargin(tried[i]);
+
+		dataDump << tried[i].threads << "," << placementName(tried[i].placement) << ","
+			 << (locked ? syncName(tried[i].strategy) : "unused") << "," << tried[i].chunk << ","
+			 << tried[i].rounds << "," << tried[i].trials << "," << (unsigned long long)mean << ","
+			 << (unsigned long long)armLow(tried[i]) << "," << (unsigned long long)(mean + margin) << ","
+			 << tried[i].result << "\n";
+	}
+
+	// Append an extra new line character to the end of the file.
+	dataDump << "\n";
+	dataDump.close();
+
+	// Print the winner in a form that can be copied into a config file.
+	const tuneArm& best = *alive[0];
+	double margin = armMargin(best);
+
+	if(best.result < 1.0f)
+	{
+		cout << "\nEvery configuration that made it to the end came out wrong!\n";
+		return true;
+	}
+
+	cout << "\nBest configuration, from " << best.trials << " trials:\n"
+	     << "\tthreads=" << best.threads << "\n"
+	     << "\tplacement=" << placementName(best.placement) << "\n";
+	if(locked)
+	{
+		cout << "\tsync=" << syncName(best.strategy) << "\n";
+	}
+	cout << "\tchunk=" << best.chunk << "\n"
+	     << "\tops/sec=" << (unsigned long long)armMean(best) << " (95% confidence: "
+	     << (unsigned long long)armLow(best) << " to "
+	     << (unsigned long long)(armMean(best) + margin) << ")\n";
+
+	// Say whether the runner up can really be told apart from it.
+	if((alive.size() > 1) && (alive[1]->result >= 1.0f))
+	{
+		const tuneArm& second = *alive[1];
+
+		cout << "Runner up: ";
+		printArm(second, locked);
+
+		if((armMean(best) - margin) > (armMean(second) + armMargin(second)))
+		{
+			cout << "\nThe best is ahead by more than the confidence bounds.\n";
+		}
+		else
+		{
+			cout << "\nTheir confidence bounds overlap, so either one will do.\n";
+		}
+	}
+
+	cout << "\n";
+
+	return true;
+}
@@ -0,0 +1,62 @@
+// Author: Jason Tennyson
+// File: AutoTuner.h
+// Date: 10/19/26
+//
+// This file contains the definitions for the tuner. The automatic tests run
+// every cell of a grid and leave it to whoever reads the spreadsheet to pick
+// the best one. The tuner picks it instead. It runs a workload the way the
+// duration test does, and searches over the thread count, where the threads
+// are placed, how the shared variable is protected and how many operations a
+// thread does between checks (the chunk), all within a time budget.
+//
+// The grid gets big fast, so it is not run in full. The tuner uses
+// successive halving: every configuration gets a few short trials, the
+// worse half is dropped, and the rest get more trials, until two are left.
+// Configurations that are clearly bad are found out in one trial and cost
+// almost nothing, so most of the budget goes to telling the good ones apart.
+// If the grid is bigger than the first round can afford, the configurations
+// that get into the first round are picked at random.
+//
+// The threads can be placed three ways:
+//
+//	none		The scheduler puts them wherever it likes.
+//	compact		Thread i is pinned to the i-th CPU we are allowed on,
+//			so the threads are packed onto neighbouring CPUs.
+//	spread		The threads are pinned as far apart as the allowed CPUs
+//			go.
+
+#ifndef AutoTuner_h_
+#define AutoTuner_h_
+
+#include "Workload.h"
+
+#define DEFAULT_TUNE_BUDGET	(60)				// Default search budget (secs).
+#define TUNE_TRIAL_MSECS	(50)				// Length of one trial (ms).
+#define TUNE_MIN_CHUNK		(64)				// Smallest chunk tried.
+#define TUNE_CHUNK_STEP		(4)				// Chunk multiplier per step.
+#define TUNE_CHUNKS		(5)				// Number of chunks tried.
+#define TUNE_FINAL_TRIALS	(2)				// Fewest trials in the last round.
+
+// These are the ways that the threads can be placed.
+enum placementType
+{
+	PLACE_NONE = 0,		// Not pinned.
+	PLACE_COMPACT,		// Pinned to neighbouring CPUs.
+	PLACE_SPREAD,		// Pinned as far apart as possible.
+	PLACEMENT_TYPES		// The number of placements.
+};
+
+// This function returns the name of a placement.
+const char* placementName(placementType type);
+
+// This function searches for the fastest way to run the workload with the
+// given name and settings, with 1 up to maxThreads threads and the given
+// strategies, in about budgetSecs. It prints the best configuration with
+// its 95% confidence bounds and saves every configuration that was tried to
+// filename in the spreadsheet folder. The strategies only matter if the
+// settings share a safe variable. Returns false if there is no such workload.
+bool runAutoTune(const char* filename, const char* kernelName, const workloadConfig& config,
+		 const syncType* strategies, unsigned int strategyCount,
+		 unsigned int maxThreads, unsigned int budgetSecs);
+
+#endif
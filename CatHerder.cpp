@@ -6,15 +6,16 @@
 // functions used in the catHerder class.
 
 #include "CatHerder.h"
+#include "FastRandom.h"
 
 using namespace std;
 
-// This is the constructor for the catHerder class. It initializes the
-// random number generator, and allocates all of the memory required
+// This is the constructor for the catHerder class. It seeds the random
+// number generator from the clock, and allocates all of the memory required
 // for the random scoldings the user is given for not following directions.
 catHerder::catHerder(void)
 {
-	srand(time(NULL));	// Initialize the random generator.
+	setRandomSeed(time(NULL));	// Initialize the random generator.
 
 	numResponses = 0;	// Initialize the number of responses to 0.
 	impatience = 0;		// We are very tolerant right now.
@@ -56,14 +57,16 @@ void catHerder::randomScolding(void)
 	// If you have had it up to or beyond "here" with this person, let them hear about it.
 	if(impatience >= UP_TO_HERE)
 	{
-		// This float is the 0-1 decimal value of the random generation.
-		float RNG;
+		// This is the 0-1 decimal value of the random generation.
+		double RNG;
 
 		// This is the index of the response we decide to print.
 		int responseIndex;
 
-		// Generate the random floating point number between 0 and 1.
-		RNG = ((float)rand() / (float)RAND_MAX);
+		// Generate the random floating point number from 0 up to 1. It
+		// comes from this thread's own generator, so it never waits on
+		// another thread the way rand() can.
+		RNG = threadRandom()->unit();
 
 		// Multiply the total number of responses by RNG to give us a decimal value
 		// between 0 and numResponses, then shove it into the integer for the response index.
@@ -98,16 +101,17 @@ void catHerder::addResponse(const char* response)
 }
 
 // This function converts a 32 bit unsigned integer input to a string.
-const char* catHerder::unsignedToString(unsigned int input)
+// The digits are written straight into the caller's buffer, which must
+// have room for 11 characters, so nothing is allocated along the way.
+void catHerder::unsignedToString(unsigned int input, char* output)
 {
-	char* tempInput = new char[11];		// Make room to store input temp.
-	int index = 0;				// Temp input index.
+	int index = 0;				// Output index.
 	unsigned int divisor = 1000000000;	// At least 10 digits in input.
 
-	// Initialize all of the characters in tempInput to null.
+	// Initialize all of the characters in output to null.
 	for(int i = 0; i < 11; i++)
 	{
-		tempInput[i] = '\0';
+		output[i] = '\0';
 	}
 
 	// If we have a nonzero value, convert it, else, just return 0.
@@ -133,7 +137,7 @@ const char* catHerder::unsignedToString(unsigned int input)
 			// Find how many times divisor will fit into the input
 			// and add 48 to convert it to an ascii character
 			// equivalent of the integer.
-			tempInput[index] = 48 + (input/divisor);
+			output[index] = 48 + (input/divisor);
 
 			// Subtract the digit we just found off of the input.
 			input = input - ((input/divisor)*divisor);
@@ -150,17 +154,8 @@ const char* catHerder::unsignedToString(unsigned int input)
 	else
 	{
 		// If we don't have a divisor, we must have a zero as an input.
-		tempInput[0] = '0';
+		output[0] = '0';
 	}
-
-	// Duplicate the converted input and point a const char* at it.
-	const char* convertedInput = strdup(tempInput);
-
-	// Delete the memory that we allocated for storing the conversion.
-	delete [] tempInput;
-
-	// Return the pointer to our conversion.
-	return convertedInput;
 }
 
 // This function waits for the user to put in a correct response as a string,
@@ -176,12 +171,15 @@ unsigned int catHerder::askForUnsignedInt(const char* query, const unsigned int
 	// Only proceed if it is possible to receive a number in between max and min.
 	if(max >= min)
 	{
-		string minString;	// Stores the string equivalent of min.
-		string maxString;	// Stores the string equivalent of max.
-	
+		char minDigits[11];	// Stores the digits of min.
+		char maxDigits[11];	// Stores the digits of max.
+
 		// Grab the string equivalents of the min and max values.
-		minString = unsignedToString(min);
-		maxString = unsignedToString(max);
+		unsignedToString(min, minDigits);
+		unsignedToString(max, maxDigits);
+
+		string minString = minDigits;	// Stores the string equivalent of min.
+		string maxString = maxDigits;	// Stores the string equivalent of max.
 
 		// Do this until the user gives us something we can work with.
 		do
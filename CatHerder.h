@@ -33,7 +33,8 @@ class catHerder
 		// This function prints a random scolding.
 		void randomScolding(void);
 		// This function converts an unsigned integer to a char string.
-		const char* unsignedToString(unsigned int input);
+		// The output buffer must have room for at least 11 characters.
+		void unsignedToString(unsigned int input, char* output);
 		// This function waits for valid input in the range of the
 		// given minimum and maximum unsigned integer values.
 		unsigned int askForUnsignedInt(const char* query, const unsigned int min, const unsigned int max);
@@ -0,0 +1,368 @@
+// Author: Jason Tennyson
+// File: CgroupLimits.cpp
+// Date: 10/19/26
+//
+// This file contains the implementation of the cgroup CPU limits. The
+// cgroup the program is in comes from /proc/self/cgroup, and where that
+// cgroup's folder is comes from /proc/self/mountinfo, since the hierarchies
+// aren't always mounted in the same place. Everything is read the first
+// time it is needed, except for the throttling counters.
+//
+// In cgroup v2, the quota is in cpu.max as "quota period" (or "max period"
+// for no quota) and the counters are in cpu.stat in microseconds. In v1 the
+// quota and period have files of their own (-1 for no quota), and cpu.stat
+// has the throttled time in nanoseconds.
+
+#include "CgroupLimits.h"
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <sched.h>
+#include <unistd.h>
+
+using namespace std;
+
+// These are the limits, read the first time they are needed.
+static bool limitsRead = false;
+static unsigned int version = 0;
+static double quotaCpus = 0;
+static unsigned int quotaPeriod = 0;
+static unsigned int cpusetSize = 0;
+static string quotaFolder;
+
+// This function returns true if word is one of the words in a comma
+// separated list, like "cpu" in "rw,cpu,cpuacct".
+static bool listHas(const string& list, const char* word)
+{
+	stringstream words(list);
+	string next;
+
+	while(getline(words, next, ','))
+	{
+		if(next == word)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// This function finds where a hierarchy is mounted. For v2 the type is
+// "cgroup2", and for v1 it is "cgroup" with the controller in the super
+// options. The mount point and the cgroup at its root are stored in
+// mountPoint and mountRoot.
+static bool findMount(const char* type, const char* controller, string& mountPoint, string& mountRoot)
+{
+	ifstream mounts("/proc/self/mountinfo");
+	string line;
+
+	while(getline(mounts, line))
+	{
+		// The fields are: id, parent, device, root, mount point, mount
+		// options, optional fields, "-", type, source, super options.
+		stringstream fields(line);
+		string field, root, point, fsType, source, options;
+		unsigned int index = 0;
+
+		while((fields >> field) && (field != "-"))
+		{
+			if(index == 3)
+			{
+				root = field;
+			}
+			else if(index == 4)
+			{
+				point = field;
+			}
+			index++;
+		}
+
+		if(!(fields >> fsType >> source >> options) || (fsType != type))
+		{
+			continue;
+		}
+
+		if(controller && !listHas(options, controller))
+		{
+			continue;
+		}
+
+		mountPoint = point;
+		mountRoot = root;
+		return true;
+	}
+
+	return false;
+}
+
+// This function finds the folder of the cgroup the program is in, and
+// where its hierarchy is mounted. For v2 the line in /proc/self/cgroup
+// starts with "0::", and for v1 the line has the controller in its list.
+static bool findFolder(unsigned int cgroupVersion, string& folder, string& mountPoint)
+{
+	string mountRoot;
+
+	if(cgroupVersion == 2)
+	{
+		if(!findMount("cgroup2", NULL, mountPoint, mountRoot))
+		{
+			return false;
+		}
+	}
+	else if(!findMount("cgroup", "cpu", mountPoint, mountRoot))
+	{
+		return false;
+	}
+
+	ifstream cgroups("/proc/self/cgroup");
+	string line;
+
+	while(getline(cgroups, line))
+	{
+		// The lines look like "hierarchy:controllers:path".
+		size_t first = line.find(':');
+		size_t second = line.find(':', first + 1);
+
+		if((first == string::npos) || (second == string::npos))
+		{
+			continue;
+		}
+
+		string controllers = line.substr(first + 1, second - first - 1);
+		string path = line.substr(second + 1);
+
+		if((cgroupVersion == 2) ? (line.compare(0, 3, "0::") != 0) : !listHas(controllers, "cpu"))
+		{
+			continue;
+		}
+
+		// If the mount is of a cgroup below the real root, like in a
+		// container without a cgroup namespace, the path starts with it.
+		if((mountRoot != "/") && (path.compare(0, mountRoot.size(), mountRoot) == 0))
+		{
+			path = path.substr(mountRoot.size());
+		}
+
+		folder = mountPoint;
+		if((path != "/") && !path.empty())
+		{
+			folder += path;
+		}
+
+		return true;
+	}
+
+	return false;
+}
+
+// This function reads the quota of one cgroup folder, in CPUs, along with
+// its period. Returns false if the folder has no quota.
+static bool readQuota(unsigned int cgroupVersion, const string& folder, double& cpus, unsigned int& period)
+{
+	long long quota = -1;
+	long long length = 0;
+
+	if(cgroupVersion == 2)
+	{
+		ifstream maxFile((folder + "/cpu.max").c_str());
+		string quotaText;
+
+		if(!(maxFile >> quotaText >> length) || (quotaText == "max"))
+		{
+			return false;
+		}
+
+		quota = atoll(quotaText.c_str());
+	}
+	else
+	{
+		ifstream quotaFile((folder + "/cpu.cfs_quota_us").c_str());
+		ifstream periodFile((folder + "/cpu.cfs_period_us").c_str());
+
+		if(!(quotaFile >> quota) || !(periodFile >> length))
+		{
+			return false;
+		}
+	}
+
+	if((quota <= 0) || (length <= 0))
+	{
+		return false;
+	}
+
+	cpus = (double)quota/length;
+	period = length;
+
+	return true;
+}
+
+// This function reads the limits, if they haven't been read yet.
+static void readLimits(void)
+{
+	if(limitsRead)
+	{
+		return;
+	}
+	limitsRead = true;
+
+	cpu_set_t allowed;
+	if(sched_getaffinity(0, sizeof(allowed), &allowed) == 0)
+	{
+		cpusetSize = CPU_COUNT(&allowed);
+	}
+
+	// The v2 hierarchy only counts if the CPU controller is on it.
+	string folder, mountPoint;
+
+	if(findFolder(2, folder, mountPoint))
+	{
+		ifstream controllers((mountPoint + "/cgroup.controllers").c_str());
+		string controller;
+
+		while(controllers >> controller)
+		{
+			if(controller == "cpu")
+			{
+				version = 2;
+			}
+		}
+	}
+
+	if(!version)
+	{
+		if(!findFolder(1, folder, mountPoint))
+		{
+			return;
+		}
+		version = 1;
+	}
+
+	// Any cgroup on the way up to the root can have a quota, and the
+	// smallest one is the one the threads will run into.
+	quotaFolder = folder;
+
+	while(true)
+	{
+		double cpus;
+		unsigned int period;
+
+		if(readQuota(version, folder, cpus, period) && ((quotaCpus == 0) || (cpus < quotaCpus)))
+		{
+			quotaCpus = cpus;
+			quotaPeriod = period;
+			quotaFolder = folder;
+		}
+
+		size_t slash = folder.rfind('/');
+		if((folder.size() <= mountPoint.size()) || (slash == string::npos))
+		{
+			break;
+		}
+		folder.erase(slash);
+	}
+}
+
+// This function returns the cgroup version that the limits came from.
+unsigned int cgroupVersion(void)
+{
+	readLimits();
+
+	return version;
+}
+
+// This function returns the CPU quota in CPUs, or 0 if there is none.
+double cgroupCpuQuota(void)
+{
+	readLimits();
+
+	return quotaCpus;
+}
+
+// This function returns the length of the quota period in microseconds.
+unsigned int cgroupQuotaPeriod(void)
+{
+	readLimits();
+
+	return quotaPeriod;
+}
+
+// This function returns the number of CPUs in the cpuset.
+unsigned int cgroupCpusetSize(void)
+{
+	readLimits();
+
+	return cpusetSize;
+}
+
+// This function returns the number of CPUs that the cgroup limits the
+// program to, or 0 if it doesn't.
+unsigned int cgroupCpuLimit(void)
+{
+	readLimits();
+
+	long online = sysconf(_SC_NPROCESSORS_ONLN);
+	unsigned int limit = 0;
+
+	if(cpusetSize && (online > 0) && (cpusetSize < (unsigned long)online))
+	{
+		limit = cpusetSize;
+	}
+
+	// A quota of 1.5 CPUs can only keep 1 thread running all the time.
+	if(quotaCpus > 0)
+	{
+		unsigned int quotaLimit = (quotaCpus < 1) ? 1 : (unsigned int)quotaCpus;
+
+		if((limit == 0) || (quotaLimit < limit))
+		{
+			limit = quotaLimit;
+		}
+	}
+
+	return limit;
+}
+
+// This function reads the throttling counters of the cgroup with the quota.
+bool cgroupThrottleSample(throttleSample* sample)
+{
+	readLimits();
+
+	if(quotaCpus == 0)
+	{
+		return false;
+	}
+
+	ifstream statFile((quotaFolder + "/cpu.stat").c_str());
+	string key;
+	unsigned long long value;
+	bool found = false;
+
+	memset(sample, 0, sizeof(throttleSample));
+
+	while(statFile >> key >> value)
+	{
+		if(key == "nr_periods")
+		{
+			sample->periods = value;
+		}
+		else if(key == "nr_throttled")
+		{
+			sample->throttled = value;
+			found = true;
+		}
+		else if(key == "throttled_usec")
+		{
+			sample->throttledUsecs = value;
+		}
+		else if(key == "throttled_time")
+		{
+			// v1 counts it in nanoseconds.
+			sample->throttledUsecs = value/1000;
+		}
+	}
+
+	return found;
+}
@@ -0,0 +1,59 @@
+// Author: Jason Tennyson
+// File: CgroupLimits.h
+// Date: 10/19/26
+//
+// This file contains the definitions for reading the CPU limits of the
+// cgroup that the program runs in. Inside of a container, the machine can
+// have plenty of CPUs while the container is only allowed to use a few of
+// them, either through a cpuset or through a CPU quota (cpu.max). A quota
+// doesn't keep the threads off of any CPU. Instead, the kernel stops every
+// thread in the cgroup once the quota for the period is used up, and lets
+// them go again at the start of the next period. A sweep with more threads
+// than the quota ends up measuring those stops instead of contention.
+//
+// cgroup v2 is read first. If the CPU controller isn't on the v2 hierarchy,
+// the v1 CPU controller is read instead, since a lot of hosts still mount
+// it that way.
+
+#ifndef CgroupLimits_h_
+#define CgroupLimits_h_
+
+#define THROTTLE_ATTEMPTS	(3)				// Tries for a throttled cell.
+#define THROTTLE_EXTENSION	("_throttle.csv")		// Ending of the throttle file.
+
+// This structure holds the throttling counters of the cgroup that has the
+// quota. They only ever go up, so a cell was throttled if they changed.
+struct throttleSample
+{
+	unsigned long long periods;		// Periods with the threads runnable.
+	unsigned long long throttled;		// Periods that ran out of quota.
+	unsigned long long throttledUsecs;	// Time spent stopped (us).
+};
+
+// This function returns the cgroup version that the limits came from, 2
+// or 1, or 0 if no CPU controller could be found.
+unsigned int cgroupVersion(void);
+
+// This function returns the CPU quota in CPUs (like 1.5 for a quota of
+// 150000 every 100000 us), or 0 if there is no quota. The tightest quota
+// from the cgroup up to the root is the one that counts.
+double cgroupCpuQuota(void);
+
+// This function returns the length of the quota period in microseconds,
+// or 0 if there is no quota.
+unsigned int cgroupQuotaPeriod(void);
+
+// This function returns the number of CPUs in the cpuset that the
+// program is allowed to run on.
+unsigned int cgroupCpusetSize(void);
+
+// This function returns the number of CPUs that the cgroup limits the
+// program to, rounded down (but at least 1), or 0 if the cgroup doesn't
+// limit it to fewer than the CPUs that are online.
+unsigned int cgroupCpuLimit(void);
+
+// This function reads the throttling counters into sample. Returns false
+// if there is no quota or they can't be read.
+bool cgroupThrottleSample(throttleSample* sample);
+
+#endif
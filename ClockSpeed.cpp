@@ -0,0 +1,131 @@
+// Author: Jason Tennyson
+// File: ClockSpeed.cpp
+// Date: 10/19/26
+//
+// This file contains the implementation of the clock speed measurement.
+// APERF only counts while the core is running, and the core is busy with
+// the chain of adds the whole time between the two reads of it, so the
+// cycles it counted over the time taken is the speed the core ran at.
+
+#include "ClockSpeed.h"
+#include "TimeStamp.h"
+#include <cstdio>
+#include <sched.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// This function does a chain of dependent adds. Every add needs the answer
+// of the last one, and the empty asm keeps the compiler from adding them
+// up ahead of time, so each one takes a cycle. The loop counter runs next
+// to the chain without slowing it down. The step is hidden from the
+// compiler too, since some cores fold chains of adds of a constant
+// together before they ever run them.
+static void dependentAdds(unsigned long long adds)
+{
+	unsigned long long x = 0;
+	unsigned long long step = 1;
+	__asm__ __volatile__("" : "+r"(step));
+
+	for(unsigned long long i = 0; i < adds; i += 4)
+	{
+		x += step;
+		__asm__ __volatile__("" : "+r"(x));
+		x += step;
+		__asm__ __volatile__("" : "+r"(x));
+		x += step;
+		__asm__ __volatile__("" : "+r"(x));
+		x += step;
+		__asm__ __volatile__("" : "+r"(x));
+	}
+}
+
+// This function reads a model specific register. Returns false if it
+// can't be read.
+static bool readMsr(int msrFile, unsigned int msr, unsigned long long* value)
+{
+	return (pread(msrFile, value, sizeof(*value), msr) == sizeof(*value));
+}
+
+// This function measures the clock speed of a core.
+void readClockSpeed(clockReading* reading, int cpu)
+{
+	unsigned long long fastest = ~0ULL;
+	unsigned long long aperfCycles = 0;
+	unsigned long long aperfNsecs = 0;
+
+	reading->loopMhz = 0;
+	reading->msrMhz = 0;
+
+	// Move to the core we were asked to measure, and remember where we
+	// were allowed to run so that we can go back.
+	cpu_set_t allowed, target;
+	bool moved = false;
+
+	if((cpu >= 0) && (cpu < CPU_SETSIZE) &&
+	   (pthread_getaffinity_np(pthread_self(), sizeof(allowed), &allowed) == 0))
+	{
+		CPU_ZERO(&target);
+		CPU_SET(cpu, &target);
+		moved = (pthread_setaffinity_np(pthread_self(), sizeof(target), &target) == 0);
+	}
+
+	reading->cpu = sched_getcpu();
+
+	for(unsigned int i = 0; i < CLOCK_TRIES; i++)
+	{
+		// The registers belong to the core, so they are read from the
+		// one we are on, and thrown out if we move while reading them.
+		int cpu = sched_getcpu();
+		char path[64];
+		snprintf(path, sizeof(path), "/dev/cpu/%d/msr", cpu);
+		int msrFile = (cpu >= 0) ? open(path, O_RDONLY) : -1;
+
+		unsigned long long aperfBefore, aperfAfter;
+		bool counted = (msrFile >= 0) && readMsr(msrFile, MSR_APERF, &aperfBefore);
+
+		unsigned long long start = timeStamp::monotonicNsecs();
+		dependentAdds(CLOCK_ADDS);
+		unsigned long long taken = timeStamp::monotonicNsecs() - start;
+
+		counted = counted && readMsr(msrFile, MSR_APERF, &aperfAfter) && (sched_getcpu() == cpu);
+
+		if(msrFile >= 0)
+		{
+			close(msrFile);
+		}
+
+		// Anything slower than the fastest try was most likely interrupted.
+		if(taken < fastest)
+		{
+			fastest = taken;
+			aperfCycles = counted ? (aperfAfter - aperfBefore) : 0;
+			aperfNsecs = counted ? taken : 0;
+		}
+	}
+
+	// Guard against a clock that didn't move.
+	if(fastest == 0)
+	{
+		fastest = 1;
+	}
+
+	// Cycles per nanosecond is GHz, so a thousand times that is MHz.
+	reading->loopMhz = 1000.0*CLOCK_ADDS/fastest;
+
+	if(aperfNsecs)
+	{
+		reading->msrMhz = 1000.0*aperfCycles/aperfNsecs;
+	}
+
+	if(moved)
+	{
+		pthread_setaffinity_np(pthread_self(), sizeof(allowed), &allowed);
+	}
+}
+
+// This function returns whether both readings have an APERF speed.
+bool clockUsesMsr(const clockReading& before, const clockReading& after)
+{
+	return ((before.msrMhz > 0) && (after.msrMhz > 0));
+}
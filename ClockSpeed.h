@@ -0,0 +1,53 @@
+// Author: Jason Tennyson
+// File: ClockSpeed.h
+// Date: 10/19/26
+//
+// This file contains the function prototypes for measuring the clock speed
+// of the core. The times in the spreadsheets are wall clock times, and a
+// core with turbo runs faster with one busy core than with all of them, and
+// slower again once it gets hot. That makes a column of 16 threads look
+// worse next to a column of 1 thread than the threads themselves made it.
+// Measuring the clock speed on either side of a cell shows how much it
+// moved, and turns the wall time into cycles per operation, which doesn't
+// care what speed the core was running at.
+//
+// The speed is measured two ways. The first is a chain of dependent adds,
+// where each add has to wait for the one before it, so the chain does one
+// add per cycle at whatever speed the core is at. The second is the APERF
+// register, which counts the cycles the core actually ran, read through
+// /dev/cpu/N/msr. That needs the msr module and root, so it is only used
+// when it can be read.
+//
+// The speed can only be measured while the core is busy with the adds, so
+// it is measured just before and just after a cell, not while it runs. The
+// main thread moves to a core that a worker was just on for it, since the
+// main thread's own core sits idle in pthread_join() while the cell runs.
+
+#ifndef ClockSpeed_h_
+#define ClockSpeed_h_
+
+#define CLOCK_ADDS		(2000000)			// Dependent adds per measurement.
+#define CLOCK_TRIES		(3)				// Tries per measurement, fastest wins.
+#define CLOCK_EXTENSION		("_clock.csv")			// Ending of the clock file.
+#define MSR_APERF		(0xE8)				// Counts actual cycles.
+
+// This structure holds one measurement of the clock speed.
+struct clockReading
+{
+	double loopMhz;		// From the chain of dependent adds.
+	double msrMhz;		// From APERF, or 0 if it can't be read.
+	int cpu;		// The core that was measured, or -1.
+};
+
+// This function measures the clock speed of a core. If cpu isn't negative,
+// the calling thread moves to that core for the measurement and then goes
+// back to wherever it was allowed before. Otherwise, or if it can't move,
+// the core it is on is measured.
+void readClockSpeed(clockReading* reading, int cpu);
+
+// This function returns whether both readings have an APERF speed. If they
+// do, a cell is measured with APERF on both sides, and if not, with the
+// loop on both sides, so that one cell never mixes the two.
+bool clockUsesMsr(const clockReading& before, const clockReading& after);
+
+#endif
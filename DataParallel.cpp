@@ -0,0 +1,682 @@
+// Author: Jason Tennyson
+// File: DataParallel.cpp
+// Date: 10/19/26
+//
+// This file contains the implementation of the data parallel workloads. All
+// of the threads of a cell make their part of the records, wait for each
+// other, and then run the workload, waiting for each other again between
+// the phases. Whichever thread gets to a phase's barrier last stamps the
+// time, so a phase takes as long as its slowest thread.
+
+#include "DataParallel.h"
+#include "FastRandom.h"
+#include "ThreadTutorial.h"
+#include "TraceRecorder.h"
+#include "LiveStats.h"
+#include "Workload.h"
+#include <cstring>
+#include <strings.h>
+#include <algorithm>
+
+using namespace std;
+
+// These are the names of the workloads, in the order of dataKernel.
+static const char* dataNames[DATA_KERNELS] = { "samplesort", "mergesort", "groupby" };
+
+// These are the times that are stamped during a cell.
+enum dataPhase
+{
+	PHASE_START = 0,	// The records are made.
+	PHASE_PARTITION,	// The records are where they need to be.
+	PHASE_LOCAL,		// Every thread is done with its own part.
+	PHASE_MERGE,		// The parts are put back together.
+	DATA_PHASES		// The number of stamps.
+};
+
+// This structure is one group of the group by. A group with a count of
+// zero is an empty spot in a hash table.
+struct dataGroup
+{
+	unsigned long long key;		// The key of the group.
+	unsigned long long count;	// How many records had the key.
+	unsigned long long sum;		// What their values added up to.
+};
+
+// This structure is what each thread keeps for the others to see, like how
+// many of its records go in every bucket. Each one fills its own cache
+// lines, since its thread writes to it while the others read theirs.
+struct dataWorker
+{
+	unsigned int id;			// Index of the thread.
+	unsigned long long counts[MAX_THREADS];	// Records of its slice per bucket.
+	unsigned long long fingerprint;		// Of the records it made.
+	unsigned long long groups;		// Groups found in its partition.
+	bool failed;				// Its hash table wasn't allocated.
+	char pad[CACHE_LINE_SIZE];
+};
+
+// These values have to be stored globally to be accessed by the threads.
+static bool dataOn = false;
+static dataKernel dataKind;
+static ofstream dataDump;
+static dataRecord* dataInput = NULL;
+static dataRecord* dataOutput = NULL;
+static dataGroup* dataGroups = NULL;
+static unsigned long long dataCapacity = 0;
+static unsigned long long dataRecords;
+static unsigned long long dataKeySpace;
+static unsigned int dataThreads;
+static dataRecord* dataResult;
+static pthread_barrier_t dataBarrier;
+static unsigned long long phaseNsecs[DATA_PHASES];
+static unsigned long long dataSplitters[MAX_THREADS];
+static unsigned long long dataSamples[MAX_THREADS*DATA_OVERSAMPLE];
+static dataWorker dataWorkers[MAX_THREADS] __attribute__((aligned(CACHE_LINE_SIZE)));
+
+// This function returns the name of a workload.
+const char* dataKernelName(dataKernel kernel)
+{
+	return ((kernel < DATA_KERNELS) ? dataNames[kernel] : "unknown");
+}
+
+// This function finds the workload with the given name.
+bool dataKernelFromName(const char* name, dataKernel* kernel)
+{
+	for(unsigned int i = 0; i < DATA_KERNELS; i++)
+	{
+		if(strcasecmp(name, dataNames[i]) == 0)
+		{
+			*kernel = (dataKernel)i;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// This function scrambles the bits of a key (the splitmix64 finalizer), so
+// that keys that are close together hash far apart.
+static inline unsigned long long mixKey(unsigned long long key)
+{
+	key = (key ^ (key >> 30))*0xBF58476D1CE4E5B9ULL;
+	key = (key ^ (key >> 27))*0x94D049BB133111EBULL;
+	return key ^ (key >> 31);
+}
+
+// This function returns a number for a record. Adding them up gives the
+// same total in any order, so the sorted records can be checked against
+// the ones that were made without sorting them again.
+static inline unsigned long long fingerprintOf(const dataRecord& record)
+{
+	return mixKey(record.key ^ mixKey(record.value));
+}
+
+// This function returns where the index-th of parts equal parts of total
+// things starts.
+static inline unsigned long long sliceStart(unsigned long long total, unsigned int parts, unsigned int index)
+{
+	return (total*index)/parts;
+}
+
+// This function returns whether record a sorts before record b.
+static bool keyBefore(const dataRecord& a, const dataRecord& b)
+{
+	return (a.key < b.key);
+}
+
+// This function returns which bucket a record goes to. The sample sort
+// goes by the splitters, and the group by goes by the top of the hash.
+static inline unsigned int bucketOf(unsigned long long key)
+{
+	if(dataKind == DATA_GROUPBY)
+	{
+		return (unsigned int)(((unsigned __int128)mixKey(key)*dataThreads) >> 64);
+	}
+
+	return (unsigned int)(upper_bound(dataSplitters, dataSplitters + dataThreads - 1, key) - dataSplitters);
+}
+
+// This function waits for the other threads and stamps the time of the
+// phase when the last one gets there.
+static void finishPhase(dataPhase phase)
+{
+	if(pthread_barrier_wait(&dataBarrier) == PTHREAD_BARRIER_SERIAL_THREAD)
+	{
+		phaseNsecs[phase] = timeStamp::monotonicNsecs();
+	}
+}
+
+// This function returns where a bucket starts in the partitioned records.
+static unsigned long long bucketStart(unsigned int bucket)
+{
+	unsigned long long start = 0;
+
+	for(unsigned int b = 0; b < bucket; b++)
+	{
+		for(unsigned int t = 0; t < dataThreads; t++)
+		{
+			start += dataWorkers[t].counts[b];
+		}
+	}
+
+	return start;
+}
+
+// This function makes this thread's part of the records. The records come
+// in blocks that each have their own seed, so they are the same whichever
+// thread makes them. The output is touched here too, so that the first
+// cell doesn't pay for faulting it in.
+static void makeRecords(dataWorker* worker)
+{
+	unsigned long long blocks = (dataRecords + DATA_BLOCK - 1)/DATA_BLOCK;
+	unsigned long long first = sliceStart(blocks, dataThreads, worker->id);
+	unsigned long long last = sliceStart(blocks, dataThreads, worker->id + 1);
+	fastRandom random;
+
+	worker->fingerprint = 0;
+
+	for(unsigned long long block = first; block < last; block++)
+	{
+		unsigned long long start = block*DATA_BLOCK;
+		unsigned long long end = min(start + DATA_BLOCK, dataRecords);
+
+		random.seed(DEFAULT_RANDOM_SEED + block);
+
+		for(unsigned long long r = start; r < end; r++)
+		{
+			dataInput[r].key = (dataKind == DATA_GROUPBY) ? random.below(dataKeySpace) : random.next();
+			dataInput[r].value = r;
+			worker->fingerprint += fingerprintOf(dataInput[r]);
+		}
+
+		memset(&dataOutput[start], 0, (end - start)*sizeof(dataRecord));
+	}
+}
+
+// This function moves this thread's slice of the records into the buckets.
+// Every thread counts what it has for each bucket, and once they all have,
+// each one knows exactly where its records go, so they can all move them
+// at the same time without getting in each other's way.
+static void partitionRecords(dataWorker* worker)
+{
+	unsigned long long start = sliceStart(dataRecords, dataThreads, worker->id);
+	unsigned long long end = sliceStart(dataRecords, dataThreads, worker->id + 1);
+	unsigned long long offsets[MAX_THREADS];
+
+	memset(worker->counts, 0, sizeof(worker->counts));
+
+	for(unsigned long long r = start; r < end; r++)
+	{
+		worker->counts[bucketOf(dataInput[r].key)]++;
+	}
+
+	pthread_barrier_wait(&dataBarrier);
+
+	// Each bucket holds the records of thread 0, then thread 1, and so on.
+	unsigned long long before = 0;
+	for(unsigned int b = 0; b < dataThreads; b++)
+	{
+		for(unsigned int t = 0; t < dataThreads; t++)
+		{
+			if(t == worker->id)
+			{
+				offsets[b] = before;
+			}
+
+			before += dataWorkers[t].counts[b];
+		}
+	}
+
+	for(unsigned long long r = start; r < end; r++)
+	{
+		dataOutput[offsets[bucketOf(dataInput[r].key)]++] = dataInput[r];
+	}
+}
+
+// This function runs this thread's part of the sample sort.
+static void sampleSort(dataWorker* worker)
+{
+	unsigned long long start = sliceStart(dataRecords, dataThreads, worker->id);
+	unsigned long long end = sliceStart(dataRecords, dataThreads, worker->id + 1);
+	fastRandom random;
+
+	// Draw samples of this thread's slice.
+	random.seed(DEFAULT_RANDOM_SEED + worker->id);
+	for(unsigned int s = 0; s < DATA_OVERSAMPLE; s++)
+	{
+		dataSamples[worker->id*DATA_OVERSAMPLE + s] =
+			(end > start) ? dataInput[start + random.below(end - start)].key : 0;
+	}
+
+	// One thread picks the splitters from all of the samples, evenly
+	// spaced, so each bucket should get about the same number of records.
+	if(pthread_barrier_wait(&dataBarrier) == PTHREAD_BARRIER_SERIAL_THREAD)
+	{
+		sort(dataSamples, dataSamples + dataThreads*DATA_OVERSAMPLE);
+
+		for(unsigned int i = 0; i < (dataThreads - 1); i++)
+		{
+			dataSplitters[i] = dataSamples[(i + 1)*DATA_OVERSAMPLE];
+		}
+	}
+	pthread_barrier_wait(&dataBarrier);
+
+	partitionRecords(worker);
+	finishPhase(PHASE_PARTITION);
+
+	// Sort this thread's bucket.
+	sort(dataOutput + bucketStart(worker->id), dataOutput + bucketStart(worker->id + 1), keyBefore);
+	finishPhase(PHASE_LOCAL);
+
+	// The buckets are in order already.
+	finishPhase(PHASE_MERGE);
+}
+
+// This function returns how many of the first k records of the merge of a
+// and b come from a. Ties go to a, so the merge keeps equal keys in order.
+static unsigned long long coRank(unsigned long long k, const dataRecord* a, unsigned long long aLength,
+				 const dataRecord* b, unsigned long long bLength)
+{
+	unsigned long long low = (k > bLength) ? (k - bLength) : 0;
+	unsigned long long high = (k < aLength) ? k : aLength;
+
+	// Too few come from a if the next one from a belongs before the last
+	// one from b.
+	while(low < high)
+	{
+		unsigned long long middle = (low + high)/2;
+
+		if((middle < aLength) && ((k - middle) > 0) && (a[middle].key <= b[k - middle - 1].key))
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+
+	return low;
+}
+
+// This function does this thread's share of one round of the merge sort.
+// The sorted runs are merged in pairs from source into destination. Every
+// thread writes the same share of destination, and finds what it needs from
+// each pair that its share overlaps by binary search.
+static void mergeRound(dataWorker* worker, const dataRecord* source, dataRecord* destination,
+		       const unsigned long long* bounds, unsigned int runs)
+{
+	unsigned long long outStart = sliceStart(dataRecords, dataThreads, worker->id);
+	unsigned long long outEnd = sliceStart(dataRecords, dataThreads, worker->id + 1);
+
+	for(unsigned int pair = 0; (2*pair) < runs; pair++)
+	{
+		unsigned long long aStart = bounds[2*pair];
+		unsigned long long bStart = bounds[min(2*pair + 1, runs)];
+		unsigned long long bEnd = bounds[min(2*pair + 2, runs)];
+		unsigned long long low = max(outStart, aStart);
+		unsigned long long high = min(outEnd, bEnd);
+
+		if(low >= high)
+		{
+			continue;
+		}
+
+		const dataRecord* a = source + aStart;
+		const dataRecord* b = source + bStart;
+		unsigned long long aLength = bStart - aStart;
+		unsigned long long bLength = bEnd - bStart;
+		unsigned long long i = coRank(low - aStart, a, aLength, b, bLength);
+		unsigned long long iEnd = coRank(high - aStart, a, aLength, b, bLength);
+		unsigned long long j = (low - aStart) - i;
+		unsigned long long jEnd = (high - aStart) - iEnd;
+		dataRecord* out = destination + low;
+
+		while((i < iEnd) && (j < jEnd))
+		{
+			*out++ = (a[i].key <= b[j].key) ? a[i++] : b[j++];
+		}
+		while(i < iEnd)
+		{
+			*out++ = a[i++];
+		}
+		while(j < jEnd)
+		{
+			*out++ = b[j++];
+		}
+	}
+}
+
+// This function runs this thread's part of the merge sort.
+static void mergeSort(dataWorker* worker)
+{
+	unsigned long long bounds[MAX_THREADS + 1];
+	unsigned int runs = dataThreads;
+	dataRecord* source = dataInput;
+	dataRecord* destination = dataOutput;
+
+	// The slices don't have to be moved anywhere.
+	finishPhase(PHASE_PARTITION);
+
+	for(unsigned int i = 0; i <= runs; i++)
+	{
+		bounds[i] = sliceStart(dataRecords, dataThreads, i);
+	}
+
+	sort(dataInput + bounds[worker->id], dataInput + bounds[worker->id + 1], keyBefore);
+	finishPhase(PHASE_LOCAL);
+
+	// Merge pairs of runs until there is one left. Every thread keeps its
+	// own copy of where the runs start, since they all work it out the
+	// same way.
+	while(runs > 1)
+	{
+		mergeRound(worker, source, destination, bounds, runs);
+		pthread_barrier_wait(&dataBarrier);
+
+		unsigned int merged = (runs + 1)/2;
+		for(unsigned int i = 0; i < merged; i++)
+		{
+			bounds[i] = bounds[2*i];
+		}
+		bounds[merged] = dataRecords;
+		runs = merged;
+
+		swap(source, destination);
+	}
+
+	if(worker->id == 0)
+	{
+		dataResult = source;
+	}
+	finishPhase(PHASE_MERGE);
+}
+
+// This function runs this thread's part of the group by.
+static void groupBy(dataWorker* worker)
+{
+	partitionRecords(worker);
+	finishPhase(PHASE_PARTITION);
+
+	// This thread's partition can't have more keys than it has records,
+	// or than there are keys. The table is kept at most half full.
+	unsigned long long start = bucketStart(worker->id);
+	unsigned long long end = bucketStart(worker->id + 1);
+	unsigned long long most = min(end - start, dataKeySpace);
+	unsigned long long size = 2;
+
+	while(size < (2*most))
+	{
+		size *= 2;
+	}
+
+	unsigned long long mask = size - 1;
+	dataGroup* table = (dataGroup*)calloc(size, sizeof(dataGroup));
+
+	worker->groups = 0;
+	worker->failed = (table == NULL);
+
+	if(table)
+	{
+		for(unsigned long long r = start; r < end; r++)
+		{
+			unsigned long long key = dataOutput[r].key;
+			unsigned long long slot = mixKey(key) & mask;
+
+			while(table[slot].count && (table[slot].key != key))
+			{
+				slot = (slot + 1) & mask;
+			}
+
+			table[slot].key = key;
+			table[slot].count++;
+			table[slot].sum += dataOutput[r].value;
+		}
+
+		// Pack the groups together at the front of the table.
+		for(unsigned long long slot = 0; slot < size; slot++)
+		{
+			if(table[slot].count)
+			{
+				table[worker->groups++] = table[slot];
+			}
+		}
+	}
+	finishPhase(PHASE_LOCAL);
+
+	// Copy the groups in after the ones from the threads before this one.
+	unsigned long long offset = 0;
+	for(unsigned int t = 0; t < worker->id; t++)
+	{
+		offset += dataWorkers[t].groups;
+	}
+
+	if(table)
+	{
+		memcpy(dataGroups + offset, table, worker->groups*sizeof(dataGroup));
+		free(table);
+	}
+	finishPhase(PHASE_MERGE);
+}
+
+// This is the function that each thread runs during a cell.
+static void* dataGenerator(void* workerObject)
+{
+	dataWorker* worker = (dataWorker*)workerObject;
+
+	makeRecords(worker);
+	finishPhase(PHASE_START);
+
+	switch(dataKind)
+	{
+		case DATA_MERGESORT:
+			mergeSort(worker);
+			break;
+		case DATA_GROUPBY:
+			groupBy(worker);
+			break;
+		default:
+			sampleSort(worker);
+			break;
+	}
+
+	return (NULL);
+}
+
+// This function makes sure there is room for records records. The room is
+// kept from cell to cell, so it only grows.
+static bool reserveRecords(unsigned long long records)
+{
+	if(records <= dataCapacity)
+	{
+		return true;
+	}
+
+	free(dataInput);
+	free(dataOutput);
+	free(dataGroups);
+	dataInput = dataOutput = NULL;
+	dataGroups = NULL;
+	dataCapacity = 0;
+
+	if((posix_memalign((void**)&dataInput, CACHE_LINE_SIZE, records*sizeof(dataRecord)) != 0) ||
+	   (posix_memalign((void**)&dataOutput, CACHE_LINE_SIZE, records*sizeof(dataRecord)) != 0) ||
+	   (posix_memalign((void**)&dataGroups, CACHE_LINE_SIZE, (records/DATA_GROUP_SIZE + 1)*sizeof(dataGroup)) != 0))
+	{
+		return false;
+	}
+
+	dataCapacity = records;
+	return true;
+}
+
+// This function checks the output of the cell that just ran.
+static bool checkOutput(void)
+{
+	if(dataKind == DATA_GROUPBY)
+	{
+		unsigned long long count = 0, sum = 0;
+		unsigned long long group = 0;
+
+		// Every group has to be in the partition that its key hashes to,
+		// so no key can be split between two threads, and the groups
+		// have to add up to every record.
+		for(unsigned int t = 0; t < dataThreads; t++)
+		{
+			if(dataWorkers[t].failed)
+			{
+				return false;
+			}
+
+			for(unsigned long long g = 0; g < dataWorkers[t].groups; g++, group++)
+			{
+				if((dataGroups[group].key >= dataKeySpace) || (bucketOf(dataGroups[group].key) != t))
+				{
+					return false;
+				}
+
+				count += dataGroups[group].count;
+				sum += dataGroups[group].sum;
+			}
+		}
+
+		return ((count == dataRecords) && (sum == (dataRecords*(dataRecords - 1))/2));
+	}
+
+	// Sorted records have to be in order, and have to be the same records
+	// that were made.
+	unsigned long long made = 0, found = 0;
+
+	for(unsigned int t = 0; t < dataThreads; t++)
+	{
+		made += dataWorkers[t].fingerprint;
+	}
+
+	for(unsigned long long r = 0; r < dataRecords; r++)
+	{
+		if((r > 0) && (dataResult[r].key < dataResult[r - 1].key))
+		{
+			return false;
+		}
+
+		found += fingerprintOf(dataResult[r]);
+	}
+
+	return (made == found);
+}
+
+// This function turns on a data parallel workload for the automatic tests.
+bool enableDataWorkload(const char* filename, dataKernel kernel)
+{
+	// Create a temp filename to append the spreadsheet folder location
+	// in front of the desired filename.
+	string tempFilename = SPREADSHEET_FOLDER;
+	tempFilename += "/";
+	tempFilename += filename;
+
+	dataDump.open(tempFilename.c_str());
+
+	if(!dataDump)
+	{
+		return false;
+	}
+
+	dataDump << "Workload,Records,Threads,Bytes,Time (us),GB/s,Partition (us),Local (us),Merge (us),Verified\n";
+
+	dataOn = true;
+	dataKind = kernel;
+
+	return true;
+}
+
+// This function turns the workload back off. The records are kept.
+void finishDataWorkload(void)
+{
+	if(dataOn)
+	{
+		dataDump << "\n";
+		dataDump.close();
+		dataOn = false;
+	}
+}
+
+// This function frees the records.
+void releaseDataRecords(void)
+{
+	free(dataInput);
+	free(dataOutput);
+	free(dataGroups);
+	dataInput = dataOutput = NULL;
+	dataGroups = NULL;
+	dataCapacity = 0;
+}
+
+// This function returns the name of the workload that is on.
+const char* activeDataWorkload(void)
+{
+	return (dataOn ? dataKernelName(dataKind) : NULL);
+}
+
+// This function runs one cell of the workload that is on.
+unsigned int measureDataCell(unsigned int threadNo, unsigned int records, float* result)
+{
+	*result = 0;
+
+	if(!reserveRecords(records))
+	{
+		cout << "WARNING: There isn't enough memory for " << records << " records!\n";
+		return 0;
+	}
+
+	dataRecords = records;
+	dataThreads = threadNo;
+	dataKeySpace = max(1ULL, dataRecords/DATA_GROUP_SIZE);
+	dataResult = dataOutput;
+	memset(dataWorkers, 0, sizeof(dataWorkers));
+	memset(phaseNsecs, 0, sizeof(phaseNsecs));
+
+	pthread_t threads[threadNo];
+	pthread_barrier_init(&dataBarrier, NULL, threadNo);
+
+	// Mark the cell on the trace and in the live stats, if they are on.
+	traceCellBegin(records, threadNo);
+	liveCellBegin(records, threadNo);
+
+	for(unsigned int i = 0; i < threadNo; i++)
+	{
+		dataWorkers[i].id = i;
+		pthread_create(&threads[i], NULL, dataGenerator, &dataWorkers[i]);
+	}
+
+	for(unsigned int i = 0; i < threadNo; i++)
+	{
+		pthread_join(threads[i], NULL);
+	}
+
+	traceCellEnd();
+	pthread_barrier_destroy(&dataBarrier);
+
+	bool verified = checkOutput();
+	unsigned int timeTaken = (unsigned int)((phaseNsecs[PHASE_MERGE] - phaseNsecs[PHASE_START])/1000);
+	unsigned long long bytes = dataRecords*sizeof(dataRecord);
+	double seconds = (double)(phaseNsecs[PHASE_MERGE] - phaseNsecs[PHASE_START])/1000000000.0;
+
+	if(!verified)
+	{
+		cout << "WARNING: The " << dataKernelName(dataKind) << " output with " << records
+		     << " records and " << threadNo << " threads is wrong!\n";
+	}
+
+	dataDump << dataKernelName(dataKind) << "," << records << "," << threadNo << "," << bytes << ","
+		 << timeTaken << "," << ((seconds > 0) ? (bytes/seconds)/1000000000.0 : 0) << ","
+		 << (phaseNsecs[PHASE_PARTITION] - phaseNsecs[PHASE_START])/1000 << ","
+		 << (phaseNsecs[PHASE_LOCAL] - phaseNsecs[PHASE_PARTITION])/1000 << ","
+		 << (phaseNsecs[PHASE_MERGE] - phaseNsecs[PHASE_LOCAL])/1000 << ","
+		 << (verified ? 1 : 0) << "\n";
+	dataDump.flush();
+
+	liveCellEnd(records, timeTaken);
+
+	*result = verified ? 1.0f : 0.0f;
+	return timeTaken;
+}
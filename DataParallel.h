@@ -0,0 +1,93 @@
+// Author: Jason Tennyson
+// File: DataParallel.h
+// Date: 10/19/26
+//
+// This file contains the definitions for the data parallel workloads. The
+// increment loops split up perfectly, since no calculation needs any other,
+// but real jobs sort and group records, and every thread ends up needing
+// records that another thread started with. These workloads put n records
+// of a key and a value in memory and have the threads do one of three jobs
+// with them:
+//
+//	samplesort	The threads sample the keys and pick splitters, so that
+//			each thread gets a range of keys. Every thread moves its
+//			records into the ranges (the partition), and then each
+//			thread sorts its own range (the local phase). The ranges
+//			are already in order, so there is nothing to merge.
+//	mergesort	Each thread sorts its own slice (the local phase), and
+//			then the sorted slices are merged in pairs until one is
+//			left (the merge). Every thread merges an equal share of
+//			each round, found by binary search, so no thread sits out.
+//	groupby		Every thread hashes its keys into one partition per
+//			thread (the partition), each thread adds up the count
+//			and the total value of every key in its partition with
+//			a hash table (the local phase), and the groups are
+//			copied together into one list (the merge).
+//
+// The records come from a fixed seed in blocks that don't depend on the
+// thread count, so every cell with the same n sorts the same records. They
+// are made again before every cell, and the output is checked after every
+// cell, and neither is timed. Sorted output has to be in order and have the
+// same records as the input, and the groups have to account for every
+// record exactly once.
+//
+// The workloads are run by the automatic tests, so that they sweep n and the
+// thread count like the increments do. Each cell also gets a row in the data
+// spreadsheet, with how many gigabytes of records went through per second
+// and how long each phase took.
+
+#ifndef DataParallel_h_
+#define DataParallel_h_
+
+#define DATA_EXTENSION		("_data.csv")			// Ending of the data file.
+#define DATA_BLOCK		(65536)				// Records made from one seed.
+#define DATA_OVERSAMPLE		(64)				// Samples per thread for splitters.
+#define DATA_GROUP_SIZE		(16)				// Records per key in the group by.
+
+// These are the data parallel workloads.
+enum dataKernel
+{
+	DATA_SAMPLESORT = 0,	// Sample sort.
+	DATA_MERGESORT,		// Merge sort.
+	DATA_GROUPBY,		// Hash partitioned group by.
+	DATA_KERNELS		// The number of workloads.
+};
+
+// This structure is one record.
+struct dataRecord
+{
+	unsigned long long key;		// What is sorted or grouped on.
+	unsigned long long value;	// Where the record started out.
+};
+
+// This function returns the name of a workload.
+const char* dataKernelName(dataKernel kernel);
+
+// This function finds the workload with the given name. Returns false if
+// there isn't one.
+bool dataKernelFromName(const char* name, dataKernel* kernel);
+
+// This function turns on a data parallel workload for the automatic tests.
+// From then on, every cell runs it on calcs records instead of doing the
+// increments, and gets a row in the data spreadsheet, which is named
+// filename. Returns false if the spreadsheet can't be opened.
+bool enableDataWorkload(const char* filename, dataKernel kernel);
+
+// This function turns the workload back off. The records are kept, so that
+// the next workload that is turned on in this process (the scenario mode
+// runs one after another) doesn't have to allocate and fault them in again.
+void finishDataWorkload(void);
+
+// This function frees the records.
+void releaseDataRecords(void);
+
+// This function returns the name of the workload that is on, or NULL if
+// the cells are doing the increments.
+const char* activeDataWorkload(void);
+
+// This function runs the workload on records records with threadNo threads,
+// and returns the time it took in microseconds. The result is 1 if the
+// output checked out and 0 if it didn't.
+unsigned int measureDataCell(unsigned int threadNo, unsigned int records, float* result);
+
+#endif
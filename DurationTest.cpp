@@ -0,0 +1,234 @@
+// Author: Jason Tennyson
+// File: DurationTest.cpp
+// Date: 10/19/26
+//
+// This file contains the implementation of the duration test. Every thread
+// owns a counter on its own cache line that only it writes to, so the main
+// thread can sample the counters without slowing the workers down. The
+// workers only look at the stop flag between chunks of operations.
+
+#include "DurationTest.h"
+#include "ThreadTutorial.h"
+#include "TimedRun.h"
+#include "TraceRecorder.h"
+#include <vector>
+#include <cmath>
+#include <time.h>
+
+using namespace std;
+
+// This structure is what each thread owns. The sampler reads ops while the
+// thread is still adding to it.
+struct durationSlot
+{
+	unsigned long long ops;		// Operations done so far.
+	unsigned int index;		// Index of the thread.
+	char pad[CACHE_LINE_SIZE - sizeof(unsigned long long) - sizeof(unsigned int)];
+};
+
+// These values have to be stored globally to be accessed by the threads.
+static workload* durationKernel;
+static volatile bool stopRequested;
+static pthread_barrier_t startBarrier;
+
+// This is the function that each thread runs during a duration test.
+static void* durationGenerator(void* slotObject)
+{
+	durationSlot* slot = (durationSlot*)slotObject;
+	bool traced = traceEnabled();
+
+	if(traced)
+	{
+		traceThreadBegin();
+	}
+
+	// Start when the main thread starts taking samples.
+	pthread_barrier_wait(&startBarrier);
+
+	// Run the kernel a chunk at a time until we are told to stop.
+	while(!__atomic_load_n(&stopRequested, __ATOMIC_ACQUIRE))
+	{
+		if(traced)
+		{
+			traceEvent(TRACE_CHUNK_BEGIN, DURATION_CHUNK);
+		}
+
+		durationKernel->run(slot->index, DURATION_CHUNK);
+
+		if(traced)
+		{
+			traceEvent(TRACE_CHUNK_END, 0);
+		}
+
+		// Only we write this, so a plain store is enough, but it has
+		// to be atomic so the sampler never sees half of it.
+		__atomic_store_n(&slot->ops, slot->ops + DURATION_CHUNK, __ATOMIC_RELAXED);
+	}
+
+	if(traced)
+	{
+		traceThreadEnd();
+	}
+
+	return (NULL);
+}
+
+// This function runs the duration test.
+void runDurationTest(const char* filename, workload* kernel, unsigned int threadNo,
+		     unsigned int seconds, unsigned int intervalMsecs)
+{
+	durationSlot* slots = allocateThreadSlots<durationSlot>(threadNo);
+	if(!slots)
+	{
+		return;
+	}
+
+	// Array of thread handles. These are used as thread IDs.
+	pthread_t threads[threadNo];
+
+	// The samples we take. Each one holds every thread's count.
+	vector<unsigned long long> sampleTimes;
+	vector< vector<unsigned long long> > samples;
+
+	// Get the kernel ready.
+	durationKernel = kernel;
+	durationKernel->prepare(threadNo);
+	stopRequested = false;
+	pthread_barrier_init(&startBarrier, NULL, threadNo + 1);
+
+	for(unsigned int i = 0; i < threadNo; i++)
+	{
+		slots[i].index = i;
+		pthread_create(&threads[i], NULL, durationGenerator, &slots[i]);
+	}
+
+	// Let everyone go and start the clock.
+	pthread_barrier_wait(&startBarrier);
+	unsigned long long startNsecs = timeStamp::monotonicNsecs();
+	unsigned long long stopNsecs = startNsecs + (unsigned long long)seconds*1000000000ULL;
+	unsigned long long intervalNsecs = (unsigned long long)intervalMsecs*1000000ULL;
+
+	// Take a sample every interval until the time is up.
+	for(unsigned long long wake = startNsecs + intervalNsecs; wake <= stopNsecs; wake += intervalNsecs)
+	{
+		if(!timeStamp::sleepUntilNsecs(wake))
+		{
+			cout << "WARNING: The sampler could not sleep, so the samples stop here.\n";
+			break;
+		}
+
+		vector<unsigned long long> counts(threadNo);
+		for(unsigned int i = 0; i < threadNo; i++)
+		{
+			counts[i] = __atomic_load_n(&slots[i].ops, __ATOMIC_RELAXED);
+		}
+
+		sampleTimes.push_back(timeStamp::monotonicNsecs() - startNsecs);
+		samples.push_back(counts);
+	}
+
+	// Time is up.
+	timeStamp::sleepUntilNsecs(stopNsecs);
+	__atomic_store_n(&stopRequested, true, __ATOMIC_RELEASE);
+
+	for(unsigned int i = 0; i < threadNo; i++)
+	{
+		pthread_join(threads[i], NULL);
+	}
+
+	double elapsedSecs = (double)(timeStamp::monotonicNsecs() - startNsecs)/1000000000.0;
+	pthread_barrier_destroy(&startBarrier);
+
+	// Total everything up.
+	unsigned long long totalOps = 0;
+	double sumSquares = 0;
+	unsigned long long minOps = slots[0].ops;
+	unsigned long long maxOps = slots[0].ops;
+
+	for(unsigned int i = 0; i < threadNo; i++)
+	{
+		totalOps += slots[i].ops;
+		sumSquares += (double)slots[i].ops*(double)slots[i].ops;
+
+		if(slots[i].ops < minOps)
+		{
+			minOps = slots[i].ops;
+		}
+		if(slots[i].ops > maxOps)
+		{
+			maxOps = slots[i].ops;
+		}
+	}
+
+	// Jain's fairness index is 1 when every thread did the same amount
+	// of work, and 1/threads when one thread did all of it.
+	double fairness = (sumSquares > 0) ? ((double)totalOps*(double)totalOps)/(threadNo*sumSquares) : 1.0;
+	float endResult = durationKernel->finish(totalOps);
+
+	// Create a temp filename to append the spreadsheet folder location
+	// in front of the desired filename.
+	string tempFilename = SPREADSHEET_FOLDER;
+	tempFilename += "/";
+	tempFilename += filename;
+
+	ofstream dataDump(tempFilename.c_str());
+
+	// The time series comes first.
+	dataDump << "Time (ms),Ops/Sec";
+	for(unsigned int i = 0; i < threadNo; i++)
+	{
+		dataDump << ",Ops/Sec " << (i + 1);
+	}
+	dataDump << "\n";
+
+	for(unsigned int s = 0; s < samples.size(); s++)
+	{
+		// The previous sample, or zero for the first one.
+		unsigned long long lastTime = (s ? sampleTimes[s - 1] : 0);
+		double intervalSecs = (double)(sampleTimes[s] - lastTime)/1000000000.0;
+		unsigned long long intervalOps = 0;
+
+		dataDump << sampleTimes[s]/1000000ULL;
+
+		for(unsigned int i = 0; i < threadNo; i++)
+		{
+			intervalOps += samples[s][i] - (s ? samples[s - 1][i] : 0);
+		}
+		dataDump << "," << (unsigned long long)(intervalOps/intervalSecs);
+
+		for(unsigned int i = 0; i < threadNo; i++)
+		{
+			unsigned long long threadOps = samples[s][i] - (s ? samples[s - 1][i] : 0);
+			dataDump << "," << (unsigned long long)(threadOps/intervalSecs);
+		}
+		dataDump << "\n";
+	}
+
+	// Then the per thread totals.
+	dataDump << "\nThread,Ops,Share\n";
+	for(unsigned int i = 0; i < threadNo; i++)
+	{
+		dataDump << (i + 1) << "," << slots[i].ops << ","
+			 << (totalOps ? (double)slots[i].ops/(double)totalOps : 0) << "\n";
+	}
+	dataDump << "Total," << totalOps << ",1\n";
+	dataDump << "Ops/Sec," << (unsigned long long)(totalOps/elapsedSecs) << "\n";
+	dataDump << "Fairness," << fairness << "\n";
+	dataDump << "Result," << endResult << "\n\n";
+	dataDump.close();
+
+	// Print the summary for the user.
+	cout << "\nThe " << durationKernel->name() << " kernel ran on " << threadNo
+	     << " threads for " << elapsedSecs << " sec.\n";
+	cout << "Total operations: " << totalOps << " ("
+	     << (unsigned long long)(totalOps/elapsedSecs) << " ops/sec)\n";
+	for(unsigned int i = 0; i < threadNo; i++)
+	{
+		cout << "  Thread " << (i + 1) << ": " << slots[i].ops << "\n";
+	}
+	cout << "Fairness: " << fairness << " (slowest/fastest thread: "
+	     << (maxOps ? (double)minOps/(double)maxOps : 1.0) << ")\n";
+	cout << "The result is " << endResult << "!\n\n";
+
+	freeThreadSlots(slots);
+}
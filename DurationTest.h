@@ -0,0 +1,31 @@
+// Author: Jason Tennyson
+// File: DurationTest.h
+// Date: 10/19/26
+//
+// This file contains the function prototypes for the duration test. Instead
+// of splitting a fixed n between the threads and timing how long it takes,
+// the duration test lets every thread run the kernel until a shared stop
+// flag is set after a fixed number of seconds. It records how many
+// operations each thread got done, and samples the operations per second
+// at a fixed interval along the way, which shows throttling, frequency
+// drift and unfair locks that a fixed n run averages away.
+
+#ifndef DurationTest_h_
+#define DurationTest_h_
+
+#include "Workload.h"
+
+#define DEFAULT_DURATION	(10)				// Default test length (secs).
+#define MAX_DURATION		(86400)				// Maximum test length (secs).
+#define DEFAULT_INTERVAL	(100)				// Default sample interval (ms).
+#define MIN_INTERVAL		(1)				// Minimum sample interval (ms).
+#define MAX_INTERVAL		(60000)				// Maximum sample interval (ms).
+#define DURATION_CHUNK		(1024)				// Operations between flag checks.
+
+// This function runs kernel on threadNo threads for the given number of
+// seconds, sampling every intervalMsecs milliseconds, and saves the time
+// series and the per thread totals to filename in the spreadsheet folder.
+void runDurationTest(const char* filename, workload* kernel, unsigned int threadNo,
+		     unsigned int seconds, unsigned int intervalMsecs);
+
+#endif
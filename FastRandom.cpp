@@ -0,0 +1,91 @@
+// Author: Jason Tennyson
+// File: FastRandom.cpp
+// Date: 10/19/26
+//
+// This file contains the implementation of the fastRandom class and the
+// thread local generators.
+
+#include "FastRandom.h"
+
+// These are the process seed and the next stream to hand out.
+static unsigned long long randomBaseSeed = DEFAULT_RANDOM_SEED;
+static unsigned int randomNextStream = 0;
+
+// These are the calling thread's generator, and whether it has been seeded.
+static __thread fastRandom threadGenerator;
+static __thread bool threadSeeded = false;
+
+// This function fills in the state from a 64 bit seed with splitmix64.
+void fastRandom::seed(unsigned long long value)
+{
+	for(unsigned int i = 0; i < 4; i++)
+	{
+		value += 0x9E3779B97F4A7C15ULL;
+
+		unsigned long long mixed = value;
+		mixed = (mixed ^ (mixed >> 30))*0xBF58476D1CE4E5B9ULL;
+		mixed = (mixed ^ (mixed >> 27))*0x94D049BB133111EBULL;
+		state[i] = mixed ^ (mixed >> 31);
+	}
+}
+
+// This function seeds the generator and then jumps it ahead stream times.
+void fastRandom::stream(unsigned long long value, unsigned int stream)
+{
+	seed(value);
+
+	for(unsigned int i = 0; i < stream; i++)
+	{
+		jump();
+	}
+}
+
+// This function moves the generator 2^128 numbers ahead. The constants come
+// from the xoshiro256** reference code.
+void fastRandom::jump(void)
+{
+	static const unsigned long long jumps[4] = { 0x180EC6D33CFD0ABAULL, 0xD5A61266F0C9392CULL,
+						     0xA9582618E03FC9AAULL, 0x39ABDC4529B1661CULL };
+	unsigned long long jumped[4] = { 0, 0, 0, 0 };
+
+	for(unsigned int i = 0; i < 4; i++)
+	{
+		for(unsigned int bit = 0; bit < 64; bit++)
+		{
+			if(jumps[i] & (1ULL << bit))
+			{
+				for(unsigned int j = 0; j < 4; j++)
+				{
+					jumped[j] ^= state[j];
+				}
+			}
+
+			next();
+		}
+	}
+
+	for(unsigned int j = 0; j < 4; j++)
+	{
+		state[j] = jumped[j];
+	}
+}
+
+// This function returns the calling thread's own generator.
+fastRandom* threadRandom(void)
+{
+	if(!threadSeeded)
+	{
+		threadGenerator.stream(randomBaseSeed, __atomic_fetch_add(&randomNextStream, 1, __ATOMIC_RELAXED));
+		threadSeeded = true;
+	}
+
+	return &threadGenerator;
+}
+
+// This function sets the process seed and starts the streams over.
+void setRandomSeed(unsigned long long seed)
+{
+	randomBaseSeed = seed;
+	__atomic_store_n(&randomNextStream, 0, __ATOMIC_RELAXED);
+	threadSeeded = false;
+}
@@ -0,0 +1,92 @@
+// Author: Jason Tennyson
+// File: FastRandom.h
+// Date: 10/19/26
+//
+// This file contains the class definition for the fastRandom class, the
+// random number generator that the rest of the program uses. The C library's
+// rand() keeps its state in one hidden place that every thread shares, and
+// glibc puts a lock around it, so threads that call it at the same time wait
+// for each other. A fastRandom belongs to whoever made it, so nothing is
+// shared, and each thread can have its own with threadRandom().
+//
+// The generator is xoshiro256** (Blackman and Vigna). Its 256 bits of state
+// are filled in from a 64 bit seed with splitmix64, since xoshiro does badly
+// when the state starts out with few bits set. jump() moves a generator 2^128
+// numbers ahead, so generators that start from the same seed and are jumped
+// a different number of times never run into each other's numbers. Those are
+// the streams.
+
+#ifndef FastRandom_h_
+#define FastRandom_h_
+
+#define DEFAULT_RANDOM_SEED	(0x9E3779B97F4A7C15ULL)		// Seed when none is given.
+
+// This class is one xoshiro256** generator. It has no constructor, so that
+// it can be a thread local. One of the seed functions has to be called
+// before it is used.
+class fastRandom
+{
+	public:
+		// This function fills in the state from a 64 bit seed.
+		void seed(unsigned long long value);
+
+		// This function seeds the generator and then jumps it ahead
+		// stream times, so every stream of a seed is independent.
+		void stream(unsigned long long value, unsigned int stream);
+
+		// This function moves the generator 2^128 numbers ahead.
+		void jump(void);
+
+		// This function returns the next 64 random bits.
+		unsigned long long next(void)
+		{
+			unsigned long long result = rotate(state[1]*5, 7)*9;
+			unsigned long long shifted = state[1] << 17;
+
+			state[2] ^= state[0];
+			state[3] ^= state[1];
+			state[1] ^= state[2];
+			state[0] ^= state[3];
+			state[2] ^= shifted;
+			state[3] = rotate(state[3], 45);
+
+			return result;
+		}
+
+		// This function returns a random number from 0 up to, but not
+		// including, 1.
+		double unit(void)
+		{
+			return (double)(next() >> 11)*(1.0/9007199254740992.0);
+		}
+
+		// This function returns a random number from 0 up to, but not
+		// including, bound. It uses the top of a 128 bit product instead
+		// of a divide, and the bias is too small to matter for a bound
+		// that fits in 32 bits.
+		unsigned long long below(unsigned long long bound)
+		{
+			return (unsigned long long)(((unsigned __int128)next()*bound) >> 64);
+		}
+
+	private:
+		// This function rotates the bits of value left by count.
+		static unsigned long long rotate(unsigned long long value, int count)
+		{
+			return (value << count) | (value >> (64 - count));
+		}
+
+		unsigned long long state[4];
+};
+
+// This function returns the calling thread's own generator. Each thread's
+// generator is the next stream of the process seed, and is seeded the first
+// time the thread asks for it.
+fastRandom* threadRandom(void);
+
+// This function sets the process seed and starts the streams over. Threads
+// that already have a generator keep it, except for the calling thread,
+// which gets a new one the next time it asks.
+void setRandomSeed(unsigned long long seed);
+
+#endif
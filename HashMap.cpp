@@ -0,0 +1,590 @@
+// Author: Jason Tennyson
+// File: HashMap.cpp
+// Date: 10/19/26
+//
+// This file contains the maps and the implementation of the hash map test.
+// Every thread draws its keys and operations ahead of time, into a list of
+// MAP_SAMPLES that it goes around and around, so that working out a Zipfian
+// key (which takes a pow) isn't part of what is timed. Before every run the
+// map is filled with every other key, so that lookups find about half of
+// what they look for and inserts and erases have something to do.
+//
+// Every thread counts the inserts and erases that changed the map. After a
+// run, the keys in the map have to add up to the fill plus the inserts
+// minus the erases, or one of the maps lost an update.
+
+#include "HashMap.h"
+#include "NameList.h"
+#include "ThreadTutorial.h"
+#include "Workload.h"
+#include "FastRandom.h"
+#include "TimedRun.h"
+#include <cmath>
+#include <cstring>
+#include <cstdio>
+#include <sstream>
+#include <vector>
+
+using namespace std;
+
+// These are the names of the maps, in the order of mapType.
+static const char* mapNames[MAP_TYPES] = { "locked", "striped", "lockfree" };
+
+// These are the names of the skews, in the order of keySkew.
+static const char* skewNames[KEY_SKEWS] = { "uniform", "zipf" };
+
+// These are the kinds of operations. They are kept in the top bits of a
+// drawn operation, above the key.
+#define OP_LOOKUP		(0ULL)
+#define OP_INSERT		(1ULL)
+#define OP_ERASE		(2ULL)
+#define OP_SHIFT		(62)
+
+// This structure is one thread's list of operations and what it counted
+// while doing them.
+struct mapSlot
+{
+	unsigned long long* samples;	// The operations to go around.
+	unsigned long long ops;		// Operations done.
+	unsigned long long inserted;	// Inserts that added a key.
+	unsigned long long erased;	// Erases that took one out.
+	char pad[CACHE_LINE_SIZE];
+};
+
+// This is the map that every thread works on.
+static concurrentMap* sharedMap;
+
+// This function scrambles a key, so that keys next to each other don't end
+// up next to each other in a table. It is the finalizer from splitmix64.
+static inline unsigned long long mixKey(unsigned long long key)
+{
+	key ^= key >> 30;
+	key *= 0xBF58476D1CE4E5B9ULL;
+	key ^= key >> 27;
+	key *= 0x94D049BB133111EBULL;
+	key ^= key >> 31;
+
+	return key;
+}
+
+// This is the constructor for the lockedMap class.
+lockedMap::lockedMap(unsigned long long keys)
+{
+	table.reserve(keys);
+	pthread_mutex_init(&mutex, NULL);
+}
+
+// This is the destructor for the lockedMap class.
+lockedMap::~lockedMap(void)
+{
+	pthread_mutex_destroy(&mutex);
+}
+
+// This function looks for a key.
+bool lockedMap::lookup(unsigned long long key)
+{
+	pthread_mutex_lock(&mutex);
+	bool found = (table.find(key) != table.end());
+	pthread_mutex_unlock(&mutex);
+
+	return found;
+}
+
+// This function puts a key in the map.
+bool lockedMap::insert(unsigned long long key, unsigned long long value)
+{
+	pthread_mutex_lock(&mutex);
+	bool added = table.insert(make_pair(key, value)).second;
+	pthread_mutex_unlock(&mutex);
+
+	return added;
+}
+
+// This function takes a key out of the map.
+bool lockedMap::erase(unsigned long long key)
+{
+	pthread_mutex_lock(&mutex);
+	bool erased = (table.erase(key) > 0);
+	pthread_mutex_unlock(&mutex);
+
+	return erased;
+}
+
+// This function counts the keys in the map.
+unsigned long long lockedMap::size(void)
+{
+	return table.size();
+}
+
+// This is the constructor for the stripedMap class.
+stripedMap::stripedMap(unsigned long long keys)
+{
+	stripes = new stripe[MAP_STRIPES];
+
+	for(unsigned int i = 0; i < MAP_STRIPES; i++)
+	{
+		pthread_mutex_init(&stripes[i].mutex, NULL);
+		stripes[i].table.reserve(keys/MAP_STRIPES + 1);
+	}
+}
+
+// This is the destructor for the stripedMap class.
+stripedMap::~stripedMap(void)
+{
+	for(unsigned int i = 0; i < MAP_STRIPES; i++)
+	{
+		pthread_mutex_destroy(&stripes[i].mutex);
+	}
+
+	delete [] stripes;
+}
+
+// This function returns the stripe that a key belongs to. The top bits of
+// the scrambled key are used, since unordered_map uses the key itself.
+stripedMap::stripe& stripedMap::stripeFor(unsigned long long key)
+{
+	return stripes[mixKey(key) >> 58];
+}
+
+// This function looks for a key.
+bool stripedMap::lookup(unsigned long long key)
+{
+	stripe& owner = stripeFor(key);
+
+	pthread_mutex_lock(&owner.mutex);
+	bool found = (owner.table.find(key) != owner.table.end());
+	pthread_mutex_unlock(&owner.mutex);
+
+	return found;
+}
+
+// This function puts a key in the map.
+bool stripedMap::insert(unsigned long long key, unsigned long long value)
+{
+	stripe& owner = stripeFor(key);
+
+	pthread_mutex_lock(&owner.mutex);
+	bool added = owner.table.insert(make_pair(key, value)).second;
+	pthread_mutex_unlock(&owner.mutex);
+
+	return added;
+}
+
+// This function takes a key out of the map.
+bool stripedMap::erase(unsigned long long key)
+{
+	stripe& owner = stripeFor(key);
+
+	pthread_mutex_lock(&owner.mutex);
+	bool erased = (owner.table.erase(key) > 0);
+	pthread_mutex_unlock(&owner.mutex);
+
+	return erased;
+}
+
+// This function counts the keys in the map.
+unsigned long long stripedMap::size(void)
+{
+	unsigned long long total = 0;
+
+	for(unsigned int i = 0; i < MAP_STRIPES; i++)
+	{
+		total += stripes[i].table.size();
+	}
+
+	return total;
+}
+
+// This is the constructor for the lockFreeMap class. The table has at
+// least twice as many slots as there can be keys, so probes stay short.
+lockFreeMap::lockFreeMap(unsigned long long keys)
+{
+	unsigned long long capacity = 1;
+	while(capacity < 2*keys)
+	{
+		capacity *= 2;
+	}
+
+	slots = new slot[capacity];
+	memset(slots, 0, capacity*sizeof(slot));
+	mask = capacity - 1;
+}
+
+// This is the destructor for the lockFreeMap class.
+lockFreeMap::~lockFreeMap(void)
+{
+	delete [] slots;
+}
+
+// This function finds the slot of a key. Keys are never taken back out of
+// their slots, so every slot before the key's slot in its probe sequence is
+// full for good, and the first slot that is empty or has the key is the
+// only place the key can be.
+lockFreeMap::slot* lockFreeMap::find(unsigned long long key, bool claim)
+{
+	for(unsigned long long index = mixKey(key) & mask; ; index = (index + 1) & mask)
+	{
+		unsigned long long found = __atomic_load_n(&slots[index].key, __ATOMIC_ACQUIRE);
+
+		if(found == key)
+		{
+			return &slots[index];
+		}
+
+		if(found == 0)
+		{
+			if(!claim)
+			{
+				return NULL;
+			}
+
+			// Someone else can get here first, and if they were
+			// putting in the same key, the slot is still ours.
+			if(__atomic_compare_exchange_n(&slots[index].key, &found, key, false,
+						       __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE) || (found == key))
+			{
+				return &slots[index];
+			}
+		}
+	}
+}
+
+// This function looks for a key.
+bool lockFreeMap::lookup(unsigned long long key)
+{
+	slot* keySlot = find(key, false);
+
+	return (keySlot && (__atomic_load_n(&keySlot->value, __ATOMIC_ACQUIRE) != 0));
+}
+
+// This function puts a key in the map.
+bool lockFreeMap::insert(unsigned long long key, unsigned long long value)
+{
+	slot* keySlot = find(key, true);
+	unsigned long long expected = 0;
+
+	// Like unordered_map, a key that is already there keeps its value.
+	return __atomic_compare_exchange_n(&keySlot->value, &expected, value, false,
+					   __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+}
+
+// This function takes a key out of the map.
+bool lockFreeMap::erase(unsigned long long key)
+{
+	slot* keySlot = find(key, false);
+
+	return (keySlot && (__atomic_exchange_n(&keySlot->value, 0, __ATOMIC_ACQ_REL) != 0));
+}
+
+// This function counts the keys in the map.
+unsigned long long lockFreeMap::size(void)
+{
+	unsigned long long total = 0;
+
+	for(unsigned long long i = 0; i <= mask; i++)
+	{
+		total += (slots[i].value != 0);
+	}
+
+	return total;
+}
+
+// This function returns the name of a map.
+const char* mapName(mapType type)
+{
+	return ((type < MAP_TYPES) ? mapNames[type] : "unknown");
+}
+
+// This function reads a comma separated list of map names. Names we don't
+// know and repeats are skipped.
+unsigned int mapListFromNames(const char* names, mapType* types)
+{
+	return readNameList(names, mapNames, MAP_TYPES, types);
+}
+
+// This function reads a comma separated list of mixes. Mixes that don't
+// add up to 100 are skipped.
+unsigned int mapMixesFromText(const char* text, mapMix* mixes)
+{
+	unsigned int count = 0;
+
+	while((*text != '\0') && (count < MAX_MAP_MIXES))
+	{
+		mapMix mix;
+		int used = 0;
+
+		if((sscanf(text, "%u:%u:%u%n", &mix.lookups, &mix.inserts, &mix.erases, &used) == 3) &&
+		   ((mix.lookups + mix.inserts + mix.erases) == 100))
+		{
+			mixes[count++] = mix;
+		}
+
+		// Move on to the next mix.
+		while((*text != '\0') && (*text != ','))
+		{
+			text++;
+		}
+		if(*text == ',')
+		{
+			text++;
+		}
+	}
+
+	return count;
+}
+
+// This function creates a map of the given type.
+concurrentMap* createMap(mapType type, unsigned long long keys)
+{
+	switch(type)
+	{
+		case MAP_STRIPED:
+			return new stripedMap(keys);
+		case MAP_LOCKFREE:
+			return new lockFreeMap(keys);
+		default:
+			return new lockedMap(keys);
+	}
+}
+
+// This class draws ranks from a Zipfian distribution over 0 to n - 1, with
+// the method from Gray et al., "Quickly Generating Billion-Record Synthetic
+// Databases", which is what YCSB uses. Rank 0 is the most popular.
+class zipfDraw
+{
+	public:
+		// This is the class constructor. Working out zeta takes a pass
+		// over every rank, so it is only done once per key count.
+		zipfDraw(unsigned long long count, double theta)
+		{
+			n = count;
+			alpha = 1.0/(1.0 - theta);
+			zetaN = 0;
+
+			for(unsigned long long i = 1; i <= n; i++)
+			{
+				zetaN += 1.0/pow((double)i, theta);
+			}
+
+			half = pow(0.5, theta);
+			eta = (1.0 - pow(2.0/n, 1.0 - theta))/(1.0 - (1.0 + half)/zetaN);
+		}
+
+		// This function turns a uniform number from 0 to 1 into a rank.
+		unsigned long long rank(double uniform)
+		{
+			double scaled = uniform*zetaN;
+
+			if(scaled < 1.0)
+			{
+				return 0;
+			}
+			if(scaled < (1.0 + half))
+			{
+				return 1;
+			}
+
+			unsigned long long drawn = (unsigned long long)(n*pow(eta*uniform - eta + 1.0, alpha));
+
+			return ((drawn < n) ? drawn : (n - 1));
+		}
+
+	private:
+		unsigned long long n;
+		double alpha, zetaN, half, eta;
+};
+
+// This function draws a thread's operations ahead of time, with its own
+// stream of random numbers.
+static void drawSamples(unsigned long long* samples, unsigned long long keys, keySkew skew,
+			const mapMix& mix, zipfDraw* zipf, unsigned int stream)
+{
+	fastRandom random;
+	random.stream(DEFAULT_RANDOM_SEED, stream);
+
+	for(unsigned int i = 0; i < MAP_SAMPLES; i++)
+	{
+		double uniform = random.unit();
+
+		// The Zipfian ranks are scrambled onto the keys, so that the
+		// popular keys aren't all next to each other.
+		unsigned long long key;
+		if(skew == SKEW_ZIPF)
+		{
+			key = (mixKey(zipf->rank(uniform)) % keys) + 1;
+		}
+		else
+		{
+			key = (unsigned long long)(uniform*keys) + 1;
+		}
+
+		unsigned int percent = random.below(100);
+
+		unsigned long long kind = OP_LOOKUP;
+		if(percent >= mix.lookups)
+		{
+			kind = (percent < (mix.lookups + mix.inserts)) ? OP_INSERT : OP_ERASE;
+		}
+
+		samples[i] = (kind << OP_SHIFT) | key;
+	}
+}
+
+// This is the function that each thread runs during the hash map test.
+static void* mapGenerator(void* slotObject)
+{
+	mapSlot* slot = (mapSlot*)slotObject;
+	const unsigned long long keyMask = (1ULL << OP_SHIFT) - 1;
+	unsigned int next = 0;
+
+	timedRunBegin();
+
+	while(!timedRunOver())
+	{
+		for(unsigned int i = 0; i < MAP_CHUNK; i++)
+		{
+			unsigned long long sample = slot->samples[next];
+			unsigned long long key = sample & keyMask;
+
+			next = (next + 1)%MAP_SAMPLES;
+
+			switch(sample >> OP_SHIFT)
+			{
+				case OP_INSERT:
+					slot->inserted += sharedMap->insert(key, key);
+					break;
+				case OP_ERASE:
+					slot->erased += sharedMap->erase(key);
+					break;
+				default:
+					sharedMap->lookup(key);
+					break;
+			}
+		}
+
+		slot->ops += MAP_CHUNK;
+	}
+
+	return (NULL);
+}
+
+// This function runs the hash map test.
+void runHashMapTest(const char* filename, const mapType* maps, unsigned int mapCount,
+		    const mapMix* mixes, unsigned int mixCount, unsigned long long maxKeys,
+		    unsigned int maxThreads, unsigned int cellMsecs)
+{
+	// The key counts go up by MAP_KEY_STEP at a time, and end at maxKeys.
+	vector<unsigned long long> keyCounts;
+	for(unsigned long long keys = MIN_MAP_KEYS; keys < maxKeys; keys *= MAP_KEY_STEP)
+	{
+		keyCounts.push_back(keys);
+	}
+	keyCounts.push_back(maxKeys);
+
+	// Create a temp filename to append the spreadsheet folder location
+	// in front of the desired filename.
+	string tempFilename = SPREADSHEET_FOLDER;
+	tempFilename += "/";
+	tempFilename += filename;
+
+	ofstream dataDump(tempFilename.c_str());
+
+	// Write the top line of the data file.
+	dataDump << "Map,Keys,Skew,Lookup (%),Insert (%),Erase (%)";
+	for(unsigned int t = MIN_THREADS; t <= maxThreads; t++)
+	{
+		dataDump << ",Ops/Sec " << t;
+	}
+	dataDump << "\n";
+
+	// Every thread's operations, drawn once per row.
+	vector<unsigned long long> samples((unsigned long long)maxThreads*MAP_SAMPLES);
+
+	for(unsigned int k = 0; k < keyCounts.size(); k++)
+	{
+		unsigned long long keys = keyCounts[k];
+		zipfDraw zipf(keys, ZIPF_THETA);
+
+		for(unsigned int skew = 0; skew < KEY_SKEWS; skew++)
+		{
+			for(unsigned int x = 0; x < mixCount; x++)
+			{
+				for(unsigned int i = 0; i < maxThreads; i++)
+				{
+					drawSamples(&samples[(unsigned long long)i*MAP_SAMPLES], keys, (keySkew)skew,
+						    mixes[x], &zipf, i);
+				}
+
+				for(unsigned int m = 0; m < mapCount; m++)
+				{
+					dataDump << mapName(maps[m]) << "," << keys << "," << skewNames[skew] << ","
+						 << mixes[x].lookups << "," << mixes[x].inserts << "," << mixes[x].erases;
+
+					for(unsigned int threadNo = MIN_THREADS; threadNo <= maxThreads; threadNo++)
+					{
+						// Start every run from the same half full map.
+						sharedMap = createMap(maps[m], keys);
+						unsigned long long filled = 0;
+
+						for(unsigned long long key = 1; key <= keys; key += 2)
+						{
+							filled += sharedMap->insert(key, key);
+						}
+
+						mapSlot* slots = allocateThreadSlots<mapSlot>(threadNo);
+						double elapsedSecs;
+
+						for(unsigned int i = 0; slots && (i < threadNo); i++)
+						{
+							slots[i].samples = &samples[(unsigned long long)i*MAP_SAMPLES];
+						}
+
+						if(!slots || !runTimedThreads(mapGenerator, slots, sizeof(mapSlot), threadNo,
+									      cellMsecs, &elapsedSecs, NULL, NULL, 0))
+						{
+							cout << "WARNING: Could not run " << threadNo << " threads, so the cell is marked as failed.\n";
+							dataDump << ",failed";
+
+							freeThreadSlots(slots);
+							delete sharedMap;
+							continue;
+						}
+
+						// Total everything up and check that the map
+						// has every key that it should.
+						unsigned long long totalOps = 0;
+						long long expected = filled;
+
+						for(unsigned int i = 0; i < threadNo; i++)
+						{
+							totalOps += slots[i].ops;
+							expected += slots[i].inserted;
+							expected -= slots[i].erased;
+						}
+
+						if((long long)sharedMap->size() != expected)
+						{
+							cout << "WARNING: The " << mapName(maps[m]) << " map has "
+							     << sharedMap->size() << " keys, but should have " << expected << ".\n";
+						}
+
+						dataDump << "," << (unsigned long long)(totalOps/elapsedSecs);
+
+						freeThreadSlots(slots);
+						delete sharedMap;
+					}
+
+					dataDump << "\n";
+					dataDump.flush();
+				}
+
+				cout << keys << " keys, " << skewNames[skew] << ", "
+				     << mixes[x].lookups << "/" << mixes[x].inserts << "/" << mixes[x].erases << " done.\n";
+			}
+		}
+	}
+
+	// Append an extra new line character to the end of the file.
+	dataDump << "\n";
+	dataDump.close();
+}
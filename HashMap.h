@@ -0,0 +1,206 @@
+// Author: Jason Tennyson
+// File: HashMap.h
+// Date: 10/19/26
+//
+// This file contains the definitions for the hash map test. The rest of the
+// program fights over one counter, but what real programs usually share is
+// a map. This test runs a mix of lookups, inserts and erases against three
+// maps that are protected three different ways:
+//
+//	locked		A std::unordered_map behind one mutex. Every thread
+//			waits for every other one, no matter which key.
+//	striped		The keys are split across MAP_STRIPES unordered_maps,
+//			each with its own mutex, so threads only wait for
+//			each other when their keys land in the same stripe.
+//	lockfree	An open addressing table where every slot is claimed
+//			and changed with atomics, so no thread ever waits.
+//
+// It sweeps the number of keys, how skewed the keys are (uniform, or a
+// Zipfian distribution where a few keys get most of the operations, like
+// real traffic) and the mix of operations, with every thread count.
+//
+// The results go in a spreadsheet of their own, not the one that -auto
+// writes. That one has a time and a result for every n, and this test has
+// no n: it counts how many operations get done in a fixed time, for every
+// map, key count, skew and mix.
+
+#ifndef HashMap_h_
+#define HashMap_h_
+
+#include <pthread.h>
+#include <unordered_map>
+
+#define MIN_MAP_KEYS		(256)				// Fewest keys in the sweep.
+#define DEFAULT_MAP_KEYS	(1048576)			// Default most keys.
+#define MAX_MAP_KEYS		(67108864)			// Most keys allowed.
+#define MAP_KEY_STEP		(16)				// Key count multiplier per row.
+#define MAP_STRIPES		(64)				// Stripes in the striped map.
+#define MAP_SAMPLES		(65536)				// Operations drawn per thread.
+#define MAP_CHUNK		(256)				// Operations between flag checks.
+#define DEFAULT_MAP_MSECS	(200)				// Default time per cell (ms).
+#define MAX_MAP_MSECS		(60000)				// Maximum time per cell (ms).
+#define ZIPF_THETA		(0.99)				// Skew of the Zipfian keys.
+#define MAX_MAP_MIXES		(8)				// Most operation mixes.
+
+// These are the maps that can be compared.
+enum mapType
+{
+	MAP_LOCKED = 0,		// One unordered_map behind one mutex.
+	MAP_STRIPED,		// Unordered_maps behind a mutex each.
+	MAP_LOCKFREE,		// Open addressing with atomics.
+	MAP_TYPES		// The number of maps.
+};
+
+// These are the ways that keys can be picked.
+enum keySkew
+{
+	SKEW_UNIFORM = 0,	// Every key is as likely as any other.
+	SKEW_ZIPF,		// A few keys get most of the operations.
+	KEY_SKEWS		// The number of skews.
+};
+
+// This structure is a mix of operations, in percent.
+struct mapMix
+{
+	unsigned int lookups;	// Percent of operations that are lookups.
+	unsigned int inserts;	// Percent that are inserts.
+	unsigned int erases;	// Percent that are erases.
+};
+
+// This class is the interface that every map implements. The keys and
+// values are never 0, which the lock free map uses to mean empty.
+class concurrentMap
+{
+	public:
+		// This is the class destructor.
+		virtual ~concurrentMap(void) {}
+
+		// This function returns true if the key is in the map.
+		virtual bool lookup(unsigned long long key) = 0;
+
+		// This function puts the key in the map with the given value.
+		// Returns true if the key wasn't there before.
+		virtual bool insert(unsigned long long key, unsigned long long value) = 0;
+
+		// This function takes the key out of the map. Returns true if
+		// it was there.
+		virtual bool erase(unsigned long long key) = 0;
+
+		// This function counts the keys in the map. It is only called
+		// when no other thread is using the map.
+		virtual unsigned long long size(void) = 0;
+};
+
+// This class is a std::unordered_map behind one mutex.
+class lockedMap : public concurrentMap
+{
+	public:
+		// This is the class constructor.
+		lockedMap(unsigned long long keys);
+		// This is the class destructor.
+		~lockedMap(void);
+
+		bool lookup(unsigned long long key);
+		bool insert(unsigned long long key, unsigned long long value);
+		bool erase(unsigned long long key);
+		unsigned long long size(void);
+
+	private:
+		// The map and the mutex that protects it.
+		std::unordered_map<unsigned long long, unsigned long long> table;
+		pthread_mutex_t mutex;
+};
+
+// This class splits the keys across unordered_maps with a mutex each.
+class stripedMap : public concurrentMap
+{
+	public:
+		// This is the class constructor.
+		stripedMap(unsigned long long keys);
+		// This is the class destructor.
+		~stripedMap(void);
+
+		bool lookup(unsigned long long key);
+		bool insert(unsigned long long key, unsigned long long value);
+		bool erase(unsigned long long key);
+		unsigned long long size(void);
+
+	private:
+		// This structure is one stripe. The mutexes are kept on cache
+		// lines of their own, so that two threads using two stripes
+		// don't fight over a line.
+		struct stripe
+		{
+			pthread_mutex_t mutex;
+			std::unordered_map<unsigned long long, unsigned long long> table;
+			char pad[64];
+		};
+
+		// This function returns the stripe that a key belongs to.
+		stripe& stripeFor(unsigned long long key);
+
+		// The stripes.
+		stripe* stripes;
+};
+
+// This class is an open addressing table with linear probing that never
+// takes a lock. A key is claimed into an empty slot with a compare and swap
+// and then stays in that slot for good, so a search can stop at the first
+// empty slot. Erasing a key just sets its value back to 0. The table is
+// made big enough up front that it never has to grow.
+class lockFreeMap : public concurrentMap
+{
+	public:
+		// This is the class constructor.
+		lockFreeMap(unsigned long long keys);
+		// This is the class destructor.
+		~lockFreeMap(void);
+
+		bool lookup(unsigned long long key);
+		bool insert(unsigned long long key, unsigned long long value);
+		bool erase(unsigned long long key);
+		unsigned long long size(void);
+
+	private:
+		// This structure is one slot of the table.
+		struct slot
+		{
+			unsigned long long key;		// 0 until it is claimed.
+			unsigned long long value;	// 0 when the key is erased.
+		};
+
+		// This function finds the slot that holds the key, or claims an
+		// empty one for it if claim is set. Returns NULL if the key
+		// isn't there and claim is not set.
+		slot* find(unsigned long long key, bool claim);
+
+		// The table and the mask that wraps an index around it.
+		slot* slots;
+		unsigned long long mask;
+};
+
+// This function returns the name of a map.
+const char* mapName(mapType type);
+
+// This function reads a comma separated list of map names into types,
+// which must have room for MAP_TYPES entries. Returns the count.
+unsigned int mapListFromNames(const char* names, mapType* types);
+
+// This function reads a comma separated list of mixes like "90:5:5,50:25:25"
+// (lookups, inserts and erases in percent) into mixes, which must have room
+// for MAX_MAP_MIXES entries. Returns the count.
+unsigned int mapMixesFromText(const char* text, mapMix* mixes);
+
+// This function creates a map of the given type with room for keys keys.
+// The caller deletes it when done.
+concurrentMap* createMap(mapType type, unsigned long long keys);
+
+// This function runs every map with every key count from MIN_MAP_KEYS up to
+// maxKeys, both skews and every mix, with 1 up to maxThreads threads for
+// cellMsecs each, and saves the operations per second of every run to
+// filename in the spreadsheet folder, one column per thread count.
+void runHashMapTest(const char* filename, const mapType* maps, unsigned int mapCount,
+		    const mapMix* mixes, unsigned int mixCount, unsigned long long maxKeys,
+		    unsigned int maxThreads, unsigned int cellMsecs);
+
+#endif
@@ -0,0 +1,127 @@
+// Author: Jason Tennyson
+// File: LatencyHistogram.cpp
+// Date: 10/19/26
+//
+// This file contains the function definitions for the latencyHistogram
+// class. Values below LATENCY_SUB_BUCKETS get a bucket each. Above that,
+// the bucket is picked by the position of the highest set bit and the
+// LATENCY_SUB_BITS bits right below it.
+
+#include "LatencyHistogram.h"
+#include <cstring>
+
+// This is the constructor for the latencyHistogram class.
+latencyHistogram::latencyHistogram(void)
+{
+	clear();
+}
+
+// This function empties the histogram.
+void latencyHistogram::clear(void)
+{
+	memset(buckets, 0, sizeof(buckets));
+	total = sum = largest = 0;
+	smallest = ~0ULL;
+}
+
+// This function returns the bucket a value goes into.
+unsigned int latencyHistogram::bucketOf(unsigned long long nsecs)
+{
+	// Small values are exact.
+	if(nsecs < LATENCY_SUB_BUCKETS)
+	{
+		return (unsigned int)nsecs;
+	}
+
+	// The position of the highest set bit picks the power of two, and the
+	// bits right below it pick the slice within it.
+	unsigned int highBit = 63 - __builtin_clzll(nsecs);
+	unsigned int shift = highBit - LATENCY_SUB_BITS;
+	unsigned int slice = (unsigned int)(nsecs >> shift) - LATENCY_SUB_BUCKETS;
+
+	return (shift + 1)*LATENCY_SUB_BUCKETS + slice;
+}
+
+// This function returns the highest value that lands in a bucket.
+unsigned long long latencyHistogram::valueOf(unsigned int bucket)
+{
+	if(bucket < LATENCY_SUB_BUCKETS)
+	{
+		return bucket;
+	}
+
+	unsigned int shift = (bucket/LATENCY_SUB_BUCKETS) - 1;
+	unsigned long long slice = (bucket%LATENCY_SUB_BUCKETS) + LATENCY_SUB_BUCKETS;
+
+	return ((slice + 1) << shift) - 1;
+}
+
+// This function records one latency.
+void latencyHistogram::record(unsigned long long nsecs)
+{
+	buckets[bucketOf(nsecs)]++;
+	total++;
+	sum += nsecs;
+
+	if(nsecs < smallest)
+	{
+		smallest = nsecs;
+	}
+	if(nsecs > largest)
+	{
+		largest = nsecs;
+	}
+}
+
+// This function adds all of the counts of another histogram.
+void latencyHistogram::merge(const latencyHistogram& other)
+{
+	for(unsigned int i = 0; i < LATENCY_BUCKETS; i++)
+	{
+		buckets[i] += other.buckets[i];
+	}
+
+	total += other.total;
+	sum += other.sum;
+
+	if(other.smallest < smallest)
+	{
+		smallest = other.smallest;
+	}
+	if(other.largest > largest)
+	{
+		largest = other.largest;
+	}
+}
+
+// This function returns the given percentile.
+unsigned long long latencyHistogram::percentile(double percent)
+{
+	if(total == 0)
+	{
+		return 0;
+	}
+
+	// The number of values that have to be at or below the answer.
+	unsigned long long needed = (unsigned long long)((percent/100.0)*(double)total + 0.5);
+	unsigned long long seen = 0;
+
+	if(needed == 0)
+	{
+		needed = 1;
+	}
+
+	for(unsigned int i = 0; i < LATENCY_BUCKETS; i++)
+	{
+		seen += buckets[i];
+
+		if(seen >= needed)
+		{
+			// Never report more than what was actually seen.
+			unsigned long long value = valueOf(i);
+			return (value > largest ? largest : value);
+		}
+	}
+
+	return largest;
+}
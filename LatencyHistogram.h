@@ -0,0 +1,55 @@
+// Author: Jason Tennyson
+// File: LatencyHistogram.h
+// Date: 10/19/26
+//
+// This file contains the class definition for the latencyHistogram class.
+// The histogram records nanosecond latencies into log-linear buckets: each
+// power of two is split into LATENCY_SUB_BUCKETS equal slices, so every
+// value is kept to within about 1.6% no matter how big it is, and recording
+// a value never allocates anything.
+
+#ifndef LatencyHistogram_h_
+#define LatencyHistogram_h_
+
+#define LATENCY_SUB_BITS	(6)				// Bits of precision per power of two.
+#define LATENCY_SUB_BUCKETS	(1 << LATENCY_SUB_BITS)		// Slices per power of two.
+#define LATENCY_BUCKETS		(64*LATENCY_SUB_BUCKETS)	// Total number of buckets.
+
+// This class counts latencies in log-linear buckets.
+class latencyHistogram
+{
+	public:
+		// This is the class constructor. It starts out empty.
+		latencyHistogram(void);
+
+		// This function empties the histogram.
+		void clear(void);
+
+		// This function records one latency in nanoseconds.
+		void record(unsigned long long nsecs);
+
+		// This function adds all of the counts of another histogram.
+		void merge(const latencyHistogram& other);
+
+		// This function returns the latency below which the given
+		// percentage (0-100) of the recorded values fall.
+		unsigned long long percentile(double percent);
+
+		// These functions return simple statistics.
+		unsigned long long count(void) { return total; }
+		unsigned long long minimum(void) { return (total ? smallest : 0); }
+		unsigned long long maximum(void) { return largest; }
+		double mean(void) { return (total ? (double)sum/(double)total : 0); }
+
+	private:
+		// The count in every bucket.
+		unsigned long long buckets[LATENCY_BUCKETS];
+		// The number of values, their sum, and the extremes.
+		unsigned long long total, sum, smallest, largest;
+
+		// These functions convert between values and bucket indexes.
+		static unsigned int bucketOf(unsigned long long nsecs);
+		static unsigned long long valueOf(unsigned int bucket);
+};
+
+#endif
@@ -0,0 +1,351 @@
+// Author: Jason Tennyson
+// File: LiveStats.cpp
+// Date: 10/19/26
+//
+// This file contains the implementation of the live stats segment, for both
+// the test that writes it and the reader that prints it. The segment is
+// MAP_SHARED, so workers in forked processes update the same counters that
+// worker threads would.
+
+#include "LiveStats.h"
+#include "ThreadTutorial.h"
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <signal.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+using namespace std;
+
+// This is the segment we publish to, and its name.
+static liveSegment* live = NULL;
+static char liveName[64];
+
+// These functions store and load a field under the sequence lock. The
+// fields are only ever touched atomically (if relaxed), since the fences
+// around them only order atomic accesses, and a plain store could be moved
+// ahead of the odd sequence number.
+template <typename T> static inline void liveStore(T* field, T value)
+{
+	__atomic_store(field, &value, __ATOMIC_RELAXED);
+}
+
+template <typename T> static inline void liveLoad(const T* field, T* value)
+{
+	__atomic_load(field, value, __ATOMIC_RELAXED);
+}
+
+// This function starts a change to the fields under the sequence lock. The
+// odd number goes out first, and the release fence after it keeps every
+// field store below from being seen before it.
+static void beginUpdate(void)
+{
+	unsigned int sequence = __atomic_load_n(&live->sequence, __ATOMIC_RELAXED);
+
+	__atomic_store_n(&live->sequence, sequence + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+// This function finishes a change to the fields under the sequence lock.
+// The even number is a release store, so it is only seen after the fields.
+static void endUpdate(void)
+{
+	unsigned int sequence = __atomic_load_n(&live->sequence, __ATOMIC_RELAXED);
+
+	liveStore(&live->updateNsecs, timeStamp::monotonicNsecs());
+	__atomic_store_n(&live->sequence, sequence + 1, __ATOMIC_RELEASE);
+}
+
+// This function creates the segment and starts publishing to it.
+bool liveStatsEnable(const char* mode)
+{
+	snprintf(liveName, sizeof(liveName), "/%s%d", LIVE_NAME_PREFIX, (int)getpid());
+
+	int fd = shm_open(liveName, O_CREAT | O_TRUNC | O_RDWR, 0644);
+	if(fd < 0)
+	{
+		return false;
+	}
+
+	if(ftruncate(fd, sizeof(liveSegment)) != 0)
+	{
+		close(fd);
+		shm_unlink(liveName);
+		return false;
+	}
+
+	void* memory = mmap(NULL, sizeof(liveSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if(memory == MAP_FAILED)
+	{
+		shm_unlink(liveName);
+		return false;
+	}
+
+	live = (liveSegment*)memory;
+	memset(live, 0, sizeof(liveSegment));
+
+	live->version = LIVE_VERSION;
+	live->pid = getpid();
+	strncpy(live->mode, mode, LIVE_MODE_LENGTH - 1);
+	live->startNsecs = timeStamp::monotonicNsecs();
+	live->updateNsecs = live->startNsecs;
+
+	// The magic number goes in last, so a reader never sees a half
+	// made segment as a good one.
+	__atomic_store_n(&live->magic, LIVE_MAGIC, __ATOMIC_RELEASE);
+
+	return true;
+}
+
+// This function returns true if live stats are being published.
+bool liveStatsEnabled(void)
+{
+	return (live != NULL);
+}
+
+// This function marks the test as finished and removes the segment.
+void liveStatsFinish(void)
+{
+	if(live)
+	{
+		beginUpdate();
+		liveStore(&live->finished, 1);
+		liveStore(&live->progress, 1.0);
+		endUpdate();
+
+		munmap(live, sizeof(liveSegment));
+		shm_unlink(liveName);
+		live = NULL;
+	}
+}
+
+// This function marks the start of a cell.
+void liveCellBegin(unsigned int calcs, unsigned int threadNo)
+{
+	if(live)
+	{
+		beginUpdate();
+		liveStore(&live->cellN, calcs);
+		liveStore(&live->cellThreads, threadNo);
+		liveStore(&live->cellStartNsecs, timeStamp::monotonicNsecs());
+		endUpdate();
+
+		// The workers haven't started yet, so these are all ours.
+		for(unsigned int i = 0; i < LIVE_MAX_THREADS; i++)
+		{
+			__atomic_store_n(&live->threads[i].ops, 0, __ATOMIC_RELAXED);
+		}
+		__atomic_store_n(&live->nextThread, 0, __ATOMIC_RELEASE);
+	}
+}
+
+// This function marks the end of a cell.
+void liveCellEnd(unsigned int calcs, unsigned int usecs)
+{
+	if(live)
+	{
+		beginUpdate();
+		liveStore(&live->cellsDone, live->cellsDone + 1);
+		liveStore(&live->lastOpsPerSec, usecs ? (1000000.0*calcs/usecs) : 0.0);
+		endUpdate();
+	}
+}
+
+// This function sets how much of the whole test is done.
+void liveProgress(double fraction)
+{
+	if(live)
+	{
+		beginUpdate();
+		liveStore(&live->progress, fraction);
+		endUpdate();
+	}
+}
+
+// This function hands the calling worker its progress counter.
+volatile unsigned long long* liveThreadCounter(void)
+{
+	if(!live)
+	{
+		return NULL;
+	}
+
+	unsigned int slot = __atomic_fetch_add(&live->nextThread, 1, __ATOMIC_RELAXED);
+
+	return ((slot < LIVE_MAX_THREADS) ? &live->threads[slot].ops : NULL);
+}
+
+// This function copies the fields under the sequence lock out of a
+// segment, trying again until it gets a copy that wasn't being changed. The
+// acquire load of the sequence number keeps the field loads from being done
+// before it, and the acquire fence keeps them from being done after the
+// second look at it. A writer that died in the middle of a change leaves
+// the sequence number odd for good, so if the writer is gone, or it takes
+// more than LIVE_READ_TRIES tries, the plain copy is used as it is.
+static void readSegment(const liveSegment* segment, liveSegment* copy)
+{
+	// Everything else is either set before the segment is published or
+	// is a worker counter that is read on its own.
+	memcpy(copy, (const void*)segment, sizeof(liveSegment));
+
+	for(unsigned int tries = 0; tries < LIVE_READ_TRIES; tries++)
+	{
+		unsigned int before = __atomic_load_n(&segment->sequence, __ATOMIC_ACQUIRE);
+
+		if((before & 1) == 0)
+		{
+			liveLoad(&segment->cellN, &copy->cellN);
+			liveLoad(&segment->cellThreads, &copy->cellThreads);
+			liveLoad(&segment->cellStartNsecs, &copy->cellStartNsecs);
+			liveLoad(&segment->cellsDone, &copy->cellsDone);
+			liveLoad(&segment->startNsecs, &copy->startNsecs);
+			liveLoad(&segment->updateNsecs, &copy->updateNsecs);
+			liveLoad(&segment->lastOpsPerSec, &copy->lastOpsPerSec);
+			liveLoad(&segment->progress, &copy->progress);
+			liveLoad(&segment->finished, &copy->finished);
+			__atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+			if(__atomic_load_n(&segment->sequence, __ATOMIC_RELAXED) == before)
+			{
+				return;
+			}
+		}
+		else if((kill(copy->pid, 0) != 0) && (errno != EPERM))
+		{
+			return;
+		}
+
+		sched_yield();
+	}
+}
+
+// This function prints one segment.
+static void printSegment(const liveSegment& stats, bool prometheus)
+{
+	double elapsed = (double)(timeStamp::monotonicNsecs() - stats.startNsecs)/1000000000.0;
+	double cellElapsed = (double)(timeStamp::monotonicNsecs() - stats.cellStartNsecs)/1000000000.0;
+	double eta = (stats.progress > 0) ? elapsed*(1.0 - stats.progress)/stats.progress : -1;
+
+	// A test that died without cleaning up leaves its segment behind.
+	bool alive = (kill(stats.pid, 0) == 0) || (errno == EPERM);
+	unsigned int threadCount = (stats.cellThreads < LIVE_MAX_THREADS) ? stats.cellThreads : LIVE_MAX_THREADS;
+
+	if(prometheus)
+	{
+		char labels[96];
+		snprintf(labels, sizeof(labels), "pid=\"%d\",mode=\"%s\"", stats.pid, stats.mode);
+
+		cout << "threadtutorial_up{" << labels << "} " << (alive && !stats.finished) << "\n"
+		     << "threadtutorial_progress{" << labels << "} " << stats.progress << "\n"
+		     << "threadtutorial_elapsed_seconds{" << labels << "} " << elapsed << "\n"
+		     << "threadtutorial_eta_seconds{" << labels << "} " << eta << "\n"
+		     << "threadtutorial_cells_done{" << labels << "} " << stats.cellsDone << "\n"
+		     << "threadtutorial_cell_n{" << labels << "} " << stats.cellN << "\n"
+		     << "threadtutorial_cell_threads{" << labels << "} " << stats.cellThreads << "\n"
+		     << "threadtutorial_last_cell_ops_per_second{" << labels << "} " << stats.lastOpsPerSec << "\n";
+
+		for(unsigned int i = 0; i < threadCount; i++)
+		{
+			cout << "threadtutorial_thread_ops{" << labels << ",thread=\"" << (i + 1) << "\"} "
+			     << stats.threads[i].ops << "\n";
+		}
+
+		return;
+	}
+
+	cout << "Process " << stats.pid << " (" << stats.mode << ")";
+	if(!alive)
+	{
+		cout << " is gone, this is what it left behind";
+	}
+	else if(stats.finished)
+	{
+		cout << " is finished";
+	}
+	cout << "\n";
+
+	cout << "  Elapsed " << (unsigned long long)elapsed << " sec, "
+	     << (int)(100*stats.progress) << "% done";
+	if(eta >= 0)
+	{
+		cout << ", about " << (unsigned long long)eta << " sec to go";
+	}
+	cout << "\n";
+
+	cout << "  Cell n = " << stats.cellN << " with " << stats.cellThreads << " threads, running for "
+	     << cellElapsed << " sec\n"
+	     << "  " << stats.cellsDone << " cells done, the last one did "
+	     << (unsigned long long)stats.lastOpsPerSec << " ops/sec\n";
+
+	for(unsigned int i = 0; i < threadCount; i++)
+	{
+		cout << "  Thread " << (i + 1) << ": " << stats.threads[i].ops << " ops\n";
+	}
+}
+
+// This function finds the live stats segments and prints them.
+unsigned int liveStatsPrint(int pid, bool prometheus)
+{
+	unsigned int printed = 0;
+	DIR* folder = opendir("/dev/shm");
+
+	if(!folder)
+	{
+		return 0;
+	}
+
+	struct dirent* entry;
+	size_t prefixLength = strlen(LIVE_NAME_PREFIX);
+
+	while((entry = readdir(folder)) != NULL)
+	{
+		if(strncmp(entry->d_name, LIVE_NAME_PREFIX, prefixLength) != 0)
+		{
+			continue;
+		}
+
+		if(pid && (atoi(entry->d_name + prefixLength) != pid))
+		{
+			continue;
+		}
+
+		string name = "/";
+		name += entry->d_name;
+
+		int fd = shm_open(name.c_str(), O_RDONLY, 0);
+		if(fd < 0)
+		{
+			continue;
+		}
+
+		void* memory = mmap(NULL, sizeof(liveSegment), PROT_READ, MAP_SHARED, fd, 0);
+		close(fd);
+
+		if(memory == MAP_FAILED)
+		{
+			continue;
+		}
+
+		const liveSegment* segment = (const liveSegment*)memory;
+
+		if((__atomic_load_n(&segment->magic, __ATOMIC_ACQUIRE) == LIVE_MAGIC) &&
+		   (segment->version == LIVE_VERSION))
+		{
+			liveSegment copy;
+			readSegment(segment, &copy);
+			printSegment(copy, prometheus);
+			printed++;
+		}
+
+		munmap(memory, sizeof(liveSegment));
+	}
+
+	closedir(folder);
+
+	return printed;
+}
@@ -0,0 +1,93 @@
+// Author: Jason Tennyson
+// File: LiveStats.h
+// Date: 10/19/26
+//
+// This file contains the definitions for the live stats segment. A long
+// automatic test only prints a line now and then, so there is no way to see
+// how it is doing from the outside. With live stats on, the test keeps its
+// progress in a shared memory segment named /ThreadTutorial.stats.<pid>,
+// and any other process can map it and read it without slowing the test
+// down, like the -stats mode of this program does.
+//
+// The fields that describe the test as a whole are only written by the main
+// thread, and they are protected by a sequence lock: the sequence number is
+// odd while they are being changed, so a reader that sees an odd number, or
+// sees the number change while it was copying, just tries again. The
+// workers never touch those fields. Each one has its own progress counter
+// on its own cache line, so they never contend with each other either.
+
+#ifndef LiveStats_h_
+#define LiveStats_h_
+
+#define LIVE_MAGIC		(0x5454534CU)			// "LSTT" in memory.
+#define LIVE_VERSION		(1)				// Layout version.
+#define LIVE_MAX_THREADS	(64)				// Most threads with counters.
+#define LIVE_CHUNK		(1024)				// Operations between updates.
+#define LIVE_NAME_PREFIX	("ThreadTutorial.stats.")	// Segment name, minus the pid.
+#define LIVE_MODE_LENGTH	(32)				// Longest test name.
+#define LIVE_READ_TRIES		(1000)				// Most tries at a clean read.
+
+// This structure is one worker's progress counter.
+struct liveThread
+{
+	volatile unsigned long long ops;	// Operations done in this cell.
+	char pad[64 - sizeof(unsigned long long)];
+};
+
+// This structure is laid out in the shared memory segment.
+struct liveSegment
+{
+	unsigned int magic;			// Always LIVE_MAGIC.
+	unsigned int version;			// Always LIVE_VERSION.
+	int pid;				// The process running the test.
+	volatile unsigned int sequence;		// Odd while the fields below change.
+
+	// These are protected by the sequence number.
+	char mode[LIVE_MODE_LENGTH];		// The kind of test.
+	unsigned int cellN;			// n of the current cell.
+	unsigned int cellThreads;		// Threads in the current cell.
+	unsigned long long cellStartNsecs;	// When the current cell started.
+	unsigned long long cellsDone;		// Cells finished.
+	unsigned long long startNsecs;		// When the test started.
+	unsigned long long updateNsecs;		// When these were last changed.
+	double lastOpsPerSec;			// Throughput of the last cell.
+	double progress;			// Fraction of the test done.
+	int finished;				// Set when the test is over.
+
+	// These are written by the workers, one each. The workers take a
+	// counter by adding one to nextThread.
+	char pad[64];
+	volatile unsigned int nextThread;
+	char threadPad[64 - sizeof(unsigned int)];
+	liveThread threads[LIVE_MAX_THREADS];
+};
+
+// This function creates the segment and starts publishing to it.
+bool liveStatsEnable(const char* mode);
+
+// This function marks the test as finished and removes the segment.
+void liveStatsFinish(void);
+
+// This function returns true if live stats are being published.
+bool liveStatsEnabled(void);
+
+// This function marks the start of a cell.
+void liveCellBegin(unsigned int calcs, unsigned int threadNo);
+
+// This function marks the end of a cell that took usecs microseconds.
+void liveCellEnd(unsigned int calcs, unsigned int usecs);
+
+// This function sets how much of the whole test is done, from 0 to 1.
+void liveProgress(double fraction);
+
+// This function hands the calling worker its progress counter for the
+// current cell, or returns NULL if live stats are off or all taken.
+volatile unsigned long long* liveThreadCounter(void);
+
+// This function finds every live stats segment (or only the one for pid,
+// if it isn't 0) and prints it. With prometheus set, it prints them in
+// the Prometheus text format instead, for scraping. Returns the number
+// of segments printed.
+unsigned int liveStatsPrint(int pid, bool prometheus);
+
+#endif
@@ -0,0 +1,390 @@
+// Author: Jason Tennyson
+// File: MemorySweep.cpp
+// Date: 10/19/26
+//
+// This file contains the implementation of the memory test. Every thread
+// allocates and fills its own buffer before the clock starts, so the pages
+// end up near the thread that uses them and none of the setup is timed.
+// Each thread times itself, from when it is let go until it finishes the
+// pass or the chunk it was on when the time ran out.
+//
+// The pointer chase links every cache line of the buffer into one big
+// cycle in a random order, so the prefetchers can't guess the next line and
+// the chase can't get stuck in a small loop that fits in the cache.
+
+#include "MemorySweep.h"
+#include "ThreadTutorial.h"
+#include "Workload.h"
+#include "FastRandom.h"
+#include "TimedRun.h"
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+#include <vector>
+#include <sys/mman.h>
+
+using namespace std;
+
+// This structure is one thread's buffer size and what it measured.
+struct memorySlot
+{
+	unsigned long long size;	// Bytes in the buffer.
+	unsigned int index;		// Index of the thread.
+	unsigned long long bytes;	// Bytes streamed.
+	unsigned long long loads;	// Pointers chased.
+	unsigned long long nsecs;	// Time spent at it.
+	unsigned long long sink;	// Keeps the loads from being thrown out.
+	char pad[CACHE_LINE_SIZE];
+};
+
+// These are the names of the patterns, in the order of accessPattern.
+static const char* patternNames[ACCESS_PATTERNS] = { "stream (GB/s)", "random (ns/load)" };
+
+// These are how the buffers are walked and what pages they are made of.
+static accessPattern memoryPattern;
+static pageType memoryPages;
+static bool hugeTlbFailed = false;
+
+// This function turns a cache size from sysfs, like "48K" or "2M", into
+// bytes.
+static unsigned long long parseCacheSize(const string& text)
+{
+	char* end;
+	unsigned long long size = strtoull(text.c_str(), &end, 10);
+
+	if((*end == 'K') || (*end == 'k'))
+	{
+		size *= 1024ULL;
+	}
+	else if((*end == 'M') || (*end == 'm'))
+	{
+		size *= 1024ULL*1024ULL;
+	}
+
+	return size;
+}
+
+// This function finds the sizes of the L1 data cache and the last level
+// cache of the first CPU. Anything we can't find keeps its default.
+void findCacheSizes(unsigned long long* l1Size, unsigned long long* llcSize)
+{
+	unsigned int llcLevel = 0;
+
+	*l1Size = DEFAULT_L1_SIZE;
+	*llcSize = DEFAULT_LLC_SIZE;
+
+	for(unsigned int i = 0; i < 16; i++)
+	{
+		ostringstream folder;
+		folder << "/sys/devices/system/cpu/cpu0/cache/index" << i;
+
+		ifstream levelFile((folder.str() + "/level").c_str());
+		ifstream typeFile((folder.str() + "/type").c_str());
+		ifstream sizeFile((folder.str() + "/size").c_str());
+		unsigned int level = 0;
+		string type, size;
+
+		if(!(levelFile >> level) || !(typeFile >> type) || !(sizeFile >> size))
+		{
+			continue;
+		}
+
+		// The instruction caches don't matter here.
+		if(type == "Instruction")
+		{
+			continue;
+		}
+
+		if(level == 1)
+		{
+			*l1Size = parseCacheSize(size);
+		}
+		if(level > llcLevel)
+		{
+			llcLevel = level;
+			*llcSize = parseCacheSize(size);
+		}
+	}
+}
+
+// This function maps a buffer backed by the given kind of pages. It
+// returns NULL if it can't. If explicit huge pages aren't available it
+// falls back on transparent ones, and says so once.
+void* mapBuffer(unsigned long long size, pageType pages)
+{
+	void* buffer = MAP_FAILED;
+
+	if((pages == PAGES_HUGETLB) && !__atomic_load_n(&hugeTlbFailed, __ATOMIC_RELAXED))
+	{
+		buffer = mmap(NULL, size, PROT_READ | PROT_WRITE,
+			      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+
+		if(buffer != MAP_FAILED)
+		{
+			return buffer;
+		}
+
+		if(!__atomic_exchange_n(&hugeTlbFailed, true, __ATOMIC_RELAXED))
+		{
+			cout << "WARNING: no huge pages are reserved (see /proc/sys/vm/nr_hugepages), "
+			     << "using transparent huge pages instead.\n";
+		}
+	}
+
+	buffer = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+	if(buffer == MAP_FAILED)
+	{
+		return NULL;
+	}
+
+	madvise(buffer, size, (pages == PAGES_NORMAL) ? MADV_NOHUGEPAGE : MADV_HUGEPAGE);
+
+	return buffer;
+}
+
+// This function links every cache line of a buffer into one cycle in a
+// random order. The first word of each line holds the index of the first
+// word of the next line.
+void buildChase(unsigned long long* words, unsigned long long lines, unsigned int stream)
+{
+	const unsigned long long wordsPerLine = CACHE_LINE_SIZE/sizeof(unsigned long long);
+	vector<unsigned long long> order(lines);
+
+	for(unsigned long long i = 0; i < lines; i++)
+	{
+		order[i] = i;
+	}
+
+	fastRandom random;
+	random.stream(DEFAULT_RANDOM_SEED, stream);
+
+	// Shuffle the lines.
+	for(unsigned long long i = lines - 1; i > 0; i--)
+	{
+		unsigned long long j = random.below(i + 1);
+		unsigned long long temp = order[i];
+		order[i] = order[j];
+		order[j] = temp;
+	}
+
+	for(unsigned long long i = 0; i < lines; i++)
+	{
+		words[order[i]*wordsPerLine] = order[(i + 1)%lines]*wordsPerLine;
+	}
+}
+
+// This is the function that each thread runs during the memory test.
+static void* memoryGenerator(void* slotObject)
+{
+	memorySlot* slot = (memorySlot*)slotObject;
+	unsigned long long count = slot->size/sizeof(unsigned long long);
+	unsigned long long* words = (unsigned long long*)mapBuffer(slot->size, memoryPages);
+
+	if(words == NULL)
+	{
+		cout << "Could not allocate a " << slot->size << " byte buffer!\n";
+		timedRunBegin();
+		return (NULL);
+	}
+
+	// Touch every page here, so that it belongs to this thread.
+	if(memoryPattern == ACCESS_RANDOM)
+	{
+		buildChase(words, slot->size/CACHE_LINE_SIZE, slot->index);
+	}
+	else
+	{
+		for(unsigned long long i = 0; i < count; i++)
+		{
+			words[i] = i;
+		}
+	}
+
+	// The clock starts once every buffer is ready.
+	timedRunBegin();
+	unsigned long long start = timeStamp::monotonicNsecs();
+	unsigned long long sink = 0;
+
+	if(memoryPattern == ACCESS_RANDOM)
+	{
+		unsigned long long next = 0;
+
+		while(!timedRunOver())
+		{
+			for(unsigned int i = 0; i < CHASE_CHUNK; i++)
+			{
+				next = words[next];
+			}
+
+			slot->loads += CHASE_CHUNK;
+		}
+
+		sink = next;
+	}
+	else
+	{
+		while(!timedRunOver())
+		{
+			// Four sums, so that the adds don't hold up the loads.
+			unsigned long long sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+
+			for(unsigned long long i = 0; i < count; i += 4)
+			{
+				sum0 += words[i];
+				sum1 += words[i + 1];
+				sum2 += words[i + 2];
+				sum3 += words[i + 3];
+			}
+
+			sink += sum0 + sum1 + sum2 + sum3;
+			slot->bytes += slot->size;
+		}
+	}
+
+	slot->nsecs = timeStamp::monotonicNsecs() - start;
+	slot->sink = sink;
+	munmap(words, slot->size);
+
+	return (NULL);
+}
+
+// This function runs the memory test.
+void runMemorySweep(const char* filename, const accessPattern* patterns, unsigned int patternCount,
+		    unsigned int maxThreads, unsigned int llcMultiple, pageType pages,
+		    unsigned int cellMsecs)
+{
+	unsigned long long l1Size, llcSize;
+	findCacheSizes(&l1Size, &llcSize);
+
+	cout << "L1 data cache: " << l1Size/1024 << " KB, last level cache: " << llcSize/1024 << " KB\n";
+
+	// The buffer sizes go from half the L1 cache up to llcMultiple times
+	// the LLC. Huge pages need whole huge pages.
+	vector<unsigned long long> sizes;
+	unsigned long long biggest = llcSize*llcMultiple;
+	double step = pow(2.0, 1.0/SIZES_PER_DOUBLING);
+
+	for(double size = (l1Size/2 > MIN_BUFFER_SIZE) ? l1Size/2 : MIN_BUFFER_SIZE; size <= biggest*1.001; size *= step)
+	{
+		unsigned long long rounded = ((unsigned long long)size/CACHE_LINE_SIZE)*CACHE_LINE_SIZE;
+
+		if(pages == PAGES_HUGETLB)
+		{
+			rounded = ((rounded + HUGE_PAGE_SIZE - 1)/HUGE_PAGE_SIZE)*HUGE_PAGE_SIZE;
+		}
+
+		if(sizes.empty() || (rounded != sizes.back()))
+		{
+			sizes.push_back(rounded);
+		}
+	}
+
+	// The thread counts are the powers of two up to maxThreads, and
+	// maxThreads itself.
+	vector<unsigned int> threadCounts;
+	for(unsigned int t = 1; t < maxThreads; t *= 2)
+	{
+		threadCounts.push_back(t);
+	}
+	threadCounts.push_back(maxThreads);
+
+	// Create a temp filename to append the spreadsheet folder location
+	// in front of the desired filename.
+	string tempFilename = SPREADSHEET_FOLDER;
+	tempFilename += "/";
+	tempFilename += filename;
+
+	ofstream dataDump(tempFilename.c_str());
+
+	// Write the top line of the data file.
+	const char* pageNames[PAGE_TYPES] = { "normal", "thp", "hugetlb" };
+	dataDump << "Pattern,Pages,Size (KB)";
+	for(unsigned int t = 0; t < threadCounts.size(); t++)
+	{
+		dataDump << "," << threadCounts[t] << " Threads";
+	}
+	dataDump << "\n";
+
+	memoryPages = pages;
+	hugeTlbFailed = false;
+
+	for(unsigned int p = 0; p < patternCount; p++)
+	{
+		memoryPattern = patterns[p];
+
+		for(unsigned int s = 0; s < sizes.size(); s++)
+		{
+			ostringstream row;
+
+			for(unsigned int t = 0; t < threadCounts.size(); t++)
+			{
+				unsigned int threadNo = threadCounts[t];
+				memorySlot* slots = allocateThreadSlots<memorySlot>(threadNo);
+				double elapsedSecs;
+
+				for(unsigned int i = 0; slots && (i < threadNo); i++)
+				{
+					slots[i].size = sizes[s];
+					slots[i].index = i;
+				}
+
+				// Every thread times itself, so the time on the wall
+				// isn't used.
+				if(!slots || !runTimedThreads(memoryGenerator, slots, sizeof(memorySlot), threadNo,
+							      cellMsecs, &elapsedSecs, NULL, NULL, 0))
+				{
+					cout << "WARNING: Could not run " << threadNo << " threads, so the cell is marked as failed.\n";
+					row << ",failed";
+					freeThreadSlots(slots);
+					continue;
+				}
+
+				// Streaming adds up every thread's bandwidth. Pointer
+				// chasing averages every thread's latency.
+				double value = 0;
+				unsigned int counted = 0;
+
+				for(unsigned int i = 0; i < threadNo; i++)
+				{
+					if(slots[i].nsecs == 0)
+					{
+						continue;
+					}
+
+					if(memoryPattern == ACCESS_RANDOM)
+					{
+						value += (slots[i].loads ? (double)slots[i].nsecs/slots[i].loads : 0);
+					}
+					else
+					{
+						value += (double)slots[i].bytes/slots[i].nsecs;
+					}
+					counted++;
+				}
+
+				if((memoryPattern == ACCESS_RANDOM) && counted)
+				{
+					value /= counted;
+				}
+
+				row << "," << value;
+				freeThreadSlots(slots);
+			}
+
+			// If there were no huge pages to be had, say what we
+			// really used.
+			pageType used = ((pages == PAGES_HUGETLB) && hugeTlbFailed) ? PAGES_THP : pages;
+
+			dataDump << patternNames[memoryPattern] << "," << pageNames[used] << ","
+				 << (double)sizes[s]/1024.0 << row.str() << "\n";
+			dataDump.flush();
+
+			cout << patternNames[memoryPattern] << ": " << sizes[s]/1024 << " KB done.\n";
+		}
+	}
+
+	// Append an extra new line character to the end of the file.
+	dataDump << "\n";
+	dataDump.close();
+}
@@ -0,0 +1,69 @@
+// Author: Jason Tennyson
+// File: MemorySweep.h
+// Date: 10/19/26
+//
+// This file contains the function prototypes for the memory test. Everything
+// else the threads do fits in a register, so the caches never come into it.
+// In the memory test every thread gets a private buffer and either streams
+// through it (which measures bandwidth) or chases pointers around it in a
+// random order (which measures latency, since every load has to wait for the
+// one before it). The buffer size is swept from smaller than the L1 cache to
+// several times the last level cache, and every size is run with more and
+// more threads. Where the numbers fall off shows which cache a buffer stopped
+// fitting in, and where adding threads stops helping shows when they started
+// fighting over a shared cache or over DRAM.
+
+#ifndef MemorySweep_h_
+#define MemorySweep_h_
+
+#define DEFAULT_L1_SIZE		(32768)				// L1 size if we can't find it.
+#define DEFAULT_LLC_SIZE	(8388608)			// LLC size if we can't find it.
+#define MIN_BUFFER_SIZE		(4096)				// Smallest buffer we test.
+#define DEFAULT_LLC_MULTIPLE	(4)				// Biggest buffer, in LLCs.
+#define MAX_LLC_MULTIPLE	(64)				// Most LLCs we go up to.
+#define SIZES_PER_DOUBLING	(2)				// Buffer sizes per doubling.
+#define DEFAULT_MEMORY_MSECS	(200)				// Default time per cell (ms).
+#define MAX_MEMORY_MSECS	(60000)				// Maximum time per cell (ms).
+#define CHASE_CHUNK		(1024)				// Loads between flag checks.
+#define HUGE_PAGE_SIZE		(2097152)			// Size of a huge page.
+
+// These are the ways that a buffer can be walked.
+enum accessPattern
+{
+	ACCESS_STREAM = 0,	// Read every word in order.
+	ACCESS_RANDOM,		// Chase pointers from cache line to cache line.
+	ACCESS_PATTERNS		// The number of patterns.
+};
+
+// These are the kinds of pages a buffer can be backed by.
+enum pageType
+{
+	PAGES_NORMAL = 0,	// Regular pages, with huge pages turned off.
+	PAGES_THP,		// Transparent huge pages, asked for with madvise.
+	PAGES_HUGETLB,		// Explicit huge pages from MAP_HUGETLB.
+	PAGE_TYPES		// The number of page types.
+};
+
+// This function finds the sizes of the L1 data cache and the last level
+// cache in bytes. Anything it can't find is given a default size.
+void findCacheSizes(unsigned long long* l1Size, unsigned long long* llcSize);
+
+// This function maps a buffer of size bytes backed by the given kind of
+// pages, or returns NULL if it can't. Free it with munmap.
+void* mapBuffer(unsigned long long size, pageType pages);
+
+// This function links every cache line of a buffer into one cycle in a
+// random order, for pointer chasing. The chase starts at word 0, and the
+// order comes from the given stream of random numbers.
+void buildChase(unsigned long long* words, unsigned long long lines, unsigned int stream);
+
+// This function runs the memory test for the given patterns, with every
+// power of two number of threads up to maxThreads, and saves a matrix of
+// buffer size by thread count for each pattern to filename in the
+// spreadsheet folder. Streaming is reported in GB/s for all of the threads
+// together, and pointer chasing in nanoseconds per load.
+void runMemorySweep(const char* filename, const accessPattern* patterns, unsigned int patternCount,
+		    unsigned int maxThreads, unsigned int llcMultiple, pageType pages,
+		    unsigned int cellMsecs);
+
+#endif
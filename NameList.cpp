@@ -0,0 +1,57 @@
+// Author: Jason Tennyson
+// File: NameList.cpp
+// Date: 10/19/26
+//
+// This file contains the implementation of the name list reader.
+
+#include "NameList.h"
+#include <strings.h>
+
+// This function reads a comma separated list of names.
+unsigned int readNameList(const char* names, const char* const* known, unsigned int knownCount,
+			  unsigned int* indexes)
+{
+	unsigned int count = 0;
+	char name[MAX_LIST_NAME];
+
+	while(*names != '\0')
+	{
+		// Copy out the next name.
+		unsigned int length = 0;
+		while((*names != '\0') && (*names != ','))
+		{
+			if(length < (sizeof(name) - 1))
+			{
+				name[length++] = *names;
+			}
+			names++;
+		}
+		name[length] = '\0';
+
+		// Skip the comma.
+		if(*names == ',')
+		{
+			names++;
+		}
+
+		for(unsigned int i = 0; i < knownCount; i++)
+		{
+			if(strcasecmp(name, known[i]) == 0)
+			{
+				bool repeat = false;
+
+				for(unsigned int j = 0; j < count; j++)
+				{
+					repeat = repeat || (indexes[j] == i);
+				}
+
+				if(!repeat && (count < knownCount))
+				{
+					indexes[count++] = i;
+				}
+			}
+		}
+	}
+
+	return count;
+}
@@ -0,0 +1,38 @@
+// Author: Jason Tennyson
+// File: NameList.h
+// Date: 10/19/26
+//
+// This file contains the function prototypes for reading lists of names.
+// Most of the tests let the user pick what to compare with a flag like
+// -sync=mutex,tas, and they all read the list the same way.
+
+#ifndef NameList_h_
+#define NameList_h_
+
+#define MAX_LIST_NAME		(32)				// Longest name in a list.
+
+// This function reads a comma separated list of names, like "mutex,tas",
+// and stores the index in known of every name it finds into indexes, which
+// must have room for knownCount entries. The names are compared without
+// caring about upper or lower case. Names we don't know and repeats are
+// skipped. Returns the count.
+unsigned int readNameList(const char* names, const char* const* known, unsigned int knownCount,
+			  unsigned int* indexes);
+
+// This function is readNameList for a list of enum values, when known is in
+// the same order as the enum.
+template <typename T> unsigned int readNameList(const char* names, const char* const* known,
+						unsigned int knownCount, T* types)
+{
+	unsigned int indexes[knownCount];
+	unsigned int count = readNameList(names, known, knownCount, indexes);
+
+	for(unsigned int i = 0; i < count; i++)
+	{
+		types[i] = (T)indexes[i];
+	}
+
+	return count;
+}
+
+#endif
@@ -0,0 +1,617 @@
+// Author: Jason Tennyson
+// File: Numa.cpp
+// Date: 10/19/26
+//
+// This file contains the implementation of the NUMA test. Inside this file
+// the nodes are numbered by their position in /sys/devices/system/node/online
+// (node numbers can have holes in them), and the real node number is what
+// goes in the spreadsheet.
+//
+// The bind policy uses set_mempolicy on the worker thread, so that every
+// page the thread touches from then on comes from its own node. The remote
+// and interleave policies use mbind on the buffer itself. The first touch
+// policy does nothing, which is what the rest of the program does too.
+
+#include "Numa.h"
+#include "MemorySweep.h"
+#include "ThreadTutorial.h"
+#include "Workload.h"
+#include <cstring>
+#include <sstream>
+#include <vector>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+using namespace std;
+
+// These come from the kernel's mempolicy.h. libnuma's numaif.h has them
+// too, but we don't want to need it.
+#define MPOL_DEFAULT_MODE	(0)				// Use the default policy.
+#define MPOL_BIND_MODE		(2)				// Only use the given nodes.
+#define MPOL_INTERLEAVE_MODE	(3)				// Spread across the given nodes.
+#define MPOL_FLAG_NODE		(1)				// get_mempolicy: return a node.
+#define MPOL_FLAG_ADDR		(2)				// get_mempolicy: for this address.
+#define MPOL_MOVE_FLAG		(2)				// mbind: move pages already there.
+#define NODE_MASK_WORDS		(MAX_NUMA_NODES/(8*sizeof(unsigned long)))
+
+// These are the names of the policies, in the order of numaPolicy.
+static const char* policyNames[NUMA_POLICIES] = { "first-touch", "interleave", "bind", "remote" };
+
+// This is the topology, read the first time it is needed.
+static bool topologyRead = false;
+static vector<unsigned int> nodeIds;
+static vector<cpu_set_t> nodeCpus;
+
+// This function returns the name of a policy.
+const char* numaPolicyName(numaPolicy policy)
+{
+	return ((policy < NUMA_POLICIES) ? policyNames[policy] : "unknown");
+}
+
+// This function reads a list like "0-3,8,10-11" from sysfs into numbers.
+static vector<unsigned int> readList(const string& path)
+{
+	vector<unsigned int> numbers;
+	ifstream listFile(path.c_str());
+	string text;
+
+	if(!(listFile >> text))
+	{
+		return numbers;
+	}
+
+	const char* next = text.c_str();
+
+	while(*next != '\0')
+	{
+		char* end;
+		unsigned int first = strtoul(next, &end, 10);
+		unsigned int last = first;
+
+		if(end == next)
+		{
+			break;
+		}
+
+		if(*end == '-')
+		{
+			next = end + 1;
+			last = strtoul(next, &end, 10);
+		}
+
+		for(unsigned int i = first; i <= last; i++)
+		{
+			numbers.push_back(i);
+		}
+
+		next = (*end == ',') ? (end + 1) : end;
+	}
+
+	return numbers;
+}
+
+// This function reads the topology, if it hasn't been read yet. If it
+// can't be read, we pretend there is one node with every CPU on it.
+static void readTopology(void)
+{
+	if(topologyRead)
+	{
+		return;
+	}
+	topologyRead = true;
+
+	cpu_set_t allowed;
+	if(sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+	{
+		CPU_ZERO(&allowed);
+	}
+
+	vector<unsigned int> online = readList("/sys/devices/system/node/online");
+
+	for(unsigned int i = 0; (i < online.size()) && (nodeIds.size() < MAX_NUMA_NODES); i++)
+	{
+		ostringstream path;
+		path << "/sys/devices/system/node/node" << online[i] << "/cpulist";
+
+		vector<unsigned int> cpus = readList(path.str());
+		cpu_set_t cpuSet;
+		CPU_ZERO(&cpuSet);
+
+		for(unsigned int c = 0; c < cpus.size(); c++)
+		{
+			if((cpus[c] < CPU_SETSIZE) && CPU_ISSET(cpus[c], &allowed))
+			{
+				CPU_SET(cpus[c], &cpuSet);
+			}
+		}
+
+		nodeIds.push_back(online[i]);
+		nodeCpus.push_back(cpuSet);
+	}
+
+	if(nodeIds.empty())
+	{
+		nodeIds.push_back(0);
+		nodeCpus.push_back(allowed);
+	}
+}
+
+// This function returns the number of memory nodes.
+unsigned int numaNodeCount(void)
+{
+	readTopology();
+	return nodeIds.size();
+}
+
+// This function fills cpus with the CPUs of the given node.
+unsigned int numaNodeCpus(unsigned int node, cpu_set_t* cpus)
+{
+	readTopology();
+	CPU_ZERO(cpus);
+
+	if(node >= nodeIds.size())
+	{
+		return 0;
+	}
+
+	*cpus = nodeCpus[node];
+	return CPU_COUNT(cpus);
+}
+
+// This function fills a node mask with the given node, or with every node
+// if node is MAX_NUMA_NODES.
+static void fillNodeMask(unsigned long* mask, unsigned int node)
+{
+	const unsigned int bits = 8*sizeof(unsigned long);
+
+	memset(mask, 0, NODE_MASK_WORDS*sizeof(unsigned long));
+
+	for(unsigned int i = 0; i < nodeIds.size(); i++)
+	{
+		if((node == MAX_NUMA_NODES) || (node == i))
+		{
+			mask[nodeIds[i]/bits] |= 1UL << (nodeIds[i]%bits);
+		}
+	}
+}
+
+// This function places a range of memory on a node, or across all of them.
+bool numaPlace(void* address, unsigned long long length, unsigned int node)
+{
+	if(numaNodeCount() < 2)
+	{
+		return true;
+	}
+
+	unsigned long mask[NODE_MASK_WORDS];
+	fillNodeMask(mask, node);
+
+	int mode = (node == MAX_NUMA_NODES) ? MPOL_INTERLEAVE_MODE : MPOL_BIND_MODE;
+
+	// The kernel reads one bit less than maxnode says, so it gets one
+	// more than the bits in the mask.
+	return (syscall(SYS_mbind, address, length, mode, mask, MAX_NUMA_NODES + 1, MPOL_MOVE_FLAG) == 0);
+}
+
+// This function makes every page the calling thread touches from now on
+// come from the given node. MAX_NUMA_NODES puts the default policy back.
+static bool bindThread(unsigned int node)
+{
+	if(numaNodeCount() < 2)
+	{
+		return true;
+	}
+
+	if(node == MAX_NUMA_NODES)
+	{
+		return (syscall(SYS_set_mempolicy, MPOL_DEFAULT_MODE, NULL, 0) == 0);
+	}
+
+	unsigned long mask[NODE_MASK_WORDS];
+	fillNodeMask(mask, node);
+
+	return (syscall(SYS_set_mempolicy, MPOL_BIND_MODE, mask, MAX_NUMA_NODES + 1) == 0);
+}
+
+// This function returns the node that the page holding address is on.
+int numaNodeOf(void* address)
+{
+	int id = -1;
+
+	if(numaNodeCount() < 2)
+	{
+		return 0;
+	}
+
+	if(syscall(SYS_get_mempolicy, &id, NULL, 0, address, MPOL_FLAG_NODE | MPOL_FLAG_ADDR) != 0)
+	{
+		return -1;
+	}
+
+	for(unsigned int i = 0; i < nodeIds.size(); i++)
+	{
+		if(nodeIds[i] == (unsigned int)id)
+		{
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+// This structure is what each worker is given and what it hands back.
+struct numaSlot
+{
+	unsigned int index;		// Index of the worker.
+	unsigned int cpuNode;		// Node the worker runs on.
+	numaPolicy policy;		// How the worker's buffer is placed.
+	int memoryNode;			// Node the buffer ended up on.
+	unsigned long long bytes;	// Bytes streamed.
+	unsigned long long loads;	// Pointers chased.
+	unsigned long long chaseNsecs;	// Time spent chasing pointers.
+	unsigned long long streamNsecs;	// Time spent streaming.
+	unsigned long long increments;	// Shared counter increments.
+	unsigned long long sink;	// Keeps the loads from being thrown out.
+};
+
+// These values have to be stored globally to be accessed by the workers.
+static unsigned long long numaBufferBytes;
+static unsigned long long numaPhaseNsecs;
+static volatile unsigned long long* numaSharedCounter;
+static pthread_barrier_t numaBarrier;
+static bool numaUseBarrier;
+
+// This function pins the calling thread to the CPUs of a node.
+static void pinToNode(unsigned int node)
+{
+	cpu_set_t cpus;
+
+	if(numaNodeCpus(node, &cpus) > 0)
+	{
+		pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+	}
+}
+
+// This function chases pointers around a buffer for the length of a phase.
+static void chaseFor(numaSlot* slot, unsigned long long* words)
+{
+	unsigned long long start = timeStamp::monotonicNsecs();
+	unsigned long long now = start;
+	unsigned long long next = 0;
+
+	while((now - start) < numaPhaseNsecs)
+	{
+		for(unsigned int i = 0; i < CHASE_CHUNK; i++)
+		{
+			next = words[next];
+		}
+
+		slot->loads += CHASE_CHUNK;
+		now = timeStamp::monotonicNsecs();
+	}
+
+	slot->chaseNsecs = now - start;
+	slot->sink += next;
+}
+
+// This function streams through a buffer for the length of a phase.
+static void streamFor(numaSlot* slot, unsigned long long* words)
+{
+	unsigned long long count = numaBufferBytes/sizeof(unsigned long long);
+	unsigned long long start = timeStamp::monotonicNsecs();
+	unsigned long long now = start;
+
+	while((now - start) < numaPhaseNsecs)
+	{
+		// Four sums, so that the adds don't hold up the loads.
+		unsigned long long sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+
+		for(unsigned long long i = 0; i < count; i += 4)
+		{
+			sum0 += words[i];
+			sum1 += words[i + 1];
+			sum2 += words[i + 2];
+			sum3 += words[i + 3];
+		}
+
+		slot->sink += sum0 + sum1 + sum2 + sum3;
+		slot->bytes += numaBufferBytes;
+		now = timeStamp::monotonicNsecs();
+	}
+
+	slot->streamNsecs = now - start;
+}
+
+// This is the function that each worker runs. It places its buffer the
+// way its policy says to, measures it, and then (when there are other
+// workers) hammers the shared counter along with them.
+static void* numaGenerator(void* slotObject)
+{
+	numaSlot* slot = (numaSlot*)slotObject;
+	unsigned int nodes = numaNodeCount();
+
+	pinToNode(slot->cpuNode);
+
+	// The bind policy is set on the thread before the buffer exists.
+	if(slot->policy == NUMA_BIND)
+	{
+		bindThread(slot->cpuNode);
+	}
+
+	unsigned long long* words = (unsigned long long*)mapBuffer(numaBufferBytes, PAGES_NORMAL);
+
+	if(words != NULL)
+	{
+		if(slot->policy == NUMA_INTERLEAVE)
+		{
+			numaPlace(words, numaBufferBytes, MAX_NUMA_NODES);
+		}
+		else if(slot->policy == NUMA_REMOTE)
+		{
+			numaPlace(words, numaBufferBytes, (slot->memoryNode >= 0) ? slot->memoryNode : (slot->cpuNode + 1)%nodes);
+		}
+
+		// This touches every page, so this is where they get placed.
+		buildChase(words, numaBufferBytes/CACHE_LINE_SIZE, slot->index);
+		slot->memoryNode = (slot->policy == NUMA_INTERLEAVE) ? -1 : numaNodeOf(words);
+	}
+	else
+	{
+		cout << "Could not allocate a " << numaBufferBytes << " byte buffer!\n";
+	}
+
+	if(slot->policy == NUMA_BIND)
+	{
+		bindThread(MAX_NUMA_NODES);
+	}
+
+	// The first worker touches the shared counter first.
+	if(numaUseBarrier && (slot->index == 0) && (slot->policy == NUMA_FIRST_TOUCH))
+	{
+		*numaSharedCounter = 0;
+	}
+
+	// Nobody starts until every buffer has been placed, so that the
+	// placement isn't timed.
+	if(numaUseBarrier)
+	{
+		pthread_barrier_wait(&numaBarrier);
+	}
+
+	if(words != NULL)
+	{
+		chaseFor(slot, words);
+		streamFor(slot, words);
+		munmap(words, numaBufferBytes);
+	}
+
+	if(numaUseBarrier)
+	{
+		pthread_barrier_wait(&numaBarrier);
+
+		unsigned long long start = timeStamp::monotonicNsecs();
+
+		while((timeStamp::monotonicNsecs() - start) < numaPhaseNsecs)
+		{
+			for(unsigned int i = 0; i < 256; i++)
+			{
+				__atomic_fetch_add(numaSharedCounter, 1, __ATOMIC_RELAXED);
+			}
+
+			slot->increments += 256;
+		}
+	}
+
+	return (NULL);
+}
+
+// This function runs the NUMA test.
+void runNumaTest(const char* filename, unsigned int threadNo, unsigned long long bufferBytes,
+		 unsigned int msecs)
+{
+	unsigned int nodes = numaNodeCount();
+
+	cout << "Found " << nodes << " NUMA node" << ((nodes == 1) ? "" : "s") << ".\n";
+	if(nodes < 2)
+	{
+		cout << "This machine is UMA, so every policy does the same thing.\n";
+	}
+
+	// Whole cache lines, four words at a time.
+	numaBufferBytes = (bufferBytes/CACHE_LINE_SIZE)*CACHE_LINE_SIZE;
+	numaPhaseNsecs = (unsigned long long)msecs*1000000ULL/2;
+
+	// Create a temp filename to append the spreadsheet folder location
+	// in front of the desired filename.
+	string tempFilename = SPREADSHEET_FOLDER;
+	tempFilename += "/";
+	tempFilename += filename;
+
+	ofstream dataDump(tempFilename.c_str());
+
+	// First, one thread on every node against memory on every node.
+	dataDump << "CPU Node,Memory Node,Latency (ns),Bandwidth (GB/s)\n";
+
+	numaUseBarrier = false;
+
+	for(unsigned int cpuNode = 0; cpuNode < nodes; cpuNode++)
+	{
+		cpu_set_t cpus;
+
+		// Memory only nodes have nobody to run the test on them.
+		if(numaNodeCpus(cpuNode, &cpus) == 0)
+		{
+			continue;
+		}
+
+		for(unsigned int memoryNode = 0; memoryNode < nodes; memoryNode++)
+		{
+			numaSlot slot;
+			memset(&slot, 0, sizeof(slot));
+			slot.cpuNode = cpuNode;
+			slot.policy = (memoryNode == cpuNode) ? NUMA_BIND : NUMA_REMOTE;
+			slot.memoryNode = memoryNode;
+
+			pthread_t thread;
+			pthread_create(&thread, NULL, numaGenerator, &slot);
+			pthread_join(thread, NULL);
+
+			dataDump << nodeIds[cpuNode] << "," << nodeIds[memoryNode] << ","
+				 << (slot.loads ? (double)slot.chaseNsecs/slot.loads : 0) << ","
+				 << (slot.streamNsecs ? (double)slot.bytes/slot.streamNsecs : 0) << "\n";
+			dataDump.flush();
+
+			cout << "CPU node " << nodeIds[cpuNode] << ", memory node " << nodeIds[memoryNode]
+			     << ": " << (slot.loads ? (double)slot.chaseNsecs/slot.loads : 0) << " ns per load\n";
+		}
+	}
+
+	// Then every policy with all of the threads. The workers are dealt
+	// out to the nodes that have CPUs like cards.
+	vector<unsigned int> cpuNodes;
+	for(unsigned int node = 0; node < nodes; node++)
+	{
+		cpu_set_t cpus;
+		if(numaNodeCpus(node, &cpus) > 0)
+		{
+			cpuNodes.push_back(node);
+		}
+	}
+	if(cpuNodes.empty())
+	{
+		cpuNodes.push_back(0);
+	}
+
+	dataDump << "\nPolicy,CPU Node,Memory Node,Threads,Latency (ns),Bandwidth (GB/s)\n";
+
+	ostringstream sharedRows;
+	sharedRows << "\nPolicy,Threads,Counter Node,Increments/Sec\n";
+
+	numaUseBarrier = true;
+
+	for(unsigned int p = 0; p < NUMA_POLICIES; p++)
+	{
+		numaPolicy policy = (numaPolicy)p;
+		numaSlot* slots = new numaSlot[threadNo];
+		pthread_t threads[threadNo];
+
+		memset(slots, 0, threadNo*sizeof(numaSlot));
+
+		// The shared counter gets a page of its own, placed relative
+		// to the first worker.
+		void* sharedPage = mapBuffer(sysconf(_SC_PAGESIZE), PAGES_NORMAL);
+		if(sharedPage == NULL)
+		{
+			cout << "Could not allocate the shared counter!\n";
+			delete [] slots;
+			break;
+		}
+		numaSharedCounter = (volatile unsigned long long*)sharedPage;
+
+		if(policy == NUMA_INTERLEAVE)
+		{
+			numaPlace(sharedPage, sysconf(_SC_PAGESIZE), MAX_NUMA_NODES);
+		}
+		else if(policy == NUMA_BIND)
+		{
+			numaPlace(sharedPage, sysconf(_SC_PAGESIZE), cpuNodes[0]);
+		}
+		else if(policy == NUMA_REMOTE)
+		{
+			numaPlace(sharedPage, sysconf(_SC_PAGESIZE), (cpuNodes[0] + 1)%nodes);
+		}
+
+		// Everything but first touch is placed by now, so touch it.
+		if(policy != NUMA_FIRST_TOUCH)
+		{
+			*numaSharedCounter = 0;
+		}
+
+		pthread_barrier_init(&numaBarrier, NULL, threadNo);
+
+		for(unsigned int i = 0; i < threadNo; i++)
+		{
+			slots[i].index = i;
+			slots[i].cpuNode = cpuNodes[i%cpuNodes.size()];
+			slots[i].policy = policy;
+			slots[i].memoryNode = -1;
+			pthread_create(&threads[i], NULL, numaGenerator, &slots[i]);
+		}
+
+		for(unsigned int i = 0; i < threadNo; i++)
+		{
+			pthread_join(threads[i], NULL);
+		}
+
+		pthread_barrier_destroy(&numaBarrier);
+
+		// Add the workers up by where they ran and where their memory
+		// was. Interleaved memory is on every node at once.
+		for(unsigned int cpuNode = 0; cpuNode < nodes; cpuNode++)
+		{
+			for(int memoryNode = -1; memoryNode < (int)nodes; memoryNode++)
+			{
+				unsigned int count = 0;
+				double latency = 0, bandwidth = 0;
+
+				for(unsigned int i = 0; i < threadNo; i++)
+				{
+					if((slots[i].cpuNode == cpuNode) && (slots[i].memoryNode == memoryNode))
+					{
+						count++;
+						latency += (slots[i].loads ? (double)slots[i].chaseNsecs/slots[i].loads : 0);
+						bandwidth += (slots[i].streamNsecs ? (double)slots[i].bytes/slots[i].streamNsecs : 0);
+					}
+				}
+
+				if(count == 0)
+				{
+					continue;
+				}
+
+				dataDump << numaPolicyName(policy) << "," << nodeIds[cpuNode] << ",";
+				if(memoryNode < 0)
+				{
+					dataDump << ((policy == NUMA_INTERLEAVE) ? "all" : "unknown");
+				}
+				else
+				{
+					dataDump << nodeIds[memoryNode];
+				}
+				dataDump << "," << count << "," << latency/count << "," << bandwidth << "\n";
+			}
+		}
+		dataDump.flush();
+
+		// The shared counter.
+		unsigned long long increments = 0;
+		for(unsigned int i = 0; i < threadNo; i++)
+		{
+			increments += slots[i].increments;
+		}
+
+		int counterNode = numaNodeOf(sharedPage);
+		sharedRows << numaPolicyName(policy) << "," << threadNo << ",";
+		if(counterNode < 0)
+		{
+			sharedRows << "unknown";
+		}
+		else
+		{
+			sharedRows << nodeIds[counterNode];
+		}
+		sharedRows << "," << (unsigned long long)(increments/(numaPhaseNsecs/1000000000.0)) << "\n";
+
+		cout << numaPolicyName(policy) << " done.\n";
+
+		munmap(sharedPage, sysconf(_SC_PAGESIZE));
+		delete [] slots;
+	}
+
+	dataDump << sharedRows.str();
+
+	// Append an extra new line character to the end of the file.
+	dataDump << "\n";
+	dataDump.close();
+}
@@ -0,0 +1,64 @@
+// Author: Jason Tennyson
+// File: Numa.h
+// Date: 10/19/26
+//
+// This file contains the definitions for the NUMA test. On a machine with
+// more than one memory node, memory that hangs off of another socket is
+// slower to get to than memory on the thread's own socket. The rest of the
+// program leaves the placement of its memory to chance (wherever the thread
+// that touches it first happens to be running), and this test places it on
+// purpose. The topology is read from /sys/devices/system/node, and memory is
+// placed with the mbind and set_mempolicy system calls directly, so libnuma
+// is not needed. On a machine with one node, every policy is a no-op and the
+// test just measures the one node it has.
+
+#ifndef Numa_h_
+#define Numa_h_
+
+#include <sched.h>
+
+#define MAX_NUMA_NODES		(1024)				// Most nodes we keep track of.
+#define DEFAULT_NUMA_MSECS	(500)				// Default time per measurement (ms).
+#define MAX_NUMA_BUFFER_MB	(65536)				// Biggest buffer per thread (MB).
+
+// These are the ways that memory can be placed.
+enum numaPolicy
+{
+	NUMA_FIRST_TOUCH = 0,	// Wherever the worker that touches it first is.
+	NUMA_INTERLEAVE,	// Page by page, across every node.
+	NUMA_BIND,		// On the worker's own node.
+	NUMA_REMOTE,		// On the node after the worker's own one.
+	NUMA_POLICIES		// The number of policies.
+};
+
+// This function returns the name of a policy.
+const char* numaPolicyName(numaPolicy policy);
+
+// This function returns the number of memory nodes, which is 1 when the
+// machine is UMA or the topology can't be read.
+unsigned int numaNodeCount(void);
+
+// This function fills cpus with the CPUs of the given node that we are
+// allowed to run on. Returns the number of them.
+unsigned int numaNodeCpus(unsigned int node, cpu_set_t* cpus);
+
+// This function places the memory from address to address + length on
+// the given node, or interleaves it across every node if node is
+// MAX_NUMA_NODES. It does nothing on a single node machine, and returns
+// false if the kernel said no.
+bool numaPlace(void* address, unsigned long long length, unsigned int node);
+
+// This function returns the node that the page holding address is on, or
+// -1 if it isn't known.
+int numaNodeOf(void* address);
+
+// This function runs the NUMA test and saves the results to filename in
+// the spreadsheet folder. First it measures a thread on every node against
+// memory on every node. Then it runs threadNo threads, spread across the
+// nodes, with their private buffers and a shared counter placed by each of
+// the policies. Every measurement runs for msecs milliseconds, and each
+// thread's buffer is bufferBytes long.
+void runNumaTest(const char* filename, unsigned int threadNo, unsigned long long bufferBytes,
+		 unsigned int msecs);
+
+#endif
@@ -0,0 +1,229 @@
+// Author: Jason Tennyson
+// File: OpenLoop.cpp
+// Date: 10/19/26
+//
+// This file contains the implementation of the open loop test. Each worker
+// owns its schedule, its histogram and its counters, so the only thing the
+// workers share is the critical section that is being measured.
+//
+// A worker that falls behind its schedule does not skip operations to catch
+// up. It starts the late ones right away, and they are charged for the time
+// they spent waiting. That is what keeps the latency honest (no coordinated
+// omission). Operations that were due but never started because the time
+// ran out are reported as the backlog.
+
+#include "OpenLoop.h"
+#include "LatencyHistogram.h"
+#include "ThreadTutorial.h"
+#include "SyntheticWork.h"
+#include "FastRandom.h"
+#include <cmath>
+#include <time.h>
+
+using namespace std;
+
+// This is everything a worker owns.
+struct openLoopWorker
+{
+	unsigned int index;		// Index of the worker.
+	double gapNsecs;		// Mean time between operations.
+	fastRandom random;		// The worker's own generator.
+	unsigned long long ops;		// Operations finished.
+	unsigned long long backlog;	// Operations due but never started.
+	latencyHistogram latencies;	// Latency from intended start.
+};
+
+// These values have to be stored globally to be accessed by the threads.
+static syncLock* openLoopLock;
+static volatile unsigned long long openLoopCounter;
+static unsigned long long openLoopStart, openLoopStop;
+static unsigned int openLoopThreads;
+static bool openLoopPoisson;
+static unsigned long long openLoopCsLoops, openLoopParLoops;
+
+// This function waits until the monotonic clock reaches the given time. It
+// sleeps for most of a long wait and spins for the last little bit.
+static void waitUntil(unsigned long long wakeNsecs)
+{
+	unsigned long long now = timeStamp::monotonicNsecs();
+
+	if((now + OPEN_LOOP_SPIN_NSECS) < wakeNsecs)
+	{
+		struct timespec wake;
+		unsigned long long sleepUntil = wakeNsecs - OPEN_LOOP_SPIN_NSECS;
+
+		wake.tv_sec = sleepUntil/1000000000ULL;
+		wake.tv_nsec = sleepUntil%1000000000ULL;
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, NULL);
+	}
+
+	while(timeStamp::monotonicNsecs() < wakeNsecs)
+	{
+		cpuRelax();
+	}
+}
+
+// This is the function that each worker runs.
+static void* openLoopGenerator(void* workerObject)
+{
+	openLoopWorker* worker = (openLoopWorker*)workerObject;
+
+	// With a fixed rate, the workers are spread out evenly across one gap
+	// so that they don't all arrive at once.
+	double intended = (double)openLoopStart;
+	if(!openLoopPoisson)
+	{
+		intended += worker->gapNsecs*worker->index/openLoopThreads;
+	}
+
+	while((unsigned long long)intended < openLoopStop)
+	{
+		unsigned long long due = (unsigned long long)intended;
+
+		waitUntil(due);
+
+		// If the time is up, whatever is left over is the backlog.
+		unsigned long long now = timeStamp::monotonicNsecs();
+		if(now >= openLoopStop)
+		{
+			worker->backlog = (unsigned long long)((openLoopStop - due)/worker->gapNsecs) + 1;
+			break;
+		}
+
+		// This is the operation. An atomic add can't protect the
+		// critical section work, so it just does the work first.
+		doSyntheticWork(openLoopParLoops);
+
+		if(openLoopLock->type() == SYNC_ATOMIC)
+		{
+			doSyntheticWork(openLoopCsLoops);
+			openLoopLock->increment(&openLoopCounter);
+		}
+		else
+		{
+			openLoopLock->lock();
+			doSyntheticWork(openLoopCsLoops);
+			openLoopCounter++;
+			openLoopLock->unlock();
+		}
+
+		// Charge it from when it was supposed to start.
+		worker->latencies.record(timeStamp::monotonicNsecs() - due);
+		worker->ops++;
+
+		// Work out when the next one is due.
+		if(openLoopPoisson)
+		{
+			intended += -log(1.0 - worker->random.unit())*worker->gapNsecs;
+		}
+		else
+		{
+			intended += worker->gapNsecs;
+		}
+	}
+
+	return (NULL);
+}
+
+// This function runs the open loop test.
+void runOpenLoopTest(const char* filename, unsigned int threadNo,
+		     const syncType* strategies, unsigned int strategyCount,
+		     unsigned int minRate, unsigned int maxRate, unsigned int steps,
+		     unsigned int seconds, bool poisson,
+		     unsigned int csNsecs, unsigned int parNsecs)
+{
+	// Create a temp filename to append the spreadsheet folder location
+	// in front of the desired filename.
+	string tempFilename = SPREADSHEET_FOLDER;
+	tempFilename += "/";
+	tempFilename += filename;
+
+	ofstream dataDump(tempFilename.c_str());
+
+	// Write the top line of the data file.
+	dataDump << "Strategy,Threads,CS (ns),Parallel (ns),Offered Ops/Sec,Achieved Ops/Sec,Backlog,"
+		 << "Mean (ns),p50 (ns),p90 (ns),p99 (ns),p99.9 (ns),Max (ns),Result\n";
+
+	openLoopThreads = threadNo;
+	openLoopPoisson = poisson;
+	openLoopCsLoops = workLoopsFor(csNsecs);
+	openLoopParLoops = workLoopsFor(parNsecs);
+
+	// The ratio between neighbouring offered loads.
+	double ratio = (steps > 1) ? pow((double)maxRate/(double)minRate, 1.0/(steps - 1)) : 1.0;
+
+	for(unsigned int s = 0; s < strategyCount; s++)
+	{
+		for(unsigned int step = 0; step < steps; step++)
+		{
+			double offered = minRate*pow(ratio, (double)step);
+
+			// The workers and their handles.
+			openLoopWorker* workers = new openLoopWorker[threadNo];
+			pthread_t threads[threadNo];
+
+			openLoopLock = new syncLock(strategies[s]);
+			openLoopCounter = 0;
+
+			for(unsigned int i = 0; i < threadNo; i++)
+			{
+				workers[i].index = i;
+				workers[i].gapNsecs = 1000000000.0*threadNo/offered;
+				workers[i].random.stream(DEFAULT_RANDOM_SEED, i);
+				workers[i].ops = 0;
+				workers[i].backlog = 0;
+			}
+
+			// Start the schedule a little in the future so every
+			// worker is up and running before the first operation.
+			openLoopStart = timeStamp::monotonicNsecs() + 10000000ULL;
+			openLoopStop = openLoopStart + (unsigned long long)seconds*1000000000ULL;
+
+			for(unsigned int i = 0; i < threadNo; i++)
+			{
+				pthread_create(&threads[i], NULL, openLoopGenerator, &workers[i]);
+			}
+
+			for(unsigned int i = 0; i < threadNo; i++)
+			{
+				pthread_join(threads[i], NULL);
+			}
+
+			// Put all the workers together.
+			latencyHistogram* latencies = new latencyHistogram;
+			unsigned long long ops = 0;
+			unsigned long long backlog = 0;
+
+			for(unsigned int i = 0; i < threadNo; i++)
+			{
+				latencies->merge(workers[i].latencies);
+				ops += workers[i].ops;
+				backlog += workers[i].backlog;
+			}
+
+			double achieved = (double)ops/(double)seconds;
+			float endResult = (ops ? (float)((double)openLoopCounter/(double)ops) : 1.0f);
+
+			dataDump << syncName(strategies[s]) << "," << threadNo << ","
+				 << csNsecs << "," << parNsecs << ","
+				 << (unsigned long long)offered << "," << (unsigned long long)achieved << ","
+				 << backlog << "," << latencies->mean() << ","
+				 << latencies->percentile(50) << "," << latencies->percentile(90) << ","
+				 << latencies->percentile(99) << "," << latencies->percentile(99.9) << ","
+				 << latencies->maximum() << "," << endResult << "\n";
+			dataDump.flush();
+
+			cout << syncName(strategies[s]) << ": offered " << (unsigned long long)offered
+			     << " ops/sec, achieved " << (unsigned long long)achieved
+			     << " ops/sec, p99 " << latencies->percentile(99) << " ns\n";
+
+			delete latencies;
+			delete openLoopLock;
+			delete [] workers;
+		}
+	}
+
+	// Append an extra new line character to the end of the file.
+	dataDump << "\n";
+	dataDump.close();
+}
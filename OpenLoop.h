@@ -0,0 +1,40 @@
+// Author: Jason Tennyson
+// File: OpenLoop.h
+// Date: 10/19/26
+//
+// This file contains the function prototypes for the open loop test. The
+// regular tests are closed loop: a thread starts its next operation as soon
+// as the last one is done, so when the lock gets slow, the threads simply
+// ask for less, and the slowness never shows up as latency. In the open loop
+// test, every worker has a schedule of when each operation is supposed to
+// start (at a fixed rate or with Poisson arrivals), and latency is measured
+// from that intended start time. When the lock can't keep up, operations
+// queue behind the schedule and their latency grows the way it would for
+// requests arriving at a real service.
+
+#ifndef OpenLoop_h_
+#define OpenLoop_h_
+
+#include "SyncStrategy.h"
+
+#define DEFAULT_MIN_RATE	(10000)				// Default lowest offered ops/sec.
+#define DEFAULT_MAX_RATE	(10000000)			// Default highest offered ops/sec.
+#define MAX_RATE		(1000000000)			// Highest offered ops/sec allowed.
+#define DEFAULT_RATE_STEPS	(10)				// Default number of offered loads.
+#define MAX_RATE_STEPS		(100)				// Maximum number of offered loads.
+#define DEFAULT_OPEN_LOOP_SECS	(2)				// Default seconds per offered load.
+#define OPEN_LOOP_SPIN_NSECS	(50000)				// Spin instead of sleeping this close.
+
+// This function sweeps the offered load from minRate to maxRate in steps
+// (spaced on a log scale) for every strategy, running each load for the
+// given number of seconds on threadNo workers, and saves the latency and
+// throughput of every point to filename in the spreadsheet folder. Each
+// operation does parNsecs of synthetic work before it enters the critical
+// section and csNsecs inside of it.
+void runOpenLoopTest(const char* filename, unsigned int threadNo,
+		     const syncType* strategies, unsigned int strategyCount,
+		     unsigned int minRate, unsigned int maxRate, unsigned int steps,
+		     unsigned int seconds, bool poisson,
+		     unsigned int csNsecs, unsigned int parNsecs);
+
+#endif
@@ -0,0 +1,321 @@
+// Author: Jason Tennyson
+// File: Oversubscribe.cpp
+// Date: 10/19/26
+//
+// This file contains the implementation of the oversubscription test. Every
+// thread counts its own context switches, once from getrusage and once from
+// its status file in /proc. They should agree. The voluntary ones are the
+// times a thread went to sleep on its own (a mutex blocking, for example),
+// and the involuntary ones are the times the scheduler took the CPU away
+// because its time slice was up.
+//
+// The loss per extra thread compares each run to the 1x run. If the 1x run
+// did B ops/sec and a run with t threads on c CPUs did T, the loss is
+// (1 - T/B)/(t - c), as a percentage.
+
+#include "Oversubscribe.h"
+#include "ThreadTutorial.h"
+#include "TimedRun.h"
+#include "Workload.h"
+#include <cstdlib>
+#include <unistd.h>
+#include <sched.h>
+#include <time.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+using namespace std;
+
+// This structure is what each thread owns: its operations and how often it
+// was switched out, counted both ways.
+struct oversubSlot
+{
+	unsigned long long ops;			// Operations done.
+	unsigned long long voluntary;		// Voluntary switches from getrusage.
+	unsigned long long involuntary;		// Involuntary switches from getrusage.
+	unsigned long long procVoluntary;	// Voluntary switches from /proc.
+	unsigned long long procInvoluntary;	// Involuntary switches from /proc.
+	char pad[CACHE_LINE_SIZE - 5*sizeof(unsigned long long)];
+};
+
+// These values have to be stored globally to be accessed by the threads.
+static syncLock* oversubLock;
+static volatile unsigned long long oversubCounter;
+static volatile bool oversubStop;
+static unsigned long long oversubCsLoops, oversubParLoops;
+
+// This is the gate that the threads wait at until all of them have been
+// created. It isn't a barrier, since we don't know how many threads we will
+// get until pthread_create() stops failing, and a barrier has to be told.
+static pthread_mutex_t oversubGateMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t oversubGate = PTHREAD_COND_INITIALIZER;
+static bool oversubOpen;
+
+// This function reads the calling thread's context switch counts from its
+// status file in /proc. They are left alone if the file can't be read.
+static void readProcSwitches(unsigned long long* voluntary, unsigned long long* involuntary)
+{
+	ifstream status("/proc/thread-self/status");
+	string line;
+
+	while(getline(status, line))
+	{
+		if(line.compare(0, 24, "voluntary_ctxt_switches:") == 0)
+		{
+			*voluntary = strtoull(line.c_str() + 24, NULL, 10);
+		}
+		else if(line.compare(0, 27, "nonvoluntary_ctxt_switches:") == 0)
+		{
+			*involuntary = strtoull(line.c_str() + 27, NULL, 10);
+		}
+	}
+}
+
+// This is the function that each thread runs.
+static void* oversubGenerator(void* slotObject)
+{
+	oversubSlot* slot = (oversubSlot*)slotObject;
+	struct rusage before, after;
+	unsigned long long procVoluntary = 0, procInvoluntary = 0;
+
+	// Wait for everyone to be created so we all start together.
+	pthread_mutex_lock(&oversubGateMutex);
+	while(!oversubOpen)
+	{
+		pthread_cond_wait(&oversubGate, &oversubGateMutex);
+	}
+	pthread_mutex_unlock(&oversubGateMutex);
+
+	// Only count the switches from here on.
+	getrusage(RUSAGE_THREAD, &before);
+	readProcSwitches(&procVoluntary, &procInvoluntary);
+
+	while(!__atomic_load_n(&oversubStop, __ATOMIC_ACQUIRE))
+	{
+		for(unsigned int i = 0; i < OVERSUB_CHUNK; i++)
+		{
+			doSyntheticWork(oversubParLoops);
+
+			// An atomic add can't protect the critical section
+			// work, so it just does the work first.
+			if(oversubLock->type() == SYNC_ATOMIC)
+			{
+				doSyntheticWork(oversubCsLoops);
+				oversubLock->increment(&oversubCounter);
+			}
+			else
+			{
+				oversubLock->lock();
+				doSyntheticWork(oversubCsLoops);
+				oversubCounter++;
+				oversubLock->unlock();
+			}
+		}
+
+		slot->ops += OVERSUB_CHUNK;
+	}
+
+	getrusage(RUSAGE_THREAD, &after);
+	slot->voluntary = after.ru_nvcsw - before.ru_nvcsw;
+	slot->involuntary = after.ru_nivcsw - before.ru_nivcsw;
+
+	slot->procVoluntary = procVoluntary;
+	slot->procInvoluntary = procInvoluntary;
+	readProcSwitches(&slot->procVoluntary, &slot->procInvoluntary);
+	slot->procVoluntary -= procVoluntary;
+	slot->procInvoluntary -= procInvoluntary;
+
+	return (NULL);
+}
+
+// This function runs the oversubscription test.
+void runOversubscribeTest(const char* filename, const syncType* strategies, unsigned int strategyCount,
+			  unsigned int maxFactor, unsigned int seconds,
+			  unsigned int csNsecs, unsigned int parNsecs)
+{
+	// Count the CPUs we are allowed to run on, which can be fewer than
+	// the ones that are online.
+	cpu_set_t allowed;
+	unsigned int cpus = 0;
+
+	if(sched_getaffinity(0, sizeof(allowed), &allowed) == 0)
+	{
+		cpus = CPU_COUNT(&allowed);
+	}
+	if(cpus == 0)
+	{
+		cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	}
+
+	// Don't go past the most threads we can handle.
+	if((cpus*maxFactor) > MAX_OVERSUB_THREADS)
+	{
+		maxFactor = MAX_OVERSUB_THREADS/cpus;
+
+		if(maxFactor == 0)
+		{
+			maxFactor = 1;
+		}
+
+		cout << "WARNING: only going up to " << maxFactor << " threads per CPU.\n";
+	}
+
+	// Create a temp filename to append the spreadsheet folder location
+	// in front of the desired filename.
+	string tempFilename = SPREADSHEET_FOLDER;
+	tempFilename += "/";
+	tempFilename += filename;
+
+	ofstream dataDump(tempFilename.c_str());
+
+	// Write the top line of the data file.
+	dataDump << "Strategy,CPUs,Threads,Threads/CPU,CS (ns),Parallel (ns),Ops/Sec,"
+		 << "Loss/Extra Thread (%),Voluntary/Sec,Involuntary/Sec,"
+		 << "Voluntary (/proc),Involuntary (/proc),Min Thread Ops,Max Thread Ops,Result\n";
+
+	oversubCsLoops = workLoopsFor(csNsecs);
+	oversubParLoops = workLoopsFor(parNsecs);
+
+	// Small stacks, so that thousands of threads don't need gigabytes.
+	pthread_attr_t attributes;
+	pthread_attr_init(&attributes);
+	pthread_attr_setstacksize(&attributes, OVERSUB_STACK_SIZE);
+
+	for(unsigned int s = 0; s < strategyCount; s++)
+	{
+		// The throughput of the 1x run, which the others are compared to.
+		double baseline = 0;
+
+		for(unsigned int factor = 1; factor <= maxFactor; factor++)
+		{
+			unsigned int threadNo = cpus*factor;
+
+			oversubSlot* slots = allocateThreadSlots<oversubSlot>(threadNo);
+			if(!slots)
+			{
+				break;
+			}
+
+			pthread_t* threads = new pthread_t[threadNo];
+
+			oversubLock = new syncLock(strategies[s]);
+			oversubCounter = 0;
+			oversubStop = false;
+			oversubOpen = false;
+
+			// Stop at the first thread that can't be created, since
+			// the system is out of threads or memory for stacks.
+			unsigned int created = 0;
+			while((created < threadNo) &&
+			      (pthread_create(&threads[created], &attributes, oversubGenerator, &slots[created]) == 0))
+			{
+				created++;
+			}
+
+			// If we didn't get them all, the threads we did get are
+			// told to stop before they are let go, and the cell is
+			// recorded as failed. More threads per CPU would only
+			// fail again, so this strategy is done.
+			if(created < threadNo)
+			{
+				__atomic_store_n(&oversubStop, true, __ATOMIC_RELEASE);
+			}
+
+			// Let everyone go and start the clock.
+			pthread_mutex_lock(&oversubGateMutex);
+			oversubOpen = true;
+			pthread_cond_broadcast(&oversubGate);
+			pthread_mutex_unlock(&oversubGateMutex);
+			unsigned long long startNsecs = timeStamp::monotonicNsecs();
+
+			if(created == threadNo)
+			{
+				timeStamp::sleepUntilNsecs(startNsecs + (unsigned long long)seconds*1000000000ULL);
+				__atomic_store_n(&oversubStop, true, __ATOMIC_RELEASE);
+			}
+
+			for(unsigned int i = 0; i < created; i++)
+			{
+				pthread_join(threads[i], NULL);
+			}
+
+			double elapsedSecs = (double)(timeStamp::monotonicNsecs() - startNsecs)/1000000000.0;
+
+			if(created < threadNo)
+			{
+				cout << "WARNING: only " << created << " of " << threadNo << " threads could be created, "
+				     << "so " << syncName(strategies[s]) << " stops at " << (factor - 1) << " threads per CPU.\n";
+
+				dataDump << syncName(strategies[s]) << "," << cpus << "," << threadNo << ","
+					 << factor << "," << csNsecs << "," << parNsecs << ",,,,,,,,,failed\n";
+				dataDump.flush();
+
+				delete oversubLock;
+				delete [] threads;
+				freeThreadSlots(slots);
+				break;
+			}
+
+			// Total everything up.
+			unsigned long long totalOps = 0, voluntary = 0, involuntary = 0;
+			unsigned long long procVoluntary = 0, procInvoluntary = 0;
+			unsigned long long minOps = slots[0].ops, maxOps = slots[0].ops;
+
+			for(unsigned int i = 0; i < threadNo; i++)
+			{
+				totalOps += slots[i].ops;
+				voluntary += slots[i].voluntary;
+				involuntary += slots[i].involuntary;
+				procVoluntary += slots[i].procVoluntary;
+				procInvoluntary += slots[i].procInvoluntary;
+
+				if(slots[i].ops < minOps)
+				{
+					minOps = slots[i].ops;
+				}
+				if(slots[i].ops > maxOps)
+				{
+					maxOps = slots[i].ops;
+				}
+			}
+
+			double throughput = (double)totalOps/elapsedSecs;
+			float endResult = (totalOps ? (float)((double)oversubCounter/(double)totalOps) : 1.0f);
+
+			dataDump << syncName(strategies[s]) << "," << cpus << "," << threadNo << ","
+				 << factor << "," << csNsecs << "," << parNsecs << ","
+				 << (unsigned long long)throughput << ",";
+
+			if(factor == 1)
+			{
+				baseline = throughput;
+				dataDump << "0,";
+			}
+			else
+			{
+				double loss = (baseline > 0) ? (1.0 - throughput/baseline) : 0;
+				dataDump << 100.0*loss/(threadNo - cpus) << ",";
+			}
+
+			dataDump << (unsigned long long)(voluntary/elapsedSecs) << ","
+				 << (unsigned long long)(involuntary/elapsedSecs) << ","
+				 << procVoluntary << "," << procInvoluntary << ","
+				 << minOps << "," << maxOps << "," << endResult << "\n";
+			dataDump.flush();
+
+			cout << syncName(strategies[s]) << ": " << threadNo << " threads, "
+			     << (unsigned long long)throughput << " ops/sec, "
+			     << (unsigned long long)(involuntary/elapsedSecs) << " involuntary switches/sec\n";
+
+			delete oversubLock;
+			delete [] threads;
+			freeThreadSlots(slots);
+		}
+	}
+
+	pthread_attr_destroy(&attributes);
+
+	// Append an extra new line character to the end of the file.
+	dataDump << "\n";
+	dataDump.close();
+}
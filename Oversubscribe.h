@@ -0,0 +1,37 @@
+// Author: Jason Tennyson
+// File: Oversubscribe.h
+// Date: 10/19/26
+//
+// This file contains the function prototypes for the oversubscription test.
+// The rest of the program tells you not to run more threads than you have
+// CPUs, but real programs do it all the time. This test does it on purpose:
+// it runs 1x, 2x, and on up to many times as many threads as there are CPUs
+// we are allowed to run on, and counts how often the threads got switched
+// out. When a thread that holds a spin lock gets switched out, every thread
+// waiting on it spins for nothing until it comes back, and this is where you
+// see what that costs.
+
+#ifndef Oversubscribe_h_
+#define Oversubscribe_h_
+
+#include "SyncStrategy.h"
+
+#define DEFAULT_OVERSUB_FACTOR	(8)				// Default most threads per CPU.
+#define MAX_OVERSUB_FACTOR	(64)				// Maximum threads per CPU.
+#define MAX_OVERSUB_THREADS	(4096)				// Most threads in one run.
+#define DEFAULT_OVERSUB_SECS	(1)				// Default seconds per run.
+#define OVERSUB_CHUNK		(64)				// Operations between flag checks.
+#define OVERSUB_STACK_SIZE	(262144)			// Stack size of each thread.
+
+// This function runs every strategy with 1, 2, and on up to maxFactor
+// threads per CPU, for the given number of seconds each, and saves the
+// throughput and the context switches of every run to filename in the
+// spreadsheet folder. Each operation does parNsecs of synthetic work before
+// it enters the critical section and csNsecs inside of it. If a run can't
+// create all of its threads, it is saved as failed and the strategy stops
+// there.
+void runOversubscribeTest(const char* filename, const syncType* strategies, unsigned int strategyCount,
+			  unsigned int maxFactor, unsigned int seconds,
+			  unsigned int csNsecs, unsigned int parNsecs);
+
+#endif
@@ -0,0 +1,370 @@
+// Author: Jason Tennyson
+// File: PhaseBarrier.cpp
+// Date: 10/19/26
+//
+// This file contains the barriers and the implementation of the phased test.
+// The spin barriers never reset their flags. Each thread keeps a sense that
+// flips every phase, and a flag means "got there" when it matches the sense
+// of the phase. The dissemination barrier needs two sets of flags that it
+// takes turns with, since a fast thread can start writing the flags of the
+// next phase before a slow one has read the last one.
+//
+// Every phase, a thread writes the phase it finished before the barrier and
+// checks its neighbour's after it. If the neighbour hasn't finished the same
+// phase, the barrier let someone through too early, and the result shows it.
+
+#include "PhaseBarrier.h"
+#include "NameList.h"
+#include "ThreadTutorial.h"
+#include "SyncStrategy.h"
+#include "TimedRun.h"
+#include "Workload.h"
+#include <cstring>
+#include <vector>
+#include <sched.h>
+
+using namespace std;
+
+// These are the names of the barriers, in the order of barrierType.
+static const char* barrierNames[BARRIER_TYPES] = { "pthread", "central", "dissemination", "tournament" };
+
+// This structure is one flag, on a cache line of its own.
+struct phaseFlag
+{
+	volatile unsigned int value;
+	char pad[CACHE_LINE_SIZE - sizeof(unsigned int)];
+};
+
+// This structure is one thread's place in the barriers and how its phases
+// went. The neighbouring thread reads phase to check that the barrier held.
+struct phaseSlot
+{
+	unsigned int index;			// Index of the thread.
+	unsigned int sense;			// The sense of the current phase.
+	unsigned int parity;			// Which set of dissemination flags.
+	volatile unsigned long long phase;	// Phases finished.
+	unsigned long long total;		// What the slices added up to.
+	unsigned long long violations;		// Times a neighbour was behind.
+	unsigned long long startNsecs;		// When this thread started.
+	unsigned long long endNsecs;		// When this thread finished.
+	char pad[CACHE_LINE_SIZE];
+};
+
+// These are the barrier being tested and the state of every barrier.
+static barrierType phaseKind;
+static bool phaseBarrierOn;
+static unsigned int phaseThreads, phaseRounds, phaseCount, phaseSliceOps;
+static phaseSlot* phaseSlots;
+static pthread_barrier_t phaseStartBarrier;
+static pthread_barrier_t libraryBarrier;
+static phaseFlag centralCount, centralSense;
+static phaseFlag* disseminationFlags;
+static phaseFlag* tournamentFlags;
+static phaseFlag tournamentRelease;
+
+// This function returns the name of a barrier.
+const char* barrierName(barrierType type)
+{
+	return ((type < BARRIER_TYPES) ? barrierNames[type] : "unknown");
+}
+
+// This function reads a comma separated list of barrier names. Names we
+// don't know and repeats are skipped.
+unsigned int barrierListFromNames(const char* names, barrierType* types)
+{
+	return readNameList(names, barrierNames, BARRIER_TYPES, types);
+}
+
+// This function spins until a flag has the given value, and starts giving
+// up the CPU if it spins for too long.
+static void spinUntil(volatile unsigned int* flag, unsigned int value)
+{
+	unsigned int spins = 0;
+
+	while(__atomic_load_n(flag, __ATOMIC_ACQUIRE) != value)
+	{
+		if(spins < BARRIER_SPINS)
+		{
+			spins++;
+			cpuRelax();
+		}
+		else
+		{
+			sched_yield();
+		}
+	}
+}
+
+// This function is the sense reversing central barrier.
+static void centralWait(phaseSlot* slot)
+{
+	slot->sense ^= 1;
+
+	if(__atomic_sub_fetch(&centralCount.value, 1, __ATOMIC_ACQ_REL) == 0)
+	{
+		// We were the last one here. Nobody can get to the next
+		// barrier until the flag flips, so the count can be reset
+		// first.
+		__atomic_store_n(&centralCount.value, phaseThreads, __ATOMIC_RELAXED);
+		__atomic_store_n(&centralSense.value, slot->sense, __ATOMIC_RELEASE);
+	}
+	else
+	{
+		spinUntil(&centralSense.value, slot->sense);
+	}
+}
+
+// This function is the dissemination barrier.
+static void disseminationWait(phaseSlot* slot)
+{
+	for(unsigned int round = 0; round < phaseRounds; round++)
+	{
+		unsigned int partner = (slot->index + (1U << round))%phaseThreads;
+
+		__atomic_store_n(&disseminationFlags[(partner*2 + slot->parity)*MAX_BARRIER_ROUNDS + round].value,
+				 slot->sense, __ATOMIC_RELEASE);
+		spinUntil(&disseminationFlags[(slot->index*2 + slot->parity)*MAX_BARRIER_ROUNDS + round].value,
+			  slot->sense);
+	}
+
+	// The sense only flips once both sets of flags have been used.
+	if(slot->parity == 1)
+	{
+		slot->sense ^= 1;
+	}
+	slot->parity ^= 1;
+}
+
+// This function is the tournament barrier. In round k, the threads whose
+// index has bit k as its lowest set bit lose to the thread 2^k below them.
+// Thread 0 wins every round.
+static void tournamentWait(phaseSlot* slot)
+{
+	unsigned int sense = slot->sense ^ 1;
+	unsigned int index = slot->index;
+	bool champion = true;
+
+	for(unsigned int round = 0; round < phaseRounds; round++)
+	{
+		unsigned int step = 1U << round;
+
+		if(index & step)
+		{
+			// We lost. Tell the winner, and wait for the champion.
+			__atomic_store_n(&tournamentFlags[(index - step)*MAX_BARRIER_ROUNDS + round].value,
+					 sense, __ATOMIC_RELEASE);
+			spinUntil(&tournamentRelease.value, sense);
+			champion = false;
+			break;
+		}
+
+		// We won, unless nobody was there to play.
+		if((index + step) < phaseThreads)
+		{
+			spinUntil(&tournamentFlags[index*MAX_BARRIER_ROUNDS + round].value, sense);
+		}
+	}
+
+	if(champion)
+	{
+		__atomic_store_n(&tournamentRelease.value, sense, __ATOMIC_RELEASE);
+	}
+
+	slot->sense = sense;
+}
+
+// This function waits at the barrier that is being tested.
+static void barrierWait(phaseSlot* slot)
+{
+	switch(phaseKind)
+	{
+		case BARRIER_CENTRAL:
+			centralWait(slot);
+			break;
+		case BARRIER_DISSEMINATION:
+			disseminationWait(slot);
+			break;
+		case BARRIER_TOURNAMENT:
+			tournamentWait(slot);
+			break;
+		default:
+			pthread_barrier_wait(&libraryBarrier);
+			break;
+	}
+}
+
+// This is the function that each thread runs during the phased test. Every
+// phase is a slice of increments to a private counter, like calcGenerator
+// does when nothing is shared, and then the barrier.
+static void* phaseGenerator(void* slotObject)
+{
+	phaseSlot* slot = (phaseSlot*)slotObject;
+	phaseSlot* neighbour = &phaseSlots[(slot->index + 1)%phaseThreads];
+	volatile unsigned long long counter = 0;
+
+	// No phase starts until every thread has been created, so that the
+	// first barrier doesn't wait on pthread_create().
+	pthread_barrier_wait(&phaseStartBarrier);
+	slot->startNsecs = timeStamp::monotonicNsecs();
+
+	for(unsigned int phase = 0; phase < phaseCount; phase++)
+	{
+		for(unsigned int i = 0; i < phaseSliceOps; i++)
+		{
+			counter++;
+		}
+
+		if(phaseBarrierOn)
+		{
+			__atomic_store_n(&slot->phase, phase + 1, __ATOMIC_RELAXED);
+			barrierWait(slot);
+
+			if(__atomic_load_n(&neighbour->phase, __ATOMIC_RELAXED) < (phase + 1))
+			{
+				slot->violations++;
+			}
+		}
+	}
+
+	slot->endNsecs = timeStamp::monotonicNsecs();
+	slot->total = counter;
+
+	return (NULL);
+}
+
+// This function runs every thread through every phase and returns how long
+// it took in nanoseconds. The barrier used is whatever phaseKind is set to,
+// or none if phaseBarrierOn is off.
+static unsigned long long runPhases(unsigned int threadNo, unsigned long long* violations)
+{
+	phaseThreads = threadNo;
+	phaseRounds = 0;
+	while((1U << phaseRounds) < threadNo)
+	{
+		phaseRounds++;
+	}
+
+	// Set up every barrier, whether it is used or not.
+	phaseSlots = allocateThreadSlots<phaseSlot>(threadNo);
+	if(!phaseSlots)
+	{
+		return 0;
+	}
+
+	disseminationFlags = new phaseFlag[threadNo*2*MAX_BARRIER_ROUNDS];
+	tournamentFlags = new phaseFlag[threadNo*MAX_BARRIER_ROUNDS];
+	memset(disseminationFlags, 0, threadNo*2*MAX_BARRIER_ROUNDS*sizeof(phaseFlag));
+	memset(tournamentFlags, 0, threadNo*MAX_BARRIER_ROUNDS*sizeof(phaseFlag));
+
+	centralCount.value = threadNo;
+	centralSense.value = 0;
+	tournamentRelease.value = 0;
+	pthread_barrier_init(&libraryBarrier, NULL, threadNo);
+	pthread_barrier_init(&phaseStartBarrier, NULL, threadNo + 1);
+
+	pthread_t threads[threadNo];
+
+	for(unsigned int i = 0; i < threadNo; i++)
+	{
+		phaseSlots[i].index = i;
+
+		// The dissemination barrier starts with its sense set, since
+		// its flags start out clear.
+		phaseSlots[i].sense = (phaseKind == BARRIER_DISSEMINATION) ? 1 : 0;
+
+		pthread_create(&threads[i], NULL, phaseGenerator, &phaseSlots[i]);
+	}
+
+	// Let everyone go.
+	pthread_barrier_wait(&phaseStartBarrier);
+
+	for(unsigned int i = 0; i < threadNo; i++)
+	{
+		pthread_join(threads[i], NULL);
+	}
+
+	// The run goes from the first thread to start to the last one to
+	// finish. The threads keep their own time because this thread might
+	// not get the CPU back until they are done.
+	unsigned long long startNsecs = phaseSlots[0].startNsecs;
+	unsigned long long endNsecs = phaseSlots[0].endNsecs;
+
+	*violations = 0;
+	for(unsigned int i = 0; i < threadNo; i++)
+	{
+		startNsecs = (phaseSlots[i].startNsecs < startNsecs) ? phaseSlots[i].startNsecs : startNsecs;
+		endNsecs = (phaseSlots[i].endNsecs > endNsecs) ? phaseSlots[i].endNsecs : endNsecs;
+		*violations += phaseSlots[i].violations;
+	}
+
+	unsigned long long nsecs = endNsecs - startNsecs;
+
+	pthread_barrier_destroy(&phaseStartBarrier);
+	pthread_barrier_destroy(&libraryBarrier);
+	delete [] disseminationFlags;
+	delete [] tournamentFlags;
+	freeThreadSlots(phaseSlots);
+
+	return nsecs;
+}
+
+// This function runs the phased test.
+void runPhasedTest(const char* filename, const barrierType* barriers, unsigned int barrierCount,
+		   unsigned int maxThreads, unsigned int phases, unsigned int sliceOps)
+{
+	// Create a temp filename to append the spreadsheet folder location
+	// in front of the desired filename.
+	string tempFilename = SPREADSHEET_FOLDER;
+	tempFilename += "/";
+	tempFilename += filename;
+
+	ofstream dataDump(tempFilename.c_str());
+
+	// Write the top line of the data file.
+	dataDump << "Barrier,Threads,Phases,Slice Ops,Time (ms),Per Phase (ns),"
+		 << "No Barrier Per Phase (ns),Overhead/Phase (ns),Result\n";
+
+	phaseCount = phases;
+	phaseSliceOps = sliceOps;
+
+	// Time the slices with no barriers first, once per thread count,
+	// after one run that is thrown out to warm everything up.
+	vector<double> baseline(maxThreads + 1, 0);
+	unsigned long long warmUp;
+	phaseBarrierOn = false;
+	runPhases(MIN_THREADS, &warmUp);
+
+	for(unsigned int threadNo = MIN_THREADS; threadNo <= maxThreads; threadNo++)
+	{
+		unsigned long long violations;
+		baseline[threadNo] = (double)runPhases(threadNo, &violations)/phases;
+	}
+
+	phaseBarrierOn = true;
+
+	for(unsigned int b = 0; b < barrierCount; b++)
+	{
+		phaseKind = barriers[b];
+
+		for(unsigned int threadNo = MIN_THREADS; threadNo <= maxThreads; threadNo++)
+		{
+			unsigned long long violations;
+			unsigned long long nsecs = runPhases(threadNo, &violations);
+			double perPhase = (double)nsecs/phases;
+			float endResult = 1.0f - (float)((double)violations/((double)phases*threadNo));
+
+			dataDump << barrierName(phaseKind) << "," << threadNo << "," << phases << ","
+				 << sliceOps << "," << nsecs/1000000.0 << "," << perPhase << ","
+				 << baseline[threadNo] << "," << perPhase - baseline[threadNo] << ","
+				 << endResult << "\n";
+			dataDump.flush();
+
+			cout << barrierName(phaseKind) << ": " << threadNo << " threads, "
+			     << (long long)(perPhase - baseline[threadNo]) << " ns per barrier\n";
+		}
+	}
+
+	// Append an extra new line character to the end of the file.
+	dataDump << "\n";
+	dataDump.close();
+}
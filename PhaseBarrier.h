@@ -0,0 +1,67 @@
+// Author: Jason Tennyson
+// File: PhaseBarrier.h
+// Date: 10/19/26
+//
+// This file contains the definitions for the phased test. The rest of the
+// program starts its threads, lets them run, and joins them, once. A lot of
+// real parallel code (simulations, most of all) instead runs thousands of
+// short phases, and every thread has to finish a phase before any thread
+// starts the next one. What keeps them together is a barrier, and when the
+// phases are short, the barrier can cost more than the work. This test runs
+// a small slice of calcGenerator style work per phase with four different
+// barriers at the end of every phase:
+//
+//	pthread		The pthread_barrier_t from the C library.
+//	central		One counter and one flag that every thread spins on.
+//			The last thread to get there resets the counter and
+//			flips the flag, and the flag's meaning (its "sense")
+//			flips every phase, so it never has to be reset.
+//	dissemination	In round r, thread i tells thread i + 2^r that it got
+//			there and waits to hear from thread i - 2^r. After
+//			log2(threads) rounds everyone has heard from everyone,
+//			and nobody ever spins on the same flag as anyone else.
+//	tournament	Threads pair off like a tournament bracket, the loser
+//			of each pair tells the winner it got there, and the
+//			winner moves on to the next round. The champion flips
+//			a flag that everyone else is waiting on.
+//
+// The spin barriers give up the CPU after BARRIER_SPINS spins, so that a
+// thread that is waiting doesn't keep the one it is waiting for from
+// running when there are more threads than CPUs.
+
+#ifndef PhaseBarrier_h_
+#define PhaseBarrier_h_
+
+#define DEFAULT_PHASES		(10000)				// Default phases per run.
+#define MAX_PHASES		(100000000)			// Most phases per run.
+#define DEFAULT_SLICE_OPS	(1000)				// Default operations per phase.
+#define MAX_SLICE_OPS		(100000000)			// Most operations per phase.
+#define BARRIER_SPINS		(4096)				// Spins before yielding.
+#define MAX_BARRIER_ROUNDS	(32)				// Rounds for 2^32 threads.
+
+// These are the barriers that can be compared.
+enum barrierType
+{
+	BARRIER_PTHREAD = 0,	// pthread_barrier_t.
+	BARRIER_CENTRAL,	// A sense reversing counter and flag.
+	BARRIER_DISSEMINATION,	// log2(threads) rounds of pairwise flags.
+	BARRIER_TOURNAMENT,	// A bracket of pairwise flags and one wake up flag.
+	BARRIER_TYPES		// The number of barriers.
+};
+
+// This function returns the name of a barrier.
+const char* barrierName(barrierType type);
+
+// This function reads a comma separated list of barrier names into types,
+// which must have room for BARRIER_TYPES entries. Returns the count.
+unsigned int barrierListFromNames(const char* names, barrierType* types);
+
+// This function runs every barrier with 1 up to maxThreads threads, for
+// phases phases of sliceOps operations each, and saves the time per phase
+// and what the barrier added to it to filename in the spreadsheet folder.
+// The overhead is measured against the same threads doing the same slices
+// with no barrier between them.
+void runPhasedTest(const char* filename, const barrierType* barriers, unsigned int barrierCount,
+		   unsigned int maxThreads, unsigned int phases, unsigned int sliceOps);
+
+#endif
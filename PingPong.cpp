@@ -0,0 +1,376 @@
+// Author: Jason Tennyson
+// File: PingPong.cpp
+// Date: 10/19/26
+//
+// This file contains the implementation of the ping-pong test. The ping
+// thread of each pair takes a time stamp, signals the pong thread, and
+// waits to be signaled back. The pong thread just waits and signals. The
+// round trip is two wakeups, so half of it is what one wakeup costs.
+//
+// When the threads are pinned, pair i gets the 2i'th and 2i+1'th of the CPUs
+// that we are allowed on (wrapping around them), so the two threads are never
+// on the same CPU unless there is only one. If a thread can't be pinned, the
+// run is marked as failed in the spreadsheet instead of as pinned.
+
+#include "PingPong.h"
+#include "NameList.h"
+#include "LatencyHistogram.h"
+#include "SyncStrategy.h"
+#include "ThreadTutorial.h"
+#include <unistd.h>
+#include <sched.h>
+#include <vector>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+using namespace std;
+
+// These are the names of the mechanisms, in the order of wakeType.
+static const char* wakeNames[WAKE_TYPES] = { "condvar", "futex", "eventfd", "pipe", "spin" };
+
+// This function returns the name of a mechanism.
+const char* wakeName(wakeType type)
+{
+	return ((type < WAKE_TYPES) ? wakeNames[type] : "unknown");
+}
+
+// This function reads a comma separated list of mechanism names. Names we
+// don't know and repeats are skipped.
+unsigned int wakeListFromNames(const char* names, wakeType* types)
+{
+	return readNameList(names, wakeNames, WAKE_TYPES, types);
+}
+
+// This function waits on a futex while it holds the given value.
+static void futexWait(volatile int* word, int value)
+{
+	syscall(SYS_futex, (int*)word, FUTEX_WAIT_PRIVATE, value, NULL, NULL, 0);
+}
+
+// This function wakes one thread waiting on a futex.
+static void futexWake(volatile int* word)
+{
+	syscall(SYS_futex, (int*)word, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+}
+
+// This is the constructor for the wakeChannel class.
+wakeChannel::wakeChannel(wakeType type)
+{
+	mechanism = type;
+	flag = 0;
+	fds[0] = fds[1] = -1;
+
+	switch(mechanism)
+	{
+		case WAKE_CONDVAR:
+			pthread_mutex_init(&mutex, NULL);
+			pthread_cond_init(&condition, NULL);
+			break;
+		case WAKE_EVENTFD:
+			fds[0] = fds[1] = eventfd(0, 0);
+			break;
+		case WAKE_PIPE:
+			if(pipe(fds) != 0)
+			{
+				fds[0] = fds[1] = -1;
+			}
+			break;
+		default:
+			break;
+	}
+}
+
+// This is the destructor for the wakeChannel class.
+wakeChannel::~wakeChannel(void)
+{
+	switch(mechanism)
+	{
+		case WAKE_CONDVAR:
+			pthread_cond_destroy(&condition);
+			pthread_mutex_destroy(&mutex);
+			break;
+		case WAKE_EVENTFD:
+			close(fds[0]);
+			break;
+		case WAKE_PIPE:
+			close(fds[0]);
+			close(fds[1]);
+			break;
+		default:
+			break;
+	}
+}
+
+// This function wakes up the thread waiting on the channel.
+void wakeChannel::signal(void)
+{
+	unsigned long long one = 1;
+	char token = 0;
+
+	switch(mechanism)
+	{
+		case WAKE_CONDVAR:
+			pthread_mutex_lock(&mutex);
+			flag = 1;
+			pthread_cond_signal(&condition);
+			pthread_mutex_unlock(&mutex);
+			break;
+		case WAKE_FUTEX:
+			__atomic_store_n(&flag, 1, __ATOMIC_RELEASE);
+			futexWake(&flag);
+			break;
+		case WAKE_EVENTFD:
+			if(write(fds[1], &one, sizeof(one)) != sizeof(one))
+			{
+				cout << "WARNING: eventfd write failed.\n";
+			}
+			break;
+		case WAKE_PIPE:
+			if(write(fds[1], &token, 1) != 1)
+			{
+				cout << "WARNING: pipe write failed.\n";
+			}
+			break;
+		case WAKE_SPIN:
+			__atomic_store_n(&flag, 1, __ATOMIC_RELEASE);
+			break;
+		default:
+			break;
+	}
+}
+
+// This function waits until the channel is signaled, and resets it.
+void wakeChannel::wait(void)
+{
+	unsigned long long count;
+	char token;
+
+	switch(mechanism)
+	{
+		case WAKE_CONDVAR:
+			pthread_mutex_lock(&mutex);
+			while(!flag)
+			{
+				pthread_cond_wait(&condition, &mutex);
+			}
+			flag = 0;
+			pthread_mutex_unlock(&mutex);
+			break;
+		case WAKE_FUTEX:
+			// Take the flag if it is set, otherwise sleep until it
+			// might be. The kernel only puts us to sleep if the flag
+			// is still zero, so a wake can't slip by.
+			while(__atomic_exchange_n(&flag, 0, __ATOMIC_ACQUIRE) == 0)
+			{
+				futexWait(&flag, 0);
+			}
+			break;
+		case WAKE_EVENTFD:
+			if(read(fds[0], &count, sizeof(count)) != sizeof(count))
+			{
+				cout << "WARNING: eventfd read failed.\n";
+			}
+			break;
+		case WAKE_PIPE:
+			if(read(fds[0], &token, 1) != 1)
+			{
+				cout << "WARNING: pipe read failed.\n";
+			}
+			break;
+		case WAKE_SPIN:
+			while(__atomic_exchange_n(&flag, 0, __ATOMIC_ACQUIRE) == 0)
+			{
+				cpuRelax();
+			}
+			break;
+		default:
+			break;
+	}
+}
+
+// This structure is everything one pair of threads shares.
+struct pingPongPair
+{
+	wakeChannel* toPong;		// Ping signals, pong waits.
+	wakeChannel* toPing;		// Pong signals, ping waits.
+	int pingCpu, pongCpu;		// CPUs to pin to, or -1.
+	bool pingPinned, pongPinned;	// Whether the pins took.
+	unsigned int rounds;		// Round trips to time.
+	latencyHistogram latencies;	// Round trip latencies.
+};
+
+// This function pins the calling thread to a CPU, if it is given one.
+// Returns false if it was given one and couldn't be pinned to it.
+static bool pinToCpu(int cpu)
+{
+	if(cpu < 0)
+	{
+		return true;
+	}
+
+	cpu_set_t cpus;
+	CPU_ZERO(&cpus);
+	CPU_SET(cpu, &cpus);
+
+	return (pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0);
+}
+
+// This is the function that the ping thread of a pair runs.
+static void* pingGenerator(void* pairObject)
+{
+	pingPongPair* pair = (pingPongPair*)pairObject;
+
+	pair->pingPinned = pinToCpu(pair->pingCpu);
+
+	for(unsigned int i = 0; i < (WARMUP_ROUNDS + pair->rounds); i++)
+	{
+		unsigned long long start = timeStamp::monotonicNsecs();
+
+		pair->toPong->signal();
+		pair->toPing->wait();
+
+		// The warm up rounds are not counted.
+		if(i >= WARMUP_ROUNDS)
+		{
+			pair->latencies.record(timeStamp::monotonicNsecs() - start);
+		}
+	}
+
+	return (NULL);
+}
+
+// This is the function that the pong thread of a pair runs.
+static void* pongGenerator(void* pairObject)
+{
+	pingPongPair* pair = (pingPongPair*)pairObject;
+
+	pair->pongPinned = pinToCpu(pair->pongCpu);
+
+	for(unsigned int i = 0; i < (WARMUP_ROUNDS + pair->rounds); i++)
+	{
+		pair->toPong->wait();
+		pair->toPing->signal();
+	}
+
+	return (NULL);
+}
+
+// This function runs the ping-pong test.
+void runPingPongTest(const char* filename, const wakeType* mechanisms, unsigned int mechanismCount,
+		     unsigned int pairs, unsigned int rounds, bool pinned, bool unpinned)
+{
+	// Create a temp filename to append the spreadsheet folder location
+	// in front of the desired filename.
+	string tempFilename = SPREADSHEET_FOLDER;
+	tempFilename += "/";
+	tempFilename += filename;
+
+	ofstream dataDump(tempFilename.c_str());
+
+	// Write the top line of the data file.
+	dataDump << "Mechanism,Pinned,Pairs,Rounds,Mean (ns),p50 (ns),p90 (ns),"
+		 << "p99 (ns),p99.9 (ns),Max (ns)\n";
+
+	// Find the CPUs that we are allowed on, which are the ones that we
+	// can pin to. They aren't always the first ones online.
+	vector<int> cpus;
+	cpu_set_t allowed;
+	if(sched_getaffinity(0, sizeof(allowed), &allowed) == 0)
+	{
+		for(int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+		{
+			if(CPU_ISSET(cpu, &allowed))
+			{
+				cpus.push_back(cpu);
+			}
+		}
+	}
+
+	if(cpus.empty() && pinned)
+	{
+		cout << "WARNING: The CPUs that we are allowed on could not be read, so nothing will be pinned.\n";
+	}
+
+	for(unsigned int m = 0; m < mechanismCount; m++)
+	{
+		// A spinning thread only gives up its CPU when the scheduler
+		// takes it away, so sharing a CPU costs a whole time slice.
+		if((mechanisms[m] == WAKE_SPIN) && (cpus.size() < 2*pairs))
+		{
+			cout << "WARNING: spin needs " << 2*pairs << " CPUs to be meaningful, "
+			     << "and there are only " << cpus.size() << ". Expect time slice latencies.\n";
+		}
+
+		// Do the pinned run and then the unpinned run, as asked.
+		for(unsigned int pinning = 0; pinning < 2; pinning++)
+		{
+			bool pin = (pinning == 0);
+
+			if((pin && !pinned) || (!pin && !unpinned))
+			{
+				continue;
+			}
+
+			pingPongPair* pairList = new pingPongPair[pairs];
+			pthread_t threads[2*pairs];
+
+			for(unsigned int p = 0; p < pairs; p++)
+			{
+				pairList[p].toPong = new wakeChannel(mechanisms[m]);
+				pairList[p].toPing = new wakeChannel(mechanisms[m]);
+				pairList[p].pingCpu = ((pin && !cpus.empty()) ? cpus[(2*p)%cpus.size()] : -1);
+				pairList[p].pongCpu = ((pin && !cpus.empty()) ? cpus[(2*p + 1)%cpus.size()] : -1);
+				pairList[p].pingPinned = pairList[p].pongPinned = false;
+				pairList[p].rounds = rounds;
+
+				pthread_create(&threads[2*p], NULL, pongGenerator, &pairList[p]);
+				pthread_create(&threads[2*p + 1], NULL, pingGenerator, &pairList[p]);
+			}
+
+			for(unsigned int i = 0; i < 2*pairs; i++)
+			{
+				pthread_join(threads[i], NULL);
+			}
+
+			// Put all the pairs together. The run only counts as pinned
+			// if every thread was pinned.
+			latencyHistogram* latencies = new latencyHistogram;
+			bool allPinned = !cpus.empty();
+
+			for(unsigned int p = 0; p < pairs; p++)
+			{
+				allPinned = allPinned && pairList[p].pingPinned && pairList[p].pongPinned;
+				latencies->merge(pairList[p].latencies);
+				delete pairList[p].toPong;
+				delete pairList[p].toPing;
+			}
+
+			const char* pinnedText = (pin ? (allPinned ? "yes" : "failed") : "no");
+
+			if(pin && !allPinned)
+			{
+				cout << "WARNING: Not every " << wakeName(mechanisms[m])
+				     << " thread could be pinned, so the pinned run is marked as failed.\n";
+			}
+
+			dataDump << wakeName(mechanisms[m]) << "," << pinnedText << ","
+				 << pairs << "," << rounds << "," << latencies->mean() << ","
+				 << latencies->percentile(50) << "," << latencies->percentile(90) << ","
+				 << latencies->percentile(99) << "," << latencies->percentile(99.9) << ","
+				 << latencies->maximum() << "\n";
+			dataDump.flush();
+
+			cout << wakeName(mechanisms[m]) << " (" << (pin ? (allPinned ? "pinned" : "pin failed") : "unpinned") << ")"
+			     << ": round trip p50 " << latencies->percentile(50)
+			     << " ns, p99 " << latencies->percentile(99) << " ns\n";
+
+			delete latencies;
+			delete [] pairList;
+		}
+	}
+
+	// Append an extra new line character to the end of the file.
+	dataDump << "\n";
+	dataDump.close();
+}
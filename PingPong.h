@@ -0,0 +1,74 @@
+// Author: Jason Tennyson
+// File: PingPong.h
+// Date: 10/19/26
+//
+// This file contains the definitions for the ping-pong test. The other
+// tests measure how fast threads crunch numbers. This one measures how fast
+// one thread can wake another one up. Threads are run in pairs, and each
+// pair passes a token back and forth using one of the wakeup mechanisms,
+// timing the round trip every time.
+
+#ifndef PingPong_h_
+#define PingPong_h_
+
+#include <pthread.h>
+
+#define DEFAULT_PAIRS		(1)				// Default number of thread pairs.
+#define MAX_PAIRS		(8)				// Maximum number of thread pairs.
+#define DEFAULT_ROUNDS		(100000)			// Default round trips per pair.
+#define MAX_ROUNDS		(100000000)			// Maximum round trips per pair.
+#define WARMUP_ROUNDS		(1000)				// Round trips that aren't timed.
+
+// These are the ways that one thread can wake up another one.
+enum wakeType
+{
+	WAKE_CONDVAR = 0,	// pthread_cond_signal with a mutex and a flag.
+	WAKE_FUTEX,		// A raw futex wake on a flag.
+	WAKE_EVENTFD,		// A write to an eventfd.
+	WAKE_PIPE,		// A byte through a pipe.
+	WAKE_SPIN,		// Busy polling an atomic flag.
+	WAKE_TYPES		// The number of mechanisms.
+};
+
+// This function returns the name of a mechanism.
+const char* wakeName(wakeType type);
+
+// This function reads a comma separated list of mechanism names into
+// types, which must have room for WAKE_TYPES entries. Returns the count.
+unsigned int wakeListFromNames(const char* names, wakeType* types);
+
+// This class is one direction of a ping-pong: one thread waits on it
+// and the other one signals it.
+class wakeChannel
+{
+	public:
+		// This is the class constructor. It sets up the mechanism.
+		wakeChannel(wakeType type);
+		// This is the class destructor.
+		~wakeChannel(void);
+
+		// This function wakes up the thread waiting on the channel.
+		void signal(void);
+
+		// This function waits until the channel is signaled.
+		void wait(void);
+
+	private:
+		// The mechanism in use.
+		wakeType mechanism;
+		// The flag used by the condition variable, futex and spin.
+		volatile int flag;
+		// The condition variable and its mutex.
+		pthread_mutex_t mutex;
+		pthread_cond_t condition;
+		// The file descriptors of the eventfd or the pipe.
+		int fds[2];
+};
+
+// This function runs the ping-pong test for every mechanism, pinned and
+// unpinned as asked, and saves the round trip latencies to filename in
+// the spreadsheet folder.
+void runPingPongTest(const char* filename, const wakeType* mechanisms, unsigned int mechanismCount,
+		     unsigned int pairs, unsigned int rounds, bool pinned, bool unpinned);
+
+#endif
@@ -0,0 +1,116 @@
+// Author: Jason Tennyson
+// File: ProcessMode.cpp
+// Date: 10/19/26
+//
+// This file contains the implementation of the shared memory segment and the
+// TLB counter used when the calculations run in processes. The TLB misses
+// come from perf_event_open, which is often turned off for regular users
+// (see /proc/sys/kernel/perf_event_paranoid), so they are optional.
+
+#include "ProcessMode.h"
+#include <cstring>
+#include <cstdio>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+// This function creates the shared memory segment.
+processSegment* createProcessSegment(void)
+{
+	// The name only has to be unique for as long as it exists.
+	char name[64];
+	snprintf(name, sizeof(name), "/ThreadTutorial.%d", (int)getpid());
+
+	int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+	if(fd < 0)
+	{
+		return NULL;
+	}
+
+	// The mapping keeps the segment alive, so the name can go now.
+	shm_unlink(name);
+
+	if(ftruncate(fd, sizeof(processSegment)) != 0)
+	{
+		close(fd);
+		return NULL;
+	}
+
+	void* memory = mmap(NULL, sizeof(processSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if(memory == MAP_FAILED)
+	{
+		return NULL;
+	}
+
+	processSegment* segment = (processSegment*)memory;
+	memset(segment, 0, sizeof(processSegment));
+
+	// A mutex has to be told that it will be shared between processes.
+	pthread_mutexattr_t attributes;
+	pthread_mutexattr_init(&attributes);
+	pthread_mutexattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);
+	pthread_mutex_init(&segment->mutex, &attributes);
+	pthread_mutexattr_destroy(&attributes);
+
+	return segment;
+}
+
+// This function unmaps the shared memory segment.
+void destroyProcessSegment(processSegment* segment)
+{
+	if(segment)
+	{
+		pthread_mutex_destroy(&segment->mutex);
+		munmap(segment, sizeof(processSegment));
+	}
+}
+
+// This function starts counting data TLB misses.
+int startTlbCounter(void)
+{
+	struct perf_event_attr attributes;
+
+	memset(&attributes, 0, sizeof(attributes));
+	attributes.size = sizeof(attributes);
+	attributes.type = PERF_TYPE_HW_CACHE;
+	attributes.config = PERF_COUNT_HW_CACHE_DTLB |
+			    (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+			    (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+	attributes.exclude_kernel = 1;
+	attributes.exclude_hv = 1;
+
+	int counter = syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0);
+
+	if(counter >= 0)
+	{
+		ioctl(counter, PERF_EVENT_IOC_RESET, 0);
+		ioctl(counter, PERF_EVENT_IOC_ENABLE, 0);
+	}
+
+	return counter;
+}
+
+// This function reads and closes a TLB miss counter.
+unsigned long long stopTlbCounter(int counter)
+{
+	unsigned long long misses = 0;
+
+	if(counter >= 0)
+	{
+		ioctl(counter, PERF_EVENT_IOC_DISABLE, 0);
+
+		if(read(counter, &misses, sizeof(misses)) != sizeof(misses))
+		{
+			misses = 0;
+		}
+
+		close(counter);
+	}
+
+	return misses;
+}
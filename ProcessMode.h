@@ -0,0 +1,47 @@
+// Author: Jason Tennyson
+// File: ProcessMode.h
+// Date: 10/19/26
+//
+// This file contains the definitions for running the calculations in
+// processes instead of threads. Threads share all of their memory for free,
+// but forked processes only share what is put in shared memory on purpose.
+// The processSegment structure is that shared memory: it holds the shared
+// variable, a mutex that works between processes, and a spot for every
+// process to hand back its result and its counters.
+
+#ifndef ProcessMode_h_
+#define ProcessMode_h_
+
+#include <pthread.h>
+
+#define MAX_PROCESSES		(16)				// Most processes in one cell.
+#define PROCESS_EXTENSION	("_processes.csv")		// Ending of the per process file.
+
+// This structure is laid out in the shared memory segment.
+struct processSegment
+{
+	pthread_mutex_t mutex;				// Works across processes.
+	unsigned int sharedVariable;			// The variable they fight over.
+	unsigned int results[MAX_PROCESSES];		// Each process's unshared total.
+	unsigned long long tlbMisses[MAX_PROCESSES];	// Data TLB misses per process.
+	int tlbCounted[MAX_PROCESSES];			// Whether the misses were counted.
+};
+
+// This function creates a shared memory segment with shm_open, maps it,
+// and sets up the process shared mutex. The name is unlinked right away,
+// so the segment goes away with the last process that has it mapped.
+// Returns NULL if it can't.
+processSegment* createProcessSegment(void);
+
+// This function unmaps a segment made by createProcessSegment.
+void destroyProcessSegment(processSegment* segment);
+
+// This function starts counting the data TLB misses of the calling
+// process. It returns a counter to read later, or -1 if the kernel won't
+// let us count them.
+int startTlbCounter(void);
+
+// This function reads and closes a counter from startTlbCounter.
+unsigned long long stopTlbCounter(int counter);
+
+#endif
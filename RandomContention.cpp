@@ -0,0 +1,208 @@
+// Author: Jason Tennyson
+// File: RandomContention.cpp
+// Date: 10/19/26
+//
+// This file contains the implementation of the random number test. Each
+// thread adds up what it draws and hands the total back, so the compiler
+// can't throw the draws away. The generators are picked outside of the draw
+// loop, so the only difference between them is the generator itself.
+
+#include "RandomContention.h"
+#include "NameList.h"
+#include "FastRandom.h"
+#include "ThreadTutorial.h"
+#include "SyntheticWork.h"
+#include "TimedRun.h"
+#include "Workload.h"
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+// These are the names of the generators, in the order of randomType.
+static const char* randomNames[RANDOM_TYPES] = { "xoshiro", "random_r", "rand", "shared_r" };
+
+// This structure is one thread's generator state and what it drew.
+struct randomSlot
+{
+	unsigned int index;			// Index of the thread.
+	unsigned long long ops;			// Numbers drawn.
+	unsigned long long sum;			// What they added up to.
+	struct random_data data;		// This thread's random_r state.
+	char state[RANDOM_STATE_BYTES];		// The table random_r uses.
+	char pad[CACHE_LINE_SIZE];
+};
+
+// These are the generator being tested, and the state that the shared
+// generators keep for every thread.
+static randomType randomKind;
+static unsigned long long randomParLoops;
+static pthread_mutex_t sharedMutex;
+static struct random_data sharedData;
+static char sharedState[RANDOM_STATE_BYTES];
+
+// This function returns the name of a generator.
+const char* randomName(randomType type)
+{
+	return ((type < RANDOM_TYPES) ? randomNames[type] : "unknown");
+}
+
+// This function reads a comma separated list of generator names. Names we
+// don't know and repeats are skipped.
+unsigned int randomListFromNames(const char* names, randomType* types)
+{
+	return readNameList(names, randomNames, RANDOM_TYPES, types);
+}
+
+// This function draws one chunk of numbers from the generator that is being
+// tested and returns what they added up to.
+static unsigned long long drawChunk(randomSlot* slot)
+{
+	unsigned long long sum = 0;
+	int32_t value;
+
+	switch(randomKind)
+	{
+		case RANDOM_RANDOM_R:
+			for(unsigned int i = 0; i < RANDOM_CHUNK; i++)
+			{
+				random_r(&slot->data, &value);
+				sum += value;
+				doSyntheticWork(randomParLoops);
+			}
+			break;
+		case RANDOM_RAND:
+			for(unsigned int i = 0; i < RANDOM_CHUNK; i++)
+			{
+				sum += rand();
+				doSyntheticWork(randomParLoops);
+			}
+			break;
+		case RANDOM_SHARED_R:
+			for(unsigned int i = 0; i < RANDOM_CHUNK; i++)
+			{
+				pthread_mutex_lock(&sharedMutex);
+				random_r(&sharedData, &value);
+				pthread_mutex_unlock(&sharedMutex);
+				sum += value;
+				doSyntheticWork(randomParLoops);
+			}
+			break;
+		default:
+			for(unsigned int i = 0; i < RANDOM_CHUNK; i++)
+			{
+				sum += threadRandom()->next();
+				doSyntheticWork(randomParLoops);
+			}
+			break;
+	}
+
+	return sum;
+}
+
+// This is the function that each thread runs during the random number test.
+static void* randomGenerator(void* slotObject)
+{
+	randomSlot* slot = (randomSlot*)slotObject;
+
+	timedRunBegin();
+
+	while(!timedRunOver())
+	{
+		slot->sum += drawChunk(slot);
+		slot->ops += RANDOM_CHUNK;
+	}
+
+	return (NULL);
+}
+
+// This function runs the random number test.
+void runRandomTest(const char* filename, const randomType* generators, unsigned int generatorCount,
+		   unsigned int maxThreads, unsigned int cellMsecs, unsigned int parNsecs)
+{
+	// Create a temp filename to append the spreadsheet folder location
+	// in front of the desired filename.
+	string tempFilename = SPREADSHEET_FOLDER;
+	tempFilename += "/";
+	tempFilename += filename;
+
+	ofstream dataDump(tempFilename.c_str());
+
+	// Write the top line of the data file.
+	dataDump << "Generator,Shared,Parallel (ns)";
+	for(unsigned int t = MIN_THREADS; t <= maxThreads; t++)
+	{
+		dataDump << ",Ops/Sec " << t;
+	}
+	dataDump << ",Scaling\n";
+
+	randomParLoops = workLoopsFor(parNsecs);
+	pthread_mutex_init(&sharedMutex, NULL);
+
+	for(unsigned int g = 0; g < generatorCount; g++)
+	{
+		randomKind = generators[g];
+		bool shared = (randomKind == RANDOM_RAND) || (randomKind == RANDOM_SHARED_R);
+		double firstRate = 0, rate = 0;
+
+		dataDump << randomName(randomKind) << "," << (shared ? "yes" : "no") << "," << parNsecs;
+
+		for(unsigned int threadNo = MIN_THREADS; threadNo <= maxThreads; threadNo++)
+		{
+			// Start every run from the same seeds.
+			srand(LIBC_RANDOM_SEED);
+			memset(&sharedData, 0, sizeof(sharedData));
+			initstate_r(LIBC_RANDOM_SEED, sharedState, RANDOM_STATE_BYTES, &sharedData);
+
+			randomSlot* slots = allocateThreadSlots<randomSlot>(threadNo);
+			if(!slots)
+			{
+				break;
+			}
+
+			for(unsigned int i = 0; i < threadNo; i++)
+			{
+				slots[i].index = i;
+				initstate_r(LIBC_RANDOM_SEED + i, slots[i].state, RANDOM_STATE_BYTES, &slots[i].data);
+			}
+
+			double elapsedSecs;
+			if(!runTimedThreads(randomGenerator, slots, sizeof(randomSlot), threadNo, cellMsecs,
+					    &elapsedSecs, NULL, NULL, 0))
+			{
+				cout << "Could not create the threads!\n";
+				freeThreadSlots(slots);
+				break;
+			}
+
+			unsigned long long totalOps = 0;
+			for(unsigned int i = 0; i < threadNo; i++)
+			{
+				totalOps += slots[i].ops;
+			}
+
+			rate = totalOps/elapsedSecs;
+			if(threadNo == MIN_THREADS)
+			{
+				firstRate = rate;
+			}
+
+			dataDump << "," << (unsigned long long)rate;
+
+			cout << randomName(randomKind) << ": " << threadNo << " threads, "
+			     << (unsigned long long)rate << " draws/sec\n";
+
+			freeThreadSlots(slots);
+		}
+
+		// How much faster the most threads were than one thread.
+		dataDump << "," << ((firstRate > 0) ? rate/firstRate : 0) << "\n";
+		dataDump.flush();
+	}
+
+	pthread_mutex_destroy(&sharedMutex);
+
+	// Append an extra new line character to the end of the file.
+	dataDump << "\n";
+	dataDump.close();
+}
@@ -0,0 +1,52 @@
+// Author: Jason Tennyson
+// File: RandomContention.h
+// Date: 10/19/26
+//
+// This file contains the definitions for the random number test. Code that
+// calls rand() from several threads looks like it has nothing shared, but
+// rand() keeps its state in one place and glibc locks it, so the threads
+// take turns. This test has every thread draw random numbers as fast as it
+// can, with some synthetic work between draws if asked, from four kinds of
+// generators:
+//
+//	xoshiro		This thread's own fastRandom, from threadRandom().
+//	random_r	The C library's random_r() with a state per thread.
+//	rand		The C library's rand(), which every thread shares.
+//	shared_r	One random_r() state behind a mutex, which is what a
+//			program does when it shares one generator on purpose.
+//
+// The first two should scale with the threads, and the last two shouldn't.
+
+#ifndef RandomContention_h_
+#define RandomContention_h_
+
+#define DEFAULT_RANDOM_MSECS	(200)				// Default time per cell (ms).
+#define MAX_RANDOM_MSECS	(60000)				// Maximum time per cell (ms).
+#define RANDOM_CHUNK		(256)				// Draws between flag checks.
+#define RANDOM_STATE_BYTES	(128)				// State for random_r, like random().
+#define LIBC_RANDOM_SEED	(12345)				// Seed for rand() and random_r().
+
+// These are the generators that can be compared.
+enum randomType
+{
+	RANDOM_XOSHIRO = 0,	// A fastRandom per thread.
+	RANDOM_RANDOM_R,	// random_r with a state per thread.
+	RANDOM_RAND,		// The shared rand().
+	RANDOM_SHARED_R,	// One random_r state behind a mutex.
+	RANDOM_TYPES		// The number of generators.
+};
+
+// This function returns the name of a generator.
+const char* randomName(randomType type);
+
+// This function reads a comma separated list of generator names into types,
+// which must have room for RANDOM_TYPES entries. Returns the count.
+unsigned int randomListFromNames(const char* names, randomType* types);
+
+// This function runs every generator with 1 up to maxThreads threads for
+// cellMsecs each, with parNsecs of synthetic work between draws, and saves
+// the draws per second to filename in the spreadsheet folder.
+void runRandomTest(const char* filename, const randomType* generators, unsigned int generatorCount,
+		   unsigned int maxThreads, unsigned int cellMsecs, unsigned int parNsecs);
+
+#endif
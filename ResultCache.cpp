@@ -0,0 +1,218 @@
+// Author: Jason Tennyson
+// File: ResultCache.cpp
+// Date: 10/19/26
+//
+// This file contains the function definitions for the resultCache class.
+// Every cell is one line of tab separated text:
+//
+//	fingerprint	key	time	result	ok
+//
+// A line is only trusted if it ends with the "ok" marker, so a line that
+// was cut off when the program was killed is simply ignored. Lines are
+// appended with a single write and synced to disk before we move on.
+
+#include "ResultCache.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/utsname.h>
+#include <gnu/libc-version.h>
+
+using namespace std;
+
+// This function hashes a block of bytes with 64 bit FNV-1a.
+static unsigned long long fnvHash(const char* data, size_t length, unsigned long long hash)
+{
+	for(size_t i = 0; i < length; i++)
+	{
+		hash ^= (unsigned char)data[i];
+		hash *= 1099511628211ULL;
+	}
+
+	return hash;
+}
+
+// This is the constructor for the resultCache class.
+resultCache::resultCache(void)
+{
+	fd = -1;
+	hits = 0;
+}
+
+// This is the destructor for the resultCache class.
+resultCache::~resultCache(void)
+{
+	if(fd >= 0)
+	{
+		close(fd);
+	}
+}
+
+// This function builds the fingerprint of this machine and this binary.
+// It covers the CPU model, the number of online CPUs, the kernel, the C
+// library, and a hash of the executable itself. The binary is linked to
+// the C library at run time, so a libc upgrade (which can change how fast
+// a mutex is) doesn't change the binary's hash.
+void resultCache::buildFingerprint(void)
+{
+	string cpuModel = "unknown";
+	string line;
+
+	// Find the CPU model name.
+	ifstream cpuInfo("/proc/cpuinfo");
+	while(getline(cpuInfo, line))
+	{
+		if((line.compare(0, 10, "model name") == 0) || (line.compare(0, 9, "cpu model") == 0))
+		{
+			cpuModel = line.substr(line.find(':') + 1);
+			break;
+		}
+	}
+
+	// Find the kernel release and version.
+	struct utsname kernel;
+	uname(&kernel);
+
+	// Hash the binary we are running.
+	unsigned long long binaryHash = 14695981039346656037ULL;
+	ifstream binary("/proc/self/exe", ios::binary);
+	char buffer[65536];
+	while(binary.read(buffer, sizeof(buffer)) || binary.gcount())
+	{
+		binaryHash = fnvHash(buffer, binary.gcount(), binaryHash);
+	}
+
+	// Put it all together.
+	stringstream description;
+	description << "cpu=" << cpuModel
+		    << ";cores=" << sysconf(_SC_NPROCESSORS_ONLN)
+		    << ";kernel=" << kernel.release << " " << kernel.version
+		    << ";libc=" << gnu_get_libc_version()
+		    << ";binary=" << binaryHash;
+
+	// Boil the description down to one short hex string.
+	char hex[17];
+	string text = description.str();
+	snprintf(hex, sizeof(hex), "%016llx", fnvHash(text.c_str(), text.size(), 14695981039346656037ULL));
+	machine = hex;
+}
+
+// This function opens the cache file and loads the cells that belong to
+// this machine and binary if we are allowed to reuse them.
+bool resultCache::open(const char* path, bool reuse)
+{
+	buildFingerprint();
+
+	if(reuse)
+	{
+		ifstream cacheFile(path);
+		string line;
+
+		while(getline(cacheFile, line))
+		{
+			// Split the line on tabs.
+			string fields[5];
+			unsigned int count = 0;
+			size_t start = 0;
+			size_t tab;
+
+			while((count < 5) && ((tab = line.find('\t', start)) != string::npos))
+			{
+				fields[count++] = line.substr(start, tab - start);
+				start = tab + 1;
+			}
+			if(count < 5)
+			{
+				fields[count++] = line.substr(start);
+			}
+
+			// Only trust complete lines from this machine.
+			if((count == 5) && (fields[4] == CACHE_END_MARKER) && (fields[0] == machine))
+			{
+				cachedCell cell;
+				cell.time = strtoul(fields[2].c_str(), NULL, 10);
+				cell.result = strtof(fields[3].c_str(), NULL);
+
+				// Later lines win over earlier ones.
+				cells[fields[1]] = cell;
+			}
+		}
+	}
+
+	// Open the file for appending, creating it if it is not there.
+	fd = ::open(path, O_WRONLY | O_APPEND | O_CREAT, 0644);
+
+	if(fd < 0)
+	{
+		return false;
+	}
+
+	// If the last line was cut off, end it so the next line starts clean.
+	off_t size = lseek(fd, 0, SEEK_END);
+	if(size > 0)
+	{
+		char last = '\n';
+		int readFd = ::open(path, O_RDONLY);
+
+		if((readFd >= 0) && (pread(readFd, &last, 1, size - 1) == 1) && (last != '\n'))
+		{
+			if(write(fd, "\n", 1) != 1)
+			{
+				cout << "WARNING: Could not repair the result cache.\n";
+			}
+		}
+
+		if(readFd >= 0)
+		{
+			close(readFd);
+		}
+	}
+
+	return true;
+}
+
+// This function looks up a cell by its configuration key.
+bool resultCache::lookup(const string& key, cachedCell* cell)
+{
+	map<string, cachedCell>::iterator found = cells.find(key);
+
+	if(found == cells.end())
+	{
+		return false;
+	}
+
+	*cell = found->second;
+	hits++;
+	return true;
+}
+
+// This function appends a finished cell to the cache file.
+void resultCache::store(const string& key, const cachedCell& cell)
+{
+	// Remember it ourselves in case it comes up again this run.
+	cells[key] = cell;
+
+	if(fd < 0)
+	{
+		return;
+	}
+
+	// Build the whole line first so it goes out in a single write.
+	stringstream line;
+	line << machine << "\t" << key << "\t" << cell.time << "\t" << cell.result
+	     << "\t" << CACHE_END_MARKER << "\n";
+
+	string text = line.str();
+
+	// Write it and make sure it made it to the disk.
+	if(write(fd, text.c_str(), text.size()) != (ssize_t)text.size())
+	{
+		cout << "WARNING: Could not write to the result cache.\n";
+	}
+
+	fdatasync(fd);
+}
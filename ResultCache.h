@@ -0,0 +1,69 @@
+// Author: Jason Tennyson
+// File: ResultCache.h
+// Date: 10/19/26
+//
+// This file contains the class definition for the resultCache class. The
+// cache keeps every finished cell of an automatic test in a file, so that
+// a sweep that gets interrupted can pick up where it left off, and so that
+// cells that were already measured with the same configuration, the same
+// binary and the same machine are reused instead of measured again.
+
+#ifndef ResultCache_h_
+#define ResultCache_h_
+
+#include <string>
+#include <map>
+
+#define CACHE_FILENAME		("ResultCache.txt")		// Name of the cache file.
+#define CACHE_END_MARKER	("ok")				// Marks a complete line.
+
+// This structure is one cached cell.
+struct cachedCell
+{
+	unsigned int time;	// Time taken in microseconds.
+	float result;		// The end result of the cell.
+};
+
+// This class loads, looks up and appends cached cells.
+class resultCache
+{
+	public:
+		// This is the class constructor.
+		resultCache(void);
+		// This is the class destructor. It closes the cache file.
+		~resultCache(void);
+
+		// This function opens the cache file at path. If reuse is set,
+		// the cells recorded on this machine with this binary are
+		// loaded so that they can be looked up. Returns false if the
+		// file could not be opened.
+		bool open(const char* path, bool reuse);
+
+		// This function looks up a cell by its configuration key.
+		bool lookup(const std::string& key, cachedCell* cell);
+
+		// This function appends a finished cell to the cache file and
+		// makes sure it is on disk before returning.
+		void store(const std::string& key, const cachedCell& cell);
+
+		// This function returns the number of cells that were reused.
+		unsigned int reusedCells(void) { return hits; }
+
+		// This function returns the machine fingerprint in use.
+		const std::string& fingerprint(void) { return machine; }
+
+	private:
+		// The file descriptor of the cache file.
+		int fd;
+		// The number of successful lookups.
+		unsigned int hits;
+		// The fingerprint of this machine and binary.
+		std::string machine;
+		// The cells loaded from the file, by configuration key.
+		std::map<std::string, cachedCell> cells;
+
+		// This function builds the machine fingerprint.
+		void buildFingerprint(void);
+};
+
+#endif
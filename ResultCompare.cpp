@@ -0,0 +1,484 @@
+// Author: Jason Tennyson
+// File: ResultCompare.cpp
+// Date: 10/19/26
+//
+// This file contains the implementation of the compare mode. The U test is
+// exact (the p value comes from counting every way the ranks could have
+// fallen) when neither side has more than EXACT_U_LIMIT times and no two
+// times are the same. Otherwise it uses the normal approximation, corrected
+// for ties. A cell needs at least two times on each side to be tested at
+// all, and with two and two, the smallest p value there is is 1/3, so it
+// takes about five repetitions a side to find anything.
+//
+// The effect sizes are the change in the median time, and Cliff's delta:
+// the chance that a candidate time is slower than a baseline time, minus
+// the chance that it is faster. It goes from -1 (every candidate time is
+// faster) to 1 (every one is slower).
+
+#include "ResultCompare.h"
+#include "ResultsFile.h"
+#include "ThreadTutorial.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <vector>
+
+using namespace std;
+
+// This structure holds the times of one configuration from both files.
+struct compareCell
+{
+	vector<double> base;		// Baseline times.
+	vector<double> candidate;	// Candidate times.
+	float baseResult;		// Worst baseline result.
+	float candidateResult;		// Worst candidate result.
+	double p;			// The p value, or 2 if untested.
+	double q;			// The adjusted p value.
+	double change;			// Change in the median time (%).
+	double delta;			// Cliff's delta.
+};
+
+// This function returns the median of a list of times.
+static double median(vector<double> times)
+{
+	sort(times.begin(), times.end());
+
+	unsigned int middle = times.size()/2;
+	return ((times.size()%2) ? times[middle] : (times[middle - 1] + times[middle])/2);
+}
+
+// This function reads every row of a results file into cells, keyed by the
+// columns other than the time and the result. The key columns are returned
+// in keyColumns, or checked against it if it already has some.
+static bool loadCells(const char* path, map<string, compareCell>& cells, bool candidate,
+		      vector<string>& keyColumns)
+{
+	resultsReader reader;
+
+	if(!reader.open(path))
+	{
+		cout << path << " is not a results file that we can read!\n";
+		return false;
+	}
+
+	// Find the time and result columns. Everything else is configuration.
+	int timeColumn = -1, resultColumn = -1;
+	vector<unsigned int> keys;
+	vector<string> names;
+
+	for(unsigned int c = 0; c < reader.columnCount(); c++)
+	{
+		if(strcmp(reader.columnName(c), COMPARE_TIME_COLUMN) == 0)
+		{
+			timeColumn = c;
+		}
+		else if(strcmp(reader.columnName(c), COMPARE_RESULT_COLUMN) == 0)
+		{
+			resultColumn = c;
+		}
+		else
+		{
+			keys.push_back(c);
+			names.push_back(reader.columnName(c));
+		}
+	}
+
+	if(timeColumn < 0)
+	{
+		cout << path << " has no " << COMPARE_TIME_COLUMN << " column!\n";
+		return false;
+	}
+
+	if(keyColumns.empty())
+	{
+		keyColumns = names;
+	}
+	else if(keyColumns != names)
+	{
+		cout << path << " does not have the same columns as the baseline!\n";
+		return false;
+	}
+
+	for(unsigned int b = 0; b < reader.blockCount(); b++)
+	{
+		for(unsigned int r = 0; r < reader.blockRows(b); r++)
+		{
+			stringstream key;
+
+			for(unsigned int k = 0; k < keys.size(); k++)
+			{
+				// Whole numbers are written out in full, so that a
+				// big n doesn't turn into 1e+06.
+				double value = reader.value(b, r, keys[k]);
+				key << (k ? " " : "") << names[k] << "=";
+				if((value == floor(value)) && (fabs(value) < 1e18))
+				{
+					key << (long long)value;
+				}
+				else
+				{
+					key << value;
+				}
+			}
+
+			// A new cell starts out with nothing wrong on either side.
+			map<string, compareCell>::iterator found = cells.find(key.str());
+			if(found == cells.end())
+			{
+				compareCell cell;
+				cell.baseResult = cell.candidateResult = 1.0f;
+				cell.p = cell.q = 2;
+				cell.change = cell.delta = 0;
+				found = cells.insert(make_pair(key.str(), cell)).first;
+			}
+
+			compareCell& cell = found->second;
+			float result = (resultColumn < 0) ? 1.0f : (float)reader.value(b, r, resultColumn);
+
+			if(candidate)
+			{
+				cell.candidate.push_back(reader.value(b, r, timeColumn));
+				cell.candidateResult = (result < cell.candidateResult) ? result : cell.candidateResult;
+			}
+			else
+			{
+				cell.base.push_back(reader.value(b, r, timeColumn));
+				cell.baseResult = (result < cell.baseResult) ? result : cell.baseResult;
+			}
+		}
+	}
+
+	return true;
+}
+
+// This function returns the two sided p value of the exact U test with no
+// ties, for u from samples of m and n. It counts how many orderings of the
+// two samples give every value of U.
+static double exactU(double u, unsigned int m, unsigned int n)
+{
+	// ways[i][j][k] is how many orderings of i and j values give U = k.
+	// Only the last row of i is kept.
+	unsigned int most = m*n;
+	vector< vector<double> > previous(n + 1, vector<double>(most + 1, 0));
+	vector< vector<double> > current(n + 1, vector<double>(most + 1, 0));
+
+	for(unsigned int j = 0; j <= n; j++)
+	{
+		previous[j][0] = 1;
+	}
+
+	for(unsigned int i = 1; i <= m; i++)
+	{
+		current[0].assign(most + 1, 0);
+		current[0][0] = 1;
+
+		for(unsigned int j = 1; j <= n; j++)
+		{
+			// The biggest value is either from the first sample, and
+			// beats all j of the second, or from the second.
+			for(unsigned int k = 0; k <= most; k++)
+			{
+				current[j][k] = current[j - 1][k] + ((k >= j) ? previous[j][k - j] : 0);
+			}
+		}
+
+		previous.swap(current);
+	}
+
+	double total = 0, below = 0, above = 0;
+	for(unsigned int k = 0; k <= most; k++)
+	{
+		total += previous[n][k];
+		below += (k <= u) ? previous[n][k] : 0;
+		above += (k >= u) ? previous[n][k] : 0;
+	}
+
+	double p = 2*((below < above) ? below : above)/total;
+	return ((p > 1) ? 1 : p);
+}
+
+// This function runs the Mann-Whitney U test on the baseline and candidate
+// times of a cell, and fills in its p value and Cliff's delta.
+static void mannWhitney(compareCell* cell)
+{
+	unsigned int m = cell->base.size();
+	unsigned int n = cell->candidate.size();
+
+	// Rank every time together. The first m are the baseline.
+	vector< pair<double, unsigned int> > all;
+	for(unsigned int i = 0; i < m; i++)
+	{
+		all.push_back(make_pair(cell->base[i], i));
+	}
+	for(unsigned int j = 0; j < n; j++)
+	{
+		all.push_back(make_pair(cell->candidate[j], m + j));
+	}
+	sort(all.begin(), all.end());
+
+	// Tied times share the average of their ranks.
+	double baseRanks = 0, tieSum = 0;
+	bool ties = false;
+
+	for(unsigned int i = 0; i < all.size(); )
+	{
+		unsigned int end = i;
+		while(((end + 1) < all.size()) && (all[end + 1].first == all[i].first))
+		{
+			end++;
+		}
+
+		double rank = (i + end)/2.0 + 1;
+		double tied = end - i + 1;
+
+		for(unsigned int k = i; k <= end; k++)
+		{
+			if(all[k].second < m)
+			{
+				baseRanks += rank;
+			}
+		}
+
+		ties = ties || (tied > 1);
+		tieSum += tied*tied*tied - tied;
+		i = end + 1;
+	}
+
+	// U for the baseline counts the pairs where the baseline is slower.
+	double u = baseRanks - m*(m + 1)/2.0;
+	double pairs = (double)m*n;
+
+	cell->delta = (pairs - 2*u)/pairs;
+
+	if(!ties && (m <= EXACT_U_LIMIT) && (n <= EXACT_U_LIMIT))
+	{
+		cell->p = exactU(u, m, n);
+		return;
+	}
+
+	double total = m + n;
+	double variance = pairs/12*((total + 1) - tieSum/(total*(total - 1)));
+
+	if(variance <= 0)
+	{
+		cell->p = 1;
+		return;
+	}
+
+	double z = (fabs(u - pairs/2) - 0.5)/sqrt(variance);
+	cell->p = (z > 0) ? erfc(z/sqrt(2.0)) : 1;
+}
+
+// This function orders cells by p value.
+static bool smallerP(const compareCell* a, const compareCell* b)
+{
+	return (a->p < b->p);
+}
+
+// This function orders cells by change in the median time, slowest first.
+static bool biggerChange(const pair<string, compareCell*>& a, const pair<string, compareCell*>& b)
+{
+	return (a.second->change > b.second->change);
+}
+
+// This function runs the compare mode.
+int compareResults(const char* basePath, const char* candidatePath, const char* filename,
+		   unsigned int alphaPercent, unsigned int thresholdPercent)
+{
+	map<string, compareCell> cells;
+	vector<string> keyColumns;
+
+	if(!loadCells(basePath, cells, false, keyColumns) ||
+	   !loadCells(candidatePath, cells, true, keyColumns))
+	{
+		return -1;
+	}
+
+	// Test every cell that has enough times on both sides.
+	vector<compareCell*> tested;
+	unsigned int onlyBase = 0, onlyCandidate = 0;
+
+	for(map<string, compareCell>::iterator i = cells.begin(); i != cells.end(); i++)
+	{
+		compareCell& cell = i->second;
+
+		if(cell.candidate.empty())
+		{
+			onlyBase++;
+			continue;
+		}
+		if(cell.base.empty())
+		{
+			onlyCandidate++;
+			continue;
+		}
+
+		double baseMedian = median(cell.base);
+		cell.change = (baseMedian > 0) ? 100.0*(median(cell.candidate)/baseMedian - 1) : 0;
+
+		if((cell.base.size() >= 2) && (cell.candidate.size() >= 2))
+		{
+			mannWhitney(&cell);
+			tested.push_back(&cell);
+		}
+	}
+
+	// Adjust the p values for the number of cells tested (Benjamini-
+	// Hochberg). Going from the biggest p down, each q is the smallest
+	// of p*tests/rank over that rank and every one after it.
+	sort(tested.begin(), tested.end(), smallerP);
+
+	double smallest = 1;
+	for(unsigned int i = tested.size(); i > 0; i--)
+	{
+		double q = tested[i - 1]->p*tested.size()/i;
+		smallest = (q < smallest) ? q : smallest;
+		tested[i - 1]->q = smallest;
+	}
+
+	// Create a temp filename to append the spreadsheet folder location
+	// in front of the desired filename.
+	string tempFilename = SPREADSHEET_FOLDER;
+	tempFilename += "/";
+	tempFilename += filename;
+
+	ofstream dataDump(tempFilename.c_str());
+
+	// Write the top line of the data file.
+	for(unsigned int k = 0; k < keyColumns.size(); k++)
+	{
+		dataDump << keyColumns[k] << ",";
+	}
+	dataDump << "Base Samples,Candidate Samples,Base Median,Candidate Median,Change (%),"
+		 << "Cliff's Delta,p,q,Base Result,Candidate Result,Verdict\n";
+
+	double alpha = alphaPercent/100.0;
+	unsigned int faster = 0, slower = 0, regressions = 0, untested = 0;
+	vector< pair<string, compareCell*> > significant;
+
+	for(map<string, compareCell>::iterator i = cells.begin(); i != cells.end(); i++)
+	{
+		compareCell& cell = i->second;
+
+		if(cell.base.empty() || cell.candidate.empty())
+		{
+			continue;
+		}
+
+		// Work out what happened to the cell.
+		const char* verdict = "same";
+		bool wrong = (cell.candidateResult < 1.0f) && (cell.baseResult >= 1.0f);
+
+		if(wrong)
+		{
+			verdict = "wrong";
+			regressions++;
+			significant.push_back(make_pair(i->first, &cell));
+		}
+		else if(cell.p > 1)
+		{
+			verdict = "too few samples";
+			untested++;
+		}
+		else if(cell.q < alpha)
+		{
+			if(cell.change > thresholdPercent)
+			{
+				verdict = "regression";
+				regressions++;
+			}
+			else if(cell.change > 0)
+			{
+				verdict = "slower";
+				slower++;
+			}
+			else
+			{
+				verdict = "faster";
+				faster++;
+			}
+
+			significant.push_back(make_pair(i->first, &cell));
+		}
+
+		// The key is written out as columns again.
+		stringstream key(i->first);
+		string field;
+		while(key >> field)
+		{
+			dataDump << field.substr(field.find('=') + 1) << ",";
+		}
+
+		dataDump << cell.base.size() << "," << cell.candidate.size() << ","
+			 << median(cell.base) << "," << median(cell.candidate) << ","
+			 << cell.change << "," << cell.delta << ",";
+		if(cell.p > 1)
+		{
+			dataDump << ",,";
+		}
+		else
+		{
+			dataDump << cell.p << "," << cell.q << ",";
+		}
+		dataDump << cell.baseResult << "," << cell.candidateResult << "," << verdict << "\n";
+	}
+
+	// Append an extra new line character to the end of the file.
+	dataDump << "\n";
+	dataDump.close();
+
+	// Print the significant changes, slowest first.
+	sort(significant.begin(), significant.end(), biggerChange);
+
+	for(unsigned int i = 0; i < significant.size(); i++)
+	{
+		compareCell& cell = *significant[i].second;
+		bool wrong = (cell.candidateResult < 1.0f) && (cell.baseResult >= 1.0f);
+
+		if(wrong)
+		{
+			cout << "WRONG       ";
+		}
+		else if(cell.change > thresholdPercent)
+		{
+			cout << "REGRESSION  ";
+		}
+		else
+		{
+			cout << ((cell.change > 0) ? "slower      " : "faster      ");
+		}
+
+		cout << significant[i].first << ": " << median(cell.base) << " -> " << median(cell.candidate)
+		     << " (" << ((cell.change > 0) ? "+" : "") << cell.change << "%, delta " << cell.delta;
+		if(cell.p <= 1)
+		{
+			cout << ", q " << cell.q;
+		}
+		if(wrong)
+		{
+			cout << ", result " << cell.candidateResult;
+		}
+		cout << ")\n";
+	}
+
+	unsigned int matched = cells.size() - onlyBase - onlyCandidate;
+
+	cout << "\n" << matched << " cells matched, " << faster << " faster, " << slower
+	     << " slower, " << regressions << " regression" << ((regressions == 1) ? "" : "s")
+	     << " (more than " << thresholdPercent << "% slower, or wrong).\n";
+
+	if(untested)
+	{
+		cout << "NOTE: " << untested << " cells had fewer than 2 times on a side and could not be tested. "
+		     << "Run the tests with -reps to get more.\n";
+	}
+	if(onlyBase || onlyCandidate)
+	{
+		cout << "NOTE: " << onlyBase << " cells are only in the baseline and "
+		     << onlyCandidate << " are only in the candidate.\n";
+	}
+
+	return regressions;
+}
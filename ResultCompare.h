@@ -0,0 +1,40 @@
+// Author: Jason Tennyson
+// File: ResultCompare.h
+// Date: 10/19/26
+//
+// This file contains the definitions for the compare mode. It reads two
+// binary results files, a baseline and a candidate (say, from before and
+// after a kernel upgrade), and matches up their cells by configuration:
+// every column but the time and the result. When a test is run with -reps,
+// every cell has several times, and the two sets of times are compared with
+// a Mann-Whitney U test, which doesn't assume that the times are normally
+// distributed (they almost never are, since a cell can only be so fast but
+// can be slowed down by anything).
+//
+// With hundreds of cells, some will look different by luck alone, so the
+// p values are adjusted with the Benjamini-Hochberg procedure, which keeps
+// the expected share of false alarms among the cells called different at
+// the chosen level. A cell is only a regression if it is significantly
+// slower and the median slowed down by more than the threshold, so that a
+// real but tiny slowdown doesn't fail a rollout. A cell that gets the wrong
+// result in the candidate and not in the baseline is a regression too.
+
+#ifndef ResultCompare_h_
+#define ResultCompare_h_
+
+#define DEFAULT_ALPHA_PERCENT		(5)			// Default false discovery rate (%).
+#define DEFAULT_REGRESSION_PERCENT	(5)			// Default slowdown that fails (%).
+#define EXACT_U_LIMIT			(20)			// Most samples for the exact test.
+#define COMPARE_TIME_COLUMN		("time_usec")		// The column that is compared.
+#define COMPARE_RESULT_COLUMN		("result")		// The column that is checked.
+
+// This function compares the candidate results file to the baseline one,
+// prints the cells that got significantly faster or slower, and saves every
+// cell to filename in the spreadsheet folder. alphaPercent is the false
+// discovery rate, and thresholdPercent is how much slower a cell has to get
+// to be a regression. Returns the number of regressions, or -1 if the files
+// can't be read or don't describe the same kind of test.
+int compareResults(const char* basePath, const char* candidatePath, const char* filename,
+		   unsigned int alphaPercent, unsigned int thresholdPercent);
+
+#endif
@@ -0,0 +1,467 @@
+// Author: Jason Tennyson
+// File: ResultsFile.cpp
+// Date: 10/19/26
+//
+// This file contains the function definitions for the binary results file.
+// All values are stored in the byte order of the machine that wrote them.
+// The layout is:
+//
+//	header:	"TTRB", version, column count, block rows	(4 x 4 bytes)
+//		column count x columnSchema			(36 bytes each)
+//		padding up to a multiple of 8 bytes
+//	block:	"BLCK", row count				(2 x 4 bytes)
+//		for each column: row count values, padded to 8 bytes
+//
+// Blocks repeat until the end of the file. Only the last block can hold
+// fewer than the block row count.
+
+#include "ResultsFile.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cstring>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+using namespace std;
+
+// These are zeros that are written out as padding.
+static const char padding[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+
+// This function rounds a byte count up to a multiple of 8.
+static unsigned long long padTo8(unsigned long long bytes)
+{
+	return (bytes + 7) & ~7ULL;
+}
+
+// This function returns the size in bytes of one value of a column type.
+unsigned int columnWidth(unsigned int type)
+{
+	switch(type)
+	{
+		case COLUMN_U32:
+		case COLUMN_F32:
+			return 4;
+		case COLUMN_U64:
+		case COLUMN_F64:
+			return 8;
+		default:
+			return 0;
+	}
+}
+
+// This is the constructor for the resultsWriter class.
+resultsWriter::resultsWriter(void)
+{
+	fd = -1;
+	row = 0;
+	columnCount = 0;
+
+	for(unsigned int i = 0; i < RESULTS_MAX_COLUMNS; i++)
+	{
+		buffers[i] = NULL;
+	}
+}
+
+// This is the destructor for the resultsWriter class.
+resultsWriter::~resultsWriter(void)
+{
+	close();
+
+	// Give back the column buffers.
+	for(unsigned int i = 0; i < columnCount; i++)
+	{
+		delete [] buffers[i];
+	}
+}
+
+// This function adds a column to the schema.
+unsigned int resultsWriter::addColumn(const char* name, columnType type)
+{
+	// If we are out of room, hand back the last column so that nothing
+	// writes outside of the buffers.
+	if(columnCount == RESULTS_MAX_COLUMNS)
+	{
+		cout << "WARNING: Too many result columns, " << name << " is dropped.\n";
+		return (RESULTS_MAX_COLUMNS - 1);
+	}
+
+	columns[columnCount].type = type;
+	memset(columns[columnCount].name, 0, RESULTS_NAME_LENGTH);
+	strncpy(columns[columnCount].name, name, RESULTS_NAME_LENGTH - 1);
+
+	return columnCount++;
+}
+
+// This function creates the file and writes the schema header.
+bool resultsWriter::open(const char* path)
+{
+	fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+	if(fd < 0)
+	{
+		return false;
+	}
+
+	// All of the memory the writer will ever need is allocated here.
+	for(unsigned int i = 0; i < columnCount; i++)
+	{
+		buffers[i] = new char[RESULTS_BLOCK_ROWS*8];
+	}
+
+	// Write the fixed part of the header.
+	unsigned int fixed[4];
+	memcpy(&fixed[0], RESULTS_MAGIC, 4);
+	fixed[1] = RESULTS_VERSION;
+	fixed[2] = columnCount;
+	fixed[3] = RESULTS_BLOCK_ROWS;
+
+	unsigned long long headerBytes = sizeof(fixed) + columnCount*sizeof(columnSchema);
+
+	struct iovec parts[3];
+	parts[0].iov_base = fixed;
+	parts[0].iov_len = sizeof(fixed);
+	parts[1].iov_base = columns;
+	parts[1].iov_len = columnCount*sizeof(columnSchema);
+	parts[2].iov_base = (void*)padding;
+	parts[2].iov_len = padTo8(headerBytes) - headerBytes;
+
+	if(writev(fd, parts, 3) != (ssize_t)padTo8(headerBytes))
+	{
+		::close(fd);
+		fd = -1;
+		return false;
+	}
+
+	row = 0;
+	return true;
+}
+
+// This function writes the buffered rows out as one block.
+void resultsWriter::flushBlock(void)
+{
+	if((fd < 0) || (row == 0))
+	{
+		row = 0;
+		return;
+	}
+
+	// The block header, then every column and its padding.
+	unsigned int blockHeader[2];
+	memcpy(&blockHeader[0], RESULTS_BLOCK_MAGIC, 4);
+	blockHeader[1] = row;
+
+	struct iovec parts[1 + 2*RESULTS_MAX_COLUMNS];
+	unsigned int partCount = 0;
+	ssize_t expected = sizeof(blockHeader);
+
+	parts[partCount].iov_base = blockHeader;
+	parts[partCount++].iov_len = sizeof(blockHeader);
+
+	for(unsigned int i = 0; i < columnCount; i++)
+	{
+		unsigned long long bytes = (unsigned long long)row*columnWidth(columns[i].type);
+
+		parts[partCount].iov_base = buffers[i];
+		parts[partCount++].iov_len = bytes;
+		parts[partCount].iov_base = (void*)padding;
+		parts[partCount++].iov_len = padTo8(bytes) - bytes;
+
+		expected += padTo8(bytes);
+	}
+
+	if(writev(fd, parts, partCount) != expected)
+	{
+		cout << "WARNING: Could not write to the results file.\n";
+	}
+
+	row = 0;
+}
+
+// This function writes out any partial block and closes the file.
+void resultsWriter::close(void)
+{
+	if(fd >= 0)
+	{
+		flushBlock();
+		::close(fd);
+		fd = -1;
+	}
+}
+
+// This is the constructor for the resultsReader class.
+resultsReader::resultsReader(void)
+{
+	base = NULL;
+	size = 0;
+	columns = 0;
+	schema = NULL;
+	totalRows = 0;
+}
+
+// This is the destructor for the resultsReader class.
+resultsReader::~resultsReader(void)
+{
+	if(base)
+	{
+		munmap((void*)base, size);
+	}
+}
+
+// This function maps the file and builds an index of its blocks.
+bool resultsReader::open(const char* path)
+{
+	int fd = ::open(path, O_RDONLY);
+	struct stat info;
+
+	if(fd < 0)
+	{
+		return false;
+	}
+
+	if((fstat(fd, &info) != 0) || (info.st_size < 16))
+	{
+		::close(fd);
+		return false;
+	}
+
+	size = info.st_size;
+	void* mapped = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+
+	if(mapped == MAP_FAILED)
+	{
+		return false;
+	}
+
+	base = (const char*)mapped;
+
+	// Check the fixed part of the header.
+	const unsigned int* fixed = (const unsigned int*)base;
+	if((memcmp(base, RESULTS_MAGIC, 4) != 0) || (fixed[1] != RESULTS_VERSION) ||
+	   (fixed[2] > RESULTS_MAX_COLUMNS))
+	{
+		return false;
+	}
+
+	columns = fixed[2];
+	schema = (const columnSchema*)(base + 16);
+
+	unsigned long long offset = padTo8(16 + columns*sizeof(columnSchema));
+
+	// The schema has to fit in the file.
+	if(offset > size)
+	{
+		return false;
+	}
+
+	// Walk the blocks. A block that was cut short is left out.
+	while((offset + 8) <= size)
+	{
+		const unsigned int* blockHeader = (const unsigned int*)(base + offset);
+		blockIndex block;
+
+		if(memcmp(blockHeader, RESULTS_BLOCK_MAGIC, 4) != 0)
+		{
+			break;
+		}
+
+		block.rows = blockHeader[1];
+		offset += 8;
+
+		for(unsigned int i = 0; i < columns; i++)
+		{
+			block.columnOffsets[i] = offset;
+			offset += padTo8((unsigned long long)block.rows*columnWidth(schema[i].type));
+		}
+
+		if(offset > size)
+		{
+			break;
+		}
+
+		blocks.push_back(block);
+		totalRows += block.rows;
+	}
+
+	return true;
+}
+
+// This function returns any value as a double.
+double resultsReader::value(unsigned int block, unsigned int row, unsigned int column)
+{
+	const void* data = this->column(block, column);
+
+	switch(schema[column].type)
+	{
+		case COLUMN_U32:
+			return ((const unsigned int*)data)[row];
+		case COLUMN_U64:
+			return ((const unsigned long long*)data)[row];
+		case COLUMN_F32:
+			return ((const float*)data)[row];
+		case COLUMN_F64:
+			return ((const double*)data)[row];
+		default:
+			return 0;
+	}
+}
+
+// This function prints one value of a column into a text stream.
+static void printValue(ostream& out, resultsReader& reader, unsigned int block, unsigned int row, unsigned int column)
+{
+	const void* data = reader.column(block, column);
+
+	switch(reader.columnType(column))
+	{
+		case COLUMN_U32:
+			out << ((const unsigned int*)data)[row];
+			break;
+		case COLUMN_U64:
+			out << ((const unsigned long long*)data)[row];
+			break;
+		case COLUMN_F32:
+			out << ((const float*)data)[row];
+			break;
+		case COLUMN_F64:
+			out << ((const double*)data)[row];
+			break;
+	}
+}
+
+// This function exports a results file as CSV or JSON.
+bool exportResults(const char* path, bool json)
+{
+	resultsReader reader;
+
+	if(!reader.open(path))
+	{
+		return false;
+	}
+
+	// The output goes next to the input, with a suffix so that it does
+	// not clobber the spreadsheet that was written alongside it.
+	string outPath = path;
+	size_t dot = outPath.rfind('.');
+	if(dot != string::npos)
+	{
+		outPath.erase(dot);
+	}
+	outPath += (json ? "_results.json" : "_results.csv");
+
+	ofstream out(outPath.c_str());
+	if(!out)
+	{
+		return false;
+	}
+
+	// Print enough digits that nothing is lost on the way out.
+	out.precision(9);
+
+	if(json)
+	{
+		// One object per row, in one big array.
+		out << "[\n";
+		bool first = true;
+
+		for(unsigned int b = 0; b < reader.blockCount(); b++)
+		{
+			for(unsigned int r = 0; r < reader.blockRows(b); r++)
+			{
+				out << (first ? "  {" : ",\n  {");
+				first = false;
+
+				for(unsigned int c = 0; c < reader.columnCount(); c++)
+				{
+					out << (c ? ", \"" : "\"") << reader.columnName(c) << "\": ";
+					printValue(out, reader, b, r, c);
+				}
+
+				out << "}";
+			}
+		}
+
+		out << "\n]\n";
+	}
+	else
+	{
+		// The top line is the column names.
+		for(unsigned int c = 0; c < reader.columnCount(); c++)
+		{
+			out << (c ? "," : "") << reader.columnName(c);
+		}
+		out << "\n";
+
+		for(unsigned int b = 0; b < reader.blockCount(); b++)
+		{
+			for(unsigned int r = 0; r < reader.blockRows(b); r++)
+			{
+				for(unsigned int c = 0; c < reader.columnCount(); c++)
+				{
+					if(c)
+					{
+						out << ",";
+					}
+					printValue(out, reader, b, r, c);
+				}
+				out << "\n";
+			}
+		}
+	}
+
+	out.close();
+
+	cout << outPath << " has been exported!\n";
+	return true;
+}
+
+// This function prints the minimum, mean and maximum of every column. It
+// walks one column at a time straight out of the mapped file.
+bool summarizeResults(const char* path)
+{
+	resultsReader reader;
+
+	if(!reader.open(path))
+	{
+		return false;
+	}
+
+	cout << path << ": " << reader.rowCount() << " rows in "
+	     << reader.blockCount() << " blocks\n";
+
+	for(unsigned int c = 0; c < reader.columnCount(); c++)
+	{
+		double minimum = 0, maximum = 0, total = 0;
+		bool first = true;
+
+		for(unsigned int b = 0; b < reader.blockCount(); b++)
+		{
+			for(unsigned int r = 0; r < reader.blockRows(b); r++)
+			{
+				double v = reader.value(b, r, c);
+
+				if(first || (v < minimum))
+				{
+					minimum = v;
+				}
+				if(first || (v > maximum))
+				{
+					maximum = v;
+				}
+
+				total += v;
+				first = false;
+			}
+		}
+
+		cout << "  " << reader.columnName(c) << ": min " << minimum
+		     << ", mean " << (reader.rowCount() ? total/reader.rowCount() : 0)
+		     << ", max " << maximum << "\n";
+	}
+
+	return true;
+}
@@ -0,0 +1,155 @@
+// Author: Jason Tennyson
+// File: ResultsFile.h
+// Date: 10/19/26
+//
+// This file contains the class definitions for the binary results file.
+// A results file starts with a schema header that names every column and
+// its type, followed by blocks of rows. Inside a block, each column is
+// stored as one contiguous array, so a reader can map the file and walk a
+// single column without touching the others. The writer fills preallocated
+// column buffers and only goes to the disk once a block is full, so adding
+// a row never allocates memory or formats any text.
+
+#ifndef ResultsFile_h_
+#define ResultsFile_h_
+
+#include <vector>
+
+#define RESULTS_MAGIC		("TTRB")			// Start of every results file.
+#define RESULTS_BLOCK_MAGIC	("BLCK")			// Start of every block.
+#define RESULTS_VERSION		(1)				// Version of the layout.
+#define RESULTS_BLOCK_ROWS	(4096)				// Rows buffered per block.
+#define RESULTS_MAX_COLUMNS	(64)				// Maximum number of columns.
+#define RESULTS_NAME_LENGTH	(32)				// Bytes in a column name.
+#define BINARY_EXTENSION	(".ttrb")			// Results file extension.
+
+// These are the types a column can have.
+enum columnType
+{
+	COLUMN_U32 = 1,		// 32 bit unsigned integer.
+	COLUMN_U64 = 2,		// 64 bit unsigned integer.
+	COLUMN_F32 = 3,		// 32 bit float.
+	COLUMN_F64 = 4		// 64 bit double.
+};
+
+// This function returns the size in bytes of one value of a column type.
+unsigned int columnWidth(unsigned int type);
+
+// This structure is how a column is described in the schema header.
+struct columnSchema
+{
+	unsigned int type;			// One of the columnType values.
+	char name[RESULTS_NAME_LENGTH];		// Null terminated column name.
+};
+
+// This class writes a results file one row at a time.
+class resultsWriter
+{
+	public:
+		// This is the class constructor.
+		resultsWriter(void);
+		// This is the class destructor. It closes the file if needed.
+		~resultsWriter(void);
+
+		// This function adds a column to the schema. Columns have to be
+		// added before the file is opened. Returns the column index.
+		unsigned int addColumn(const char* name, columnType type);
+
+		// This function creates the file, writes the schema header, and
+		// allocates the column buffers. Returns false on failure.
+		bool open(const char* path);
+
+		// These functions set a value in the current row.
+		void setU32(unsigned int column, unsigned int value) { ((unsigned int*)buffers[column])[row] = value; }
+		void setU64(unsigned int column, unsigned long long value) { ((unsigned long long*)buffers[column])[row] = value; }
+		void setF32(unsigned int column, float value) { ((float*)buffers[column])[row] = value; }
+		void setF64(unsigned int column, double value) { ((double*)buffers[column])[row] = value; }
+
+		// This function finishes the current row. The block goes to the
+		// disk once it is full.
+		void endRow(void)
+		{
+			if(++row == RESULTS_BLOCK_ROWS)
+			{
+				flushBlock();
+			}
+		}
+
+		// This function writes out any partial block and closes the file.
+		void close(void);
+
+	private:
+		// The file descriptor of the results file.
+		int fd;
+		// The current row within the block.
+		unsigned int row;
+		// The schema of the file.
+		unsigned int columnCount;
+		columnSchema columns[RESULTS_MAX_COLUMNS];
+		// One preallocated buffer per column.
+		char* buffers[RESULTS_MAX_COLUMNS];
+
+		// This function writes the buffered rows out as one block.
+		void flushBlock(void);
+};
+
+// This class reads a results file by mapping it into memory.
+class resultsReader
+{
+	public:
+		// This is the class constructor.
+		resultsReader(void);
+		// This is the class destructor. It unmaps the file.
+		~resultsReader(void);
+
+		// This function maps the file and checks its layout. Returns
+		// false if the file can't be read or is not a results file.
+		bool open(const char* path);
+
+		// These functions describe the schema.
+		unsigned int columnCount(void) { return columns; }
+		const char* columnName(unsigned int column) { return schema[column].name; }
+		unsigned int columnType(unsigned int column) { return schema[column].type; }
+
+		// These functions describe the blocks.
+		unsigned int blockCount(void) { return blocks.size(); }
+		unsigned int blockRows(unsigned int block) { return blocks[block].rows; }
+		unsigned long long rowCount(void) { return totalRows; }
+
+		// This function returns a pointer straight into the mapped file
+		// at the start of a column within a block.
+		const void* column(unsigned int block, unsigned int column)
+		{
+			return base + blocks[block].columnOffsets[column];
+		}
+
+		// This function returns any value as a double.
+		double value(unsigned int block, unsigned int row, unsigned int column);
+
+	private:
+		// This structure is where a block and its columns live.
+		struct blockIndex
+		{
+			unsigned int rows;
+			unsigned long long columnOffsets[RESULTS_MAX_COLUMNS];
+		};
+
+		// The mapped file and its size.
+		const char* base;
+		unsigned long long size;
+		// The schema read from the header.
+		unsigned int columns;
+		const columnSchema* schema;
+		// The blocks found in the file.
+		std::vector<blockIndex> blocks;
+		unsigned long long totalRows;
+};
+
+// This function exports a results file as CSV or JSON next to it, named
+// after it with a "_results" suffix. Returns false on failure.
+bool exportResults(const char* path, bool json);
+
+// This function prints the minimum, mean and maximum of every column.
+bool summarizeResults(const char* path);
+
+#endif
@@ -0,0 +1,344 @@
+// Author: Jason Tennyson
+// File: ScenarioFile.cpp
+// Date: 10/19/26
+//
+// This file contains the implementation of the scenario file reader. The
+// settings of a scenario are collected until the next scenario starts (or
+// the file ends), and then they are turned into -auto arguments all at once.
+
+#include "ScenarioFile.h"
+#include "DataParallel.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <cstring>
+#include <cctype>
+#include <strings.h>
+
+using namespace std;
+
+// These are the settings that a scenario can have.
+static const char* settingNames[] = { "workload", "strategy", "threads", "n", "step", "reps", "file", "flags" };
+
+// This function cuts the spaces and tabs off of both ends of text.
+static string trim(const string& text)
+{
+	size_t start = text.find_first_not_of(" \t\r\n");
+	size_t end = text.find_last_not_of(" \t\r\n");
+
+	return ((start == string::npos) ? string() : text.substr(start, (end - start) + 1));
+}
+
+// This function returns whether text is all digits, and not empty.
+static bool allDigits(const string& text)
+{
+	return (!text.empty() && (text.find_first_not_of("0123456789") == string::npos));
+}
+
+// This function returns whether text is all letters and numbers, and not
+// empty, which is what a file name has to be.
+static bool allAlphanumeric(const string& text)
+{
+	if(text.empty())
+	{
+		return false;
+	}
+
+	for(size_t i = 0; i < text.size(); i++)
+	{
+		if(!(((text[i] >= '0') && (text[i] <= '9')) ||
+		     ((text[i] >= 'a') && (text[i] <= 'z')) ||
+		     ((text[i] >= 'A') && (text[i] <= 'Z'))))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// This function reads a range like "2-8" into low and high, or a single
+// number like "8" into high, leaving low empty.
+static bool readRange(const string& text, string* low, string* high)
+{
+	size_t dash = text.find('-');
+
+	if(dash == string::npos)
+	{
+		low->clear();
+		*high = text;
+		return allDigits(text);
+	}
+
+	*low = trim(text.substr(0, dash));
+	*high = trim(text.substr(dash + 1));
+
+	return (allDigits(*low) && allDigits(*high) && (atoll(low->c_str()) <= atoll(high->c_str())));
+}
+
+// This function turns the settings of a scenario into -auto arguments and
+// adds it to scenarios. Returns false, after saying what is wrong, if a
+// setting doesn't make sense.
+static bool addScenario(const char* path, unsigned int line, const string& name,
+			map<string, string>& settings, vector<scenarioSpec>& scenarios)
+{
+	scenarioSpec scenario;
+	string low, high;
+
+	scenario.name = name;
+	scenario.arguments.push_back("-auto");
+
+	// The spreadsheet is named after the scenario unless it says otherwise.
+	string file = settings.count("file") ? settings["file"] : name;
+	if(!allAlphanumeric(file))
+	{
+		cout << path << " line " << line << ": " << file
+		     << " is not a file name that we can use (letters and numbers only)!\n";
+		return false;
+	}
+	scenario.arguments.push_back("-f=" + file);
+
+	if(settings.count("workload") && (strcasecmp(settings["workload"].c_str(), "increment") != 0))
+	{
+		dataKernel kernel;
+
+		if(!dataKernelFromName(settings["workload"].c_str(), &kernel))
+		{
+			cout << path << " line " << line << ": " << settings["workload"]
+			     << " is not a workload that we know!\n";
+			return false;
+		}
+
+		scenario.arguments.push_back(string("-data=") + dataKernelName(kernel));
+	}
+
+	if(settings.count("strategy"))
+	{
+		const char* strategy = settings["strategy"].c_str();
+
+		if(strcasecmp(strategy, "unsafe") == 0)
+		{
+			scenario.arguments.push_back("-sh");
+		}
+		else if((strcasecmp(strategy, "safe") == 0) || (strcasecmp(strategy, "procs") == 0) ||
+			(strcasecmp(strategy, "procsatomic") == 0))
+		{
+			scenario.arguments.push_back("-sh");
+			scenario.arguments.push_back("-saf");
+
+			if(strcasecmp(strategy, "procs") == 0)
+			{
+				scenario.arguments.push_back("-procs");
+			}
+			else if(strcasecmp(strategy, "procsatomic") == 0)
+			{
+				scenario.arguments.push_back("-procs=atomic");
+			}
+		}
+		else if(strcasecmp(strategy, "unshared") != 0)
+		{
+			cout << path << " line " << line << ": " << strategy
+			     << " is not a strategy that we know!\n";
+			return false;
+		}
+	}
+
+	if(settings.count("threads"))
+	{
+		if(!readRange(settings["threads"], &low, &high))
+		{
+			cout << path << " line " << line << ": " << settings["threads"]
+			     << " is not a range of threads!\n";
+			return false;
+		}
+
+		scenario.arguments.push_back("-t=" + high);
+		if(!low.empty())
+		{
+			scenario.arguments.push_back("-tmin=" + low);
+		}
+	}
+
+	if(settings.count("n"))
+	{
+		if(!readRange(settings["n"], &low, &high))
+		{
+			cout << path << " line " << line << ": " << settings["n"] << " is not a range of n!\n";
+			return false;
+		}
+
+		scenario.arguments.push_back("-m=" + high);
+		if(!low.empty())
+		{
+			scenario.arguments.push_back("-nmin=" + low);
+		}
+	}
+
+	if(settings.count("step"))
+	{
+		if(!allDigits(settings["step"]))
+		{
+			cout << path << " line " << line << ": " << settings["step"] << " is not a step!\n";
+			return false;
+		}
+
+		scenario.arguments.push_back("-d=" + settings["step"]);
+	}
+
+	if(settings.count("reps"))
+	{
+		if(!allDigits(settings["reps"]))
+		{
+			cout << path << " line " << line << ": " << settings["reps"]
+			     << " is not a number of repetitions!\n";
+			return false;
+		}
+
+		scenario.arguments.push_back("-reps=" + settings["reps"]);
+	}
+
+	// Anything else goes straight through to -auto.
+	if(settings.count("flags"))
+	{
+		stringstream flags(settings["flags"]);
+		string flag;
+
+		while(flags >> flag)
+		{
+			if(flag[0] != '-')
+			{
+				cout << path << " line " << line << ": " << flag << " is not a flag!\n";
+				return false;
+			}
+
+			scenario.arguments.push_back(flag);
+		}
+	}
+
+	scenarios.push_back(scenario);
+	return true;
+}
+
+// This function reads the scenario file at path.
+bool loadScenarios(const char* path, vector<scenarioSpec>& scenarios)
+{
+	ifstream scenarioFile(path);
+
+	if(!scenarioFile)
+	{
+		cout << path << " could not be opened!\n";
+		return false;
+	}
+
+	map<string, string> settings;
+	string name;
+	unsigned int nameLine = 0;
+	unsigned int lineNumber = 0;
+	char text[MAX_SCENARIO_LINE];
+
+	while(scenarioFile.getline(text, sizeof(text)) || (scenarioFile.gcount() > 0))
+	{
+		lineNumber++;
+
+		if(scenarioFile.fail() && !scenarioFile.eof())
+		{
+			cout << path << " line " << lineNumber << ": The line is too long!\n";
+			return false;
+		}
+
+		string line = trim(text);
+
+		// Skip blank lines and comments.
+		if(line.empty() || (line[0] == '#'))
+		{
+			continue;
+		}
+
+		// A name in square brackets starts the next scenario, so the
+		// last one is done.
+		if(line[0] == '[')
+		{
+			if(!name.empty() && !addScenario(path, nameLine, name, settings, scenarios))
+			{
+				return false;
+			}
+
+			name = trim(line.substr(1, line.find(']') - 1));
+			nameLine = lineNumber;
+			settings.clear();
+
+			if((line[line.size() - 1] != ']') || name.empty())
+			{
+				cout << path << " line " << lineNumber << ": A scenario needs a name in square brackets!\n";
+				return false;
+			}
+
+			for(size_t i = 0; i < scenarios.size(); i++)
+			{
+				if(scenarios[i].name == name)
+				{
+					cout << path << " line " << lineNumber << ": There is already a scenario called "
+					     << name << "!\n";
+					return false;
+				}
+			}
+
+			continue;
+		}
+
+		size_t equals = line.find('=');
+		if(equals == string::npos)
+		{
+			cout << path << " line " << lineNumber << ": A setting needs an '='!\n";
+			return false;
+		}
+
+		string key = trim(line.substr(0, equals));
+		string value = trim(line.substr(equals + 1));
+		bool known = false;
+
+		for(unsigned int i = 0; i < (sizeof(settingNames)/sizeof(settingNames[0])); i++)
+		{
+			known = known || (strcasecmp(key.c_str(), settingNames[i]) == 0);
+		}
+
+		// Keys are compared in lower case from here on.
+		for(size_t i = 0; i < key.size(); i++)
+		{
+			key[i] = tolower(key[i]);
+		}
+
+		if(name.empty())
+		{
+			cout << path << " line " << lineNumber << ": Settings have to come after a scenario name!\n";
+			return false;
+		}
+		else if(!known)
+		{
+			cout << path << " line " << lineNumber << ": " << key << " is not a setting that we know!\n";
+			return false;
+		}
+		else if(settings.count(key))
+		{
+			cout << path << " line " << lineNumber << ": " << key << " was already set!\n";
+			return false;
+		}
+
+		settings[key] = value;
+	}
+
+	// The last scenario ends with the file.
+	if(!name.empty() && !addScenario(path, nameLine, name, settings, scenarios))
+	{
+		return false;
+	}
+
+	if(scenarios.empty())
+	{
+		cout << path << " has no scenarios in it!\n";
+		return false;
+	}
+
+	return true;
+}
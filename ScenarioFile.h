@@ -0,0 +1,48 @@
+// Author: Jason Tennyson
+// File: ScenarioFile.h
+// Date: 10/19/26
+//
+// This file contains the definitions for scenario files. A scenario file
+// lists automatic tests to run one after another in the same process, so a
+// whole matrix of them can be run without starting the program over for
+// each one. Every scenario starts with its name in square brackets, and is
+// followed by settings, one per line:
+//
+//	[safe]
+//	workload = increment		increment, samplesort, mergesort or groupby
+//	strategy = safe			unshared, unsafe, safe, procs or procsatomic
+//	threads = 2-8			the thread counts (or just the most)
+//	n = 100000-1000000		the values of n (or just the most)
+//	step = 100000			the step between values of n
+//	reps = 5			how many times every cell is measured
+//	file = nightlysafe		the spreadsheet, named after the scenario
+//					if this is left out
+//	flags = -clock -csns=50		anything else that -auto takes
+//
+// Lines that start with '#' are comments. Every setting is turned into the
+// -auto argument that it stands for, so a setting that is out of bounds is
+// handled the same way it would be on the command line. The strategy only
+// matters to the increments, since the data workloads don't share anything.
+
+#ifndef ScenarioFile_h_
+#define ScenarioFile_h_
+
+#include <string>
+#include <vector>
+
+#define SCENARIO_EXTENSION	("_scenarios.csv")		// Ending of the combined file.
+#define MAX_SCENARIO_LINE	(1024)				// Longest line in a scenario file.
+
+// This structure is one scenario.
+struct scenarioSpec
+{
+	std::string name;			// What it is called.
+	std::vector<std::string> arguments;	// The -auto arguments it stands for.
+};
+
+// This function reads the scenario file at path. Returns false, after
+// saying which line is wrong, if it can't be read or has a mistake in it,
+// so that a matrix never runs with a scenario missing.
+bool loadScenarios(const char* path, std::vector<scenarioSpec>& scenarios);
+
+#endif
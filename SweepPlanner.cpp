@@ -0,0 +1,242 @@
+// Author: Jason Tennyson
+// File: SweepPlanner.cpp
+// Date: 10/19/26
+//
+// This file contains the function definitions for the sweepPlanner class.
+// The first pass measures n on a log scale from the minimum to the maximum,
+// because the interesting part of the curve is usually at small n, where
+// thread creation still costs more than the calculations do. After that,
+// every new sample goes into the interval between two measured rows that
+// has the biggest change in time per calculation or result, as long as the
+// predicted cost of that sample still fits in the time budget.
+
+#include "SweepPlanner.h"
+#include <cmath>
+
+using namespace std;
+
+// This is the constructor for the sweepPlanner class. It lays out the
+// geometric pass and starts the budget clock.
+sweepPlanner::sweepPlanner(unsigned int minN, unsigned int maxN, unsigned int minThreads,
+			   unsigned int threadCounts, unsigned int budgetSecs)
+{
+	this->minN = minN;
+	this->maxN = maxN;
+	this->minThreads = minThreads;
+	this->threadCounts = threadCounts;
+
+	budgetNsecs = (unsigned long long)budgetSecs*1000000000ULL;
+	startNsecs = timeStamp::monotonicNsecs();
+	geometricIndex = 0;
+
+	// This is the ratio between neighbouring samples in the first pass.
+	double ratio = pow((double)maxN/(double)minN, 1.0/(GEOMETRIC_POINTS - 1));
+
+	// Lay out the geometric pass, skipping values that round to the
+	// same integer as the one before them.
+	for(unsigned int k = 0; k < GEOMETRIC_POINTS; k++)
+	{
+		unsigned int value = (unsigned int)(minN*pow(ratio, (double)k) + 0.5);
+
+		// Rounding can push us just past either end of the range.
+		if(value < minN)
+		{
+			value = minN;
+		}
+		if((value > maxN) || (k == (GEOMETRIC_POINTS - 1)))
+		{
+			value = maxN;
+		}
+
+		if(geometricPass.empty() || (value > geometricPass.back()))
+		{
+			geometricPass.push_back(value);
+		}
+	}
+}
+
+// This function predicts how long a row at n will take by scaling the
+// measured row that is closest to n on a log scale.
+unsigned long long sweepPlanner::predictNsecs(unsigned int n)
+{
+	// With nothing measured yet, we have no idea, so we just try it.
+	if(rows.empty())
+	{
+		return 0;
+	}
+
+	unsigned int closest = 0;
+	double closestDistance = fabs(log((double)n/(double)rows[0].n));
+
+	for(unsigned int i = 1; i < rows.size(); i++)
+	{
+		double distance = fabs(log((double)n/(double)rows[i].n));
+
+		if(distance < closestDistance)
+		{
+			closest = i;
+			closestDistance = distance;
+		}
+	}
+
+	// The work scales with n, so the time should too.
+	return (unsigned long long)((double)rows[closest].rowNsecs*((double)n/(double)rows[closest].n));
+}
+
+// This function checks whether a row at n still fits in the budget.
+bool sweepPlanner::affordable(unsigned int n)
+{
+	unsigned long long elapsed = timeStamp::monotonicNsecs() - startNsecs;
+
+	return ((elapsed + predictNsecs(n)) <= budgetNsecs);
+}
+
+// This function scores the interval between row a and row a+1. The score
+// is the largest relative change in time per calculation (or weighted
+// change in result) across all thread counts, scaled by how wide the
+// interval is on a log scale.
+double sweepPlanner::scoreInterval(unsigned int a)
+{
+	const sweepRow& left = rows[a];
+	const sweepRow& right = rows[a + 1];
+	double score = 0;
+
+	for(unsigned int i = 0; i < threadCounts; i++)
+	{
+		// Time per calculation on both sides of the interval.
+		double leftRate = (double)left.times[i]/(double)left.n;
+		double rightRate = (double)right.times[i]/(double)right.n;
+		double meanRate = (leftRate + rightRate)/2.0;
+		double change = 0;
+
+		// A change in time per calculation only counts relative to
+		// how big the time per calculation is in the first place.
+		if(meanRate > 0)
+		{
+			change = fabs(rightRate - leftRate)/meanRate;
+		}
+
+		// The threads drop the remainder of n divided by the thread
+		// count, so that much of a shortfall is expected. Anything
+		// beyond that is a data hazard.
+		unsigned int threads = minThreads + i;
+		double leftExpected = (double)((left.n/threads)*threads)/(double)left.n;
+		double rightExpected = (double)((right.n/threads)*threads)/(double)right.n;
+
+		// A change in the result means data hazards are kicking in,
+		// which is exactly what we want more samples of.
+		change += RESULT_WEIGHT*fabs((right.results[i]/rightExpected) - (left.results[i]/leftExpected));
+
+		if(change > score)
+		{
+			score = change;
+		}
+	}
+
+	return score*log((double)right.n/(double)left.n);
+}
+
+// This function picks the next value of n to measure.
+bool sweepPlanner::nextN(unsigned int* nextN)
+{
+	// If the budget is gone, so are we.
+	if((timeStamp::monotonicNsecs() - startNsecs) >= budgetNsecs)
+	{
+		return false;
+	}
+
+	// Work through the geometric pass first.
+	if(geometricIndex < geometricPass.size())
+	{
+		unsigned int candidate = geometricPass[geometricIndex];
+
+		if(affordable(candidate))
+		{
+			geometricIndex++;
+			*nextN = candidate;
+			return true;
+		}
+
+		// Every sample after this one costs even more, so the first
+		// pass is over. The refinement pass can still fill in below.
+		geometricIndex = geometricPass.size();
+	}
+
+	// Find the most interesting interval that we can still afford.
+	double bestScore = MIN_SCORE;
+	unsigned int bestN = 0;
+
+	for(unsigned int a = 0; (a + 1) < rows.size(); a++)
+	{
+		// Intervals that are already narrow enough are done.
+		if(((double)rows[a + 1].n/(double)rows[a].n) < (MIN_GAP_RATIO*MIN_GAP_RATIO))
+		{
+			continue;
+		}
+
+		double score = scoreInterval(a);
+
+		if(score > bestScore)
+		{
+			// The midpoint on a log scale.
+			unsigned int mid = (unsigned int)sqrt((double)rows[a].n*(double)rows[a + 1].n);
+
+			if(affordable(mid))
+			{
+				bestScore = score;
+				bestN = mid;
+			}
+		}
+	}
+
+	// If nothing was worth measuring, the plan is done.
+	if(bestN == 0)
+	{
+		return false;
+	}
+
+	*nextN = bestN;
+	return true;
+}
+
+// This function stores a measured row, keeping the rows sorted by n.
+void sweepPlanner::recordRow(unsigned int n, const unsigned int* times, const float* results, unsigned long long rowNsecs)
+{
+	sweepRow newRow;
+
+	newRow.n = n;
+	newRow.times.assign(times, times + threadCounts);
+	newRow.results.assign(results, results + threadCounts);
+	newRow.rowNsecs = rowNsecs;
+
+	// Find where this row belongs.
+	unsigned int index = 0;
+	while((index < rows.size()) && (rows[index].n < n))
+	{
+		index++;
+	}
+
+	// Replace a row with the same n, or insert a new one.
+	if((index < rows.size()) && (rows[index].n == n))
+	{
+		rows[index] = newRow;
+	}
+	else
+	{
+		rows.insert(rows.begin() + index, newRow);
+	}
+}
+
+// This function returns the percentage of the time budget used so far.
+double sweepPlanner::budgetUsed(void)
+{
+	double used = 100.0*(double)(timeStamp::monotonicNsecs() - startNsecs)/(double)budgetNsecs;
+
+	// Rows can run over their prediction, so cap it.
+	if(used > 100)
+	{
+		used = 100;
+	}
+
+	return used;
+}
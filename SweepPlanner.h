@@ -0,0 +1,81 @@
+// Author: Jason Tennyson
+// File: SweepPlanner.h
+// Date: 10/19/26
+//
+// This file contains the class definition for the sweepPlanner class.
+// The planner decides which values of n an adaptive auto test should
+// measure. It starts with a geometric (log-spaced) pass over n, and then
+// spends whatever is left of a time budget placing extra samples where
+// the time per calculation or the result changes the fastest.
+
+#ifndef SweepPlanner_h_
+#define SweepPlanner_h_
+
+#include <vector>
+#include "TimeStamp.h"
+
+#define GEOMETRIC_POINTS	(16)				// Samples in the first pass.
+#define RESULT_WEIGHT		(4.0)				// Weight of result changes.
+#define MIN_SCORE		(0.001)				// Smallest score worth a sample.
+#define MIN_GAP_RATIO		(1.05)				// Closest two samples may get.
+
+// This structure holds one row of measurements, which is one value of n
+// measured at every thread count.
+struct sweepRow
+{
+	unsigned int n;				// Number of calculations.
+	std::vector<unsigned int> times;	// Time taken per thread count.
+	std::vector<float> results;		// Result per thread count.
+	unsigned long long rowNsecs;		// Wall time spent on the row.
+};
+
+// This class plans the values of n that are measured in an adaptive sweep
+// and keeps every row that has been measured, sorted by n.
+class sweepPlanner
+{
+	public:
+		// This is the class constructor. It takes the range of n to
+		// cover, the smallest thread count and the number of thread
+		// counts in each row, and the total time budget in seconds.
+		sweepPlanner(unsigned int minN, unsigned int maxN, unsigned int minThreads,
+			     unsigned int threadCounts, unsigned int budgetSecs);
+
+		// This function picks the next value of n to measure. It
+		// returns false once the plan is done or the budget is spent.
+		bool nextN(unsigned int* nextN);
+
+		// This function stores a measured row. The times and results
+		// arrays must hold one value for each thread count.
+		void recordRow(unsigned int n, const unsigned int* times, const float* results, unsigned long long rowNsecs);
+
+		// This function returns the percentage of the budget used.
+		double budgetUsed(void);
+
+		// These functions give access to the measured rows in order of n.
+		unsigned int rowCount(void) { return rows.size(); }
+		const sweepRow& row(unsigned int index) { return rows[index]; }
+
+	private:
+		// The range of n that we cover.
+		unsigned int minN, maxN;
+		// The thread counts measured for every n.
+		unsigned int minThreads, threadCounts;
+		// The budget and the time the sweep started, in nanoseconds.
+		unsigned long long budgetNsecs, startNsecs;
+		// The geometric pass values of n, and how far through them we are.
+		std::vector<unsigned int> geometricPass;
+		unsigned int geometricIndex;
+		// All of the rows measured so far, sorted by n.
+		std::vector<sweepRow> rows;
+
+		// This function predicts how long a row at n will take.
+		unsigned long long predictNsecs(unsigned int n);
+
+		// This function scores the interval between rows a and a+1.
+		double scoreInterval(unsigned int a);
+
+		// This function checks whether a row at n fits in the budget.
+		bool affordable(unsigned int n);
+};
+
+#endif
@@ -0,0 +1,118 @@
+// Author: Jason Tennyson
+// File: SyncStrategy.cpp
+// Date: 10/19/26
+//
+// This file contains the function definitions for the syncLock class.
+
+#include "SyncStrategy.h"
+#include "NameList.h"
+#include <cstring>
+#include <strings.h>
+
+// These are the names of the strategies, in the order of syncType.
+static const char* syncNames[SYNC_TYPES] = { "none", "mutex", "spinlock", "tas", "atomic" };
+
+// This function returns the name of a strategy.
+const char* syncName(syncType type)
+{
+	return ((type < SYNC_TYPES) ? syncNames[type] : "unknown");
+}
+
+// This function finds a strategy by name.
+bool syncFromName(const char* name, syncType* type)
+{
+	for(unsigned int i = 0; i < SYNC_TYPES; i++)
+	{
+		if(strcasecmp(name, syncNames[i]) == 0)
+		{
+			*type = (syncType)i;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// This function reads a comma separated list of strategy names. Names we
+// don't know and repeats are skipped.
+unsigned int syncListFromNames(const char* names, syncType* types)
+{
+	return readNameList(names, syncNames, SYNC_TYPES, types);
+}
+
+// This is the constructor for the syncLock class.
+syncLock::syncLock(syncType type)
+{
+	strategy = type;
+	flag = 0;
+
+	if(strategy == SYNC_MUTEX)
+	{
+		pthread_mutex_init(&mutex, NULL);
+	}
+	else if(strategy == SYNC_SPINLOCK)
+	{
+		pthread_spin_init(&spinlock, PTHREAD_PROCESS_PRIVATE);
+	}
+}
+
+// This is the destructor for the syncLock class.
+syncLock::~syncLock(void)
+{
+	if(strategy == SYNC_MUTEX)
+	{
+		pthread_mutex_destroy(&mutex);
+	}
+	else if(strategy == SYNC_SPINLOCK)
+	{
+		pthread_spin_destroy(&spinlock);
+	}
+}
+
+// This function enters the critical section.
+void syncLock::lock(void)
+{
+	switch(strategy)
+	{
+		case SYNC_MUTEX:
+			pthread_mutex_lock(&mutex);
+			break;
+		case SYNC_SPINLOCK:
+			pthread_spin_lock(&spinlock);
+			break;
+		case SYNC_TAS:
+			// Try to grab the flag, and if someone else has it, spin
+			// on plain reads until it looks free before trying again.
+			// This never yields, so it keeps spinning even if the
+			// thread holding the flag has been put to sleep.
+			while(__atomic_exchange_n(&flag, 1, __ATOMIC_ACQUIRE))
+			{
+				while(__atomic_load_n(&flag, __ATOMIC_RELAXED))
+				{
+					cpuRelax();
+				}
+			}
+			break;
+		default:
+			break;
+	}
+}
+
+// This function leaves the critical section.
+void syncLock::unlock(void)
+{
+	switch(strategy)
+	{
+		case SYNC_MUTEX:
+			pthread_mutex_unlock(&mutex);
+			break;
+		case SYNC_SPINLOCK:
+			pthread_spin_unlock(&spinlock);
+			break;
+		case SYNC_TAS:
+			__atomic_store_n(&flag, 0, __ATOMIC_RELEASE);
+			break;
+		default:
+			break;
+	}
+}
@@ -0,0 +1,92 @@
+// Author: Jason Tennyson
+// File: SyncStrategy.h
+// Date: 10/19/26
+//
+// This file contains the class definition for the syncLock class. The
+// tutorial only ever protected the shared variable with a mutex. The syncLock
+// class lets a test pick how a critical section is protected instead, so
+// that the different ways of doing it can be compared side by side.
+
+#ifndef SyncStrategy_h_
+#define SyncStrategy_h_
+
+#include <pthread.h>
+
+// These are the ways that a critical section can be protected.
+enum syncType
+{
+	SYNC_NONE = 0,		// No protection at all. Expect data hazards.
+	SYNC_MUTEX,		// A pthread mutex, which sleeps when contended.
+	SYNC_SPINLOCK,		// A pthread spinlock.
+	SYNC_TAS,		// A test-and-test-and-set spin loop of our own.
+	SYNC_ATOMIC,		// No lock, the update itself is one atomic add.
+	SYNC_TYPES		// The number of strategies.
+};
+
+// This function tells the CPU that we are spinning, so that it can go
+// easy on the other hardware thread and on the memory system.
+static inline void cpuRelax(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#elif defined(__aarch64__)
+	__asm__ __volatile__("yield" ::: "memory");
+#else
+	__asm__ __volatile__("" ::: "memory");
+#endif
+}
+
+// This function returns the name of a strategy.
+const char* syncName(syncType type);
+
+// This function finds a strategy by name. Returns false if there is none.
+bool syncFromName(const char* name, syncType* type);
+
+// This function reads a comma separated list of strategy names into
+// types, which must have room for SYNC_TYPES entries. Returns the count.
+unsigned int syncListFromNames(const char* names, syncType* types);
+
+// This class protects a critical section with the chosen strategy.
+class syncLock
+{
+	public:
+		// This is the class constructor.
+		syncLock(syncType type);
+		// This is the class destructor.
+		~syncLock(void);
+
+		// This function returns the strategy in use.
+		syncType type(void) { return strategy; }
+
+		// These functions enter and leave the critical section. For
+		// SYNC_NONE and SYNC_ATOMIC they do nothing.
+		void lock(void);
+		void unlock(void);
+
+		// This function adds one to a shared counter the way the
+		// strategy says to. It is the whole critical section of the
+		// shared variable tests.
+		void increment(volatile unsigned long long* counter)
+		{
+			if(strategy == SYNC_ATOMIC)
+			{
+				__atomic_fetch_add(counter, 1, __ATOMIC_RELAXED);
+			}
+			else
+			{
+				lock();
+				(*counter)++;
+				unlock();
+			}
+		}
+
+	private:
+		// The strategy in use.
+		syncType strategy;
+		// Only the lock for the strategy in use is set up.
+		pthread_mutex_t mutex;
+		pthread_spinlock_t spinlock;
+		volatile int flag;
+};
+
+#endif
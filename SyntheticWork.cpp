@@ -0,0 +1,72 @@
+// Author: Jason Tennyson
+// File: SyntheticWork.cpp
+// Date: 10/19/26
+//
+// This file contains the calibration of the synthetic work loop. The loop
+// is timed a few times and the fastest try is kept, since anything slower
+// was most likely interrupted.
+
+#include "SyntheticWork.h"
+#include "TimeStamp.h"
+
+// The number of loops done per nanosecond, or zero before calibration.
+static double loopsPerNsec = 0;
+
+// This function times the work loop on this machine.
+void calibrateSyntheticWork(void)
+{
+	// Only calibrate once.
+	if(loopsPerNsec > 0)
+	{
+		return;
+	}
+
+	unsigned long long fastest = ~0ULL;
+
+	for(unsigned int i = 0; i < CALIBRATION_TRIES; i++)
+	{
+		unsigned long long start = timeStamp::monotonicNsecs();
+		doSyntheticWork(CALIBRATION_LOOPS);
+		unsigned long long taken = timeStamp::monotonicNsecs() - start;
+
+		if(taken < fastest)
+		{
+			fastest = taken;
+		}
+	}
+
+	// Guard against a clock that didn't move.
+	if(fastest == 0)
+	{
+		fastest = 1;
+	}
+
+	loopsPerNsec = (double)CALIBRATION_LOOPS/(double)fastest;
+
+	std::cout << "Synthetic work calibrated at " << (unsigned long long)(loopsPerNsec*1000)
+		  << " loops per microsecond.\n";
+}
+
+// This function returns how many loops are done per nanosecond.
+double syntheticLoopsPerNsec(void)
+{
+	calibrateSyntheticWork();
+
+	return loopsPerNsec;
+}
+
+// This function returns the number of loops that take about nsecs.
+unsigned long long workLoopsFor(unsigned int nsecs)
+{
+	if(nsecs == 0)
+	{
+		return 0;
+	}
+
+	calibrateSyntheticWork();
+
+	unsigned long long loops = (unsigned long long)(nsecs*loopsPerNsec + 0.5);
+
+	// Any work at all is at least one loop.
+	return (loops ? loops : 1);
+}
@@ -0,0 +1,44 @@
+// Author: Jason Tennyson
+// File: SyntheticWork.h
+// Date: 10/19/26
+//
+// This file contains the function prototypes for synthetic work. Synthetic
+// work is a loop of dependent multiply-adds that the compiler can't get rid
+// of, calibrated against the clock on this machine so that a test can ask
+// for a given number of nanoseconds of work. It is used to model how much
+// of the real code runs inside of a critical section and how much of it
+// runs outside.
+
+#ifndef SyntheticWork_h_
+#define SyntheticWork_h_
+
+#define CALIBRATION_LOOPS	(20000000)			// Loops timed per calibration try.
+#define CALIBRATION_TRIES	(5)				// Calibration tries, fastest wins.
+#define MAX_WORK_NSECS		(1000000)			// Most work per operation (ns).
+#define WORK_SWEEP_MIN		(8)				// Smallest nonzero work in a sweep.
+
+// This function times the work loop on this machine. It only does the
+// calibration the first time it is called.
+void calibrateSyntheticWork(void);
+
+// This function returns how many loops are done per nanosecond.
+double syntheticLoopsPerNsec(void);
+
+// This function returns the number of loops that take about nsecs.
+unsigned long long workLoopsFor(unsigned int nsecs);
+
+// This function does the given number of loops of synthetic work.
+static inline void doSyntheticWork(unsigned long long loops)
+{
+	unsigned long long x = loops;
+
+	for(unsigned long long i = 0; i < loops; i++)
+	{
+		// Each loop depends on the last one, and the empty asm keeps
+		// the compiler from working out the answer ahead of time.
+		x = x*6364136223846793005ULL + 1442695040888963407ULL;
+		__asm__ __volatile__("" : "+r"(x));
+	}
+}
+
+#endif
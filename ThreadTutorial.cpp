@@ -12,6 +12,21 @@
 // than 1, a data hazard caused an incorrect result to be calculated.
 
 #include "ThreadTutorial.h"
+#include "ProcessMode.h"
+#include "TraceRecorder.h"
+#include "LiveStats.h"
+#include "CgroupLimits.h"
+#include "ClockSpeed.h"
+#include "Workload.h"
+#include "DataParallel.h"
+#include <sstream>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <unistd.h>
+#include <sched.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
 
 using namespace std;
 
@@ -27,6 +42,101 @@ unsigned int SHARED_VARIABLE;
 // This mutex is used for thread safety when sharing one variable.
 pthread_mutex_t sharedVarMutex;
 
+// These point at the shared variable and its mutex that calcGenerator uses.
+// They point at the ones above, unless the calculations are being run in
+// processes, where they point into the shared memory segment instead.
+unsigned int* sharedVariable = &SHARED_VARIABLE;
+pthread_mutex_t* sharedMutex = &sharedVarMutex;
+bool atomicShared = false;
+
+// This is the shared memory segment and the per process spreadsheet. The
+// segment stays null unless processes have been turned on with
+// enableProcessMode.
+processSegment* processShared = NULL;
+ofstream processDump;
+
+// This is set when a child of the last process cell couldn't be forked or
+// waited for, so that its count can't be trusted.
+bool processFailed = false;
+
+// This is the throttle spreadsheet. Cells are only checked for throttling
+// once it has been turned on with enableThrottleCheck.
+bool throttleChecked = false;
+ofstream throttleDump;
+
+// This is the clock speed spreadsheet. The clock speed is only measured
+// once it has been turned on with enableClockCheck.
+bool clockChecked = false;
+ofstream clockDump;
+
+// This is the core that a worker thread last finished on, or -1. The clock
+// speed is measured there, since the main thread's own core is idle while
+// the workers run.
+int lastWorkerCpu = -1;
+
+// This is the lost update spreadsheet, and what the last cell that was
+// measured should have counted and did count. The cell is only written out
+// once the count has been turned on with enableLostCheck.
+bool lostChecked = false;
+bool taggedWrites = false;
+ofstream lostDump;
+unsigned long long cellExpected = 0;
+unsigned long long cellCounted = 0;
+
+// This structure is what a thread saw of the tagged shared word. Its thread
+// updates it on every write, so each one fills a cache line of its own.
+struct taggedThread
+{
+	unsigned long long lastTag;	// The tag of our last write.
+	unsigned long long sequence;	// Our writes so far.
+	unsigned long long windows;	// Times the word wasn't ours any more.
+	unsigned long long run;		// Writes in a row in this window.
+	unsigned long long longestRun;	// Most writes in a row in any window.
+	char pad[CACHE_LINE_SIZE - 5*sizeof(unsigned long long)];
+};
+
+// This is the tagged shared word. The low TAG_COUNT_BITS count, and the bits
+// above them are the tag of the last write: the thread id, and then the low
+// TAG_SEQUENCE_BITS of that thread's sequence number.
+unsigned long long taggedWord;
+taggedThread taggedThreads[MAX_THREADS] __attribute__((aligned(CACHE_LINE_SIZE)));
+unsigned int taggedNextId;
+
+// This is the synthetic work done for each calculation, inside of the
+// critical section and outside of it, in nanoseconds and in loops.
+unsigned int csNsecs = 0;
+unsigned int parNsecs = 0;
+unsigned long long csLoops = 0;
+unsigned long long parLoops = 0;
+
+// This is set while a surface test runs, so that every calculation takes
+// the lock on its own even at the point with no synthetic work.
+bool lockPerCalc = false;
+
+// This is the cache of finished cells. It stays null unless the cache
+// has been turned on with enableResultCache.
+resultCache* cellCache = NULL;
+
+// This is the binary results file and its columns. It stays null unless
+// it has been turned on with enableBinaryResults.
+resultsWriter* binaryResults = NULL;
+unsigned int binaryN, binaryThreads, binaryTime, binaryResult;
+unsigned int binaryCsNsecs, binaryParNsecs;
+
+// This is how many times every cell of the fixed step and surface tests is
+// measured, and which of those times is being measured now.
+unsigned int cellRepetitions = 1;
+unsigned int cellRepetition = 0;
+
+// This is the fewest threads that the automatic tests sweep from.
+unsigned int firstThreads = MIN_THREADS;
+
+// This is the combined results file of the scenario mode, and the name of
+// the scenario whose cells are going into it now.
+bool combinedResults = false;
+ofstream combinedDump;
+string combinedScenario;
+
 // This function asks the user what they want to do for the test, and
 // then it runs the test and prints the results.
 void runTest(unsigned int threadNo, unsigned int calcs, bool gVar, bool tSafe)
@@ -123,15 +233,12 @@ void runTest(unsigned int threadNo, unsigned int calcs, bool gVar, bool tSafe)
 
 // This function runs an automatic CPU performance test for the user.
 void runAutoTest(const char* filename, bool gVar, bool tSafe,
-		 unsigned int delta, unsigned int max, unsigned int threadNo)
+		 unsigned int min, unsigned int delta, unsigned int max, unsigned int threadNo)
 {
 	// Store the passed values into the global variable equivalents.
 	gVarUsed = gVar;
 	threadSafe = tSafe;
 
-	// Create an instance of timeStamp.
-	timeStamp threadTimer;
-
 	// This stores the percentage completed for the calculations.
 	double percentComplete = 0;
 
@@ -146,135 +253,60 @@ void runAutoTest(const char* filename, bool gVar, bool tSafe,
 	// We have to do this to avoid overflow due to the gigantic amounts
 	// of calculations that this program can do.
 	double calcsPerMillionth =
-		((double)(max + delta)/2.0)*
-		((double)((max - delta) + 1)/100000000.0);
+		((double)(max + min)/2.0)*
+		((double)((max - min) + 1)/100000000.0);
 
-	// Start n at delta and go from there.
-	n = delta;
-
-	// Start nThreads at MIN_THREADS as well.
-	nThreads = MIN_THREADS;
+	// Start n at min and go from there.
+	n = min;
 
 	// Create an output file stream.
 	ofstream dataDump;
 
-	// Create a temp filename to append the spreadsheet folder location
-	// in front of the desired filename.
-	string tempFilename = SPREADSHEET_FOLDER;
-	// Add a slash to denote that the filename is in a folder.
-	tempFilename += "/";
-	// Add the filename to the total string.
-	tempFilename += filename;
-
-	// Create a file inside of the spreadsheet folder with the name
-	// that was passed by the user.
-	dataDump.open(tempFilename.c_str());
-
-	// Write the top line of the data file...
-	// The first cell is the number of calculations 'n'.
-	dataDump << "n";
-	// The next cells are number of threads and the result calculated
-	// for that number of threads alternating until we have a column for
-	// all values for each thread number.
-	for(unsigned int i = MIN_THREADS; i <= threadNo; i++)
-	{
-		dataDump << ",Time " << i << ",Result " << i;
-	}
-	// Write a new line to prepare for the first line of data.
-	dataDump << "\n";
+	// Create the spreadsheet and write the top line of the data file.
+	openSpreadsheet(dataDump, filename, "n", threadNo);
 
 	// Loop until we have reached max.
 	while(n <= max)
 	{
+		// This copy of n is written to the file, since running a cell
+		// overwrites the global n.
+		unsigned int rowN = n;
+
 		// Save n to our data file.
-		dataDump << n;
+		dataDump << rowN;
 
 		// Stores the last percentage so that we can move the output
 		// on the terminal accordingly.
 		lastPercentage = (int)percentComplete;
 
 		// Loop through the number of threads we use.
-		while(nThreads <= threadNo)
+		for(unsigned int threads = firstThreads; threads <= threadNo; threads++)
 		{
 			// This is where the end result is stored.
 			float endResult;
 
-			// This array stores the integer total that each thread comes to.
-			// These unshared totals are combined and used for the calculation
-			// if global variable use is toggled off (gVarUsed = 0).
-			unsigned int unsharedTotal[nThreads];
-
-			// Array of thread handles. These are used as thread IDs.
-			pthread_t threads[nThreads];
-
-			// Clear the shared variable to zero before using it.
-			SHARED_VARIABLE = 0;
-
-			// Grab the first time stamp.
-			threadTimer.getTime();
-
-			// Set this process's concurrency to the number of threads used.
-			// This is not entirely necessary for parallel execution, but is done
-			// as a precaution, in case the system wants a weird concurrency value.
-			if(pthread_setconcurrency(nThreads) == 0)
-			{
-				// Create nThreads number of threads.
-				for(unsigned int i = 0; i < nThreads; i++)
-				{
-					// Create thread i with handle threads[i] that executes
-					// the sharedIncrementer function and returns its end
-					// increment value in unsharedTotal[i].
-					pthread_create(&threads[i], NULL, calcGenerator, &unsharedTotal[i]);
-				}
-
-				// Wait for threads to finish.
-				for(unsigned int i = 0; i < nThreads; i++)
-				{
-					// This joins the thread with handle threads[i] and won't
-					// go further until it is done.  Needless to say, the program
-					// won't exit this for loop until all threads are done.
-					pthread_join(threads[i], NULL);
-				}
-			}
-
-			// If we are not using a global variable, total the unshared values.
-			if(!gVarUsed)
-			{
-				// Cram them into the global variable that would have
-				// held them if they were shared.
-				for(unsigned int i = 0; i < nThreads; i++)
-				{
-					SHARED_VARIABLE += unsharedTotal[i];
-				}
-			}
-
-			// This is the end result calculation that is talked about at the top of this file.
-			endResult = ((float)SHARED_VARIABLE)/n;
-
-			// Get the second time stamp after the work is done.
-			threadTimer.getTime();
-
-			// Increment the number of threads used.
-			nThreads++;
+			// Run the cell and grab the time it took.
+			unsigned int timeTaken = runRepeatedCell(threads, n, &endResult);
 
 			// Save the time taken and the result.
-			dataDump << "," << threadTimer.timeTaken() << "," << endResult;
+			dataDump << "," << timeTaken << "," << endResult;
 		}
 
 		// Move down to the next line to prepare for the next group of data.
+		// The row is flushed right away so that an interrupted test still
+		// leaves every finished row behind.
 		dataDump << "\n";
-
-		// Reset thread number to MIN_THREADS.
-		nThreads = MIN_THREADS;
+		dataDump.flush();
 
 		// Update the percentage complete.
-		percentComplete += ((double)n/calcsPerMillionth)*((double)delta/1000000.0);
+		percentComplete += ((double)rowN/calcsPerMillionth)*((double)delta/1000000.0);
 
 		// If we have hit or surpassed 100 (eek), cap it at 100.					  
 		if(percentComplete >= 100)
 		{
 			percentComplete = 100;
 		}
+		liveProgress(percentComplete/100.0);
 
 		// Only print if we are ticking over a percent.
 		if((int)percentComplete != lastPercentage)
@@ -284,7 +316,7 @@ void runAutoTest(const char* filename, bool gVar, bool tSafe,
 		}
 
 		// Increment the number of calculations to be done next time.
-		n += delta;
+		n = rowN + delta;
 	}
 
 	// Append an extra new line character to the end of the file.
@@ -294,69 +326,1401 @@ void runAutoTest(const char* filename, bool gVar, bool tSafe,
 	dataDump.close();
 }
 
-// This is the function that all threads run, which does the calculation.
-void* calcGenerator(void* calculation)
+// This function creates the spreadsheet file inside of the spreadsheet
+// folder and writes the top line of the data file. The first columns hold
+// whatever the rows are swept over, which is usually just 'n'.
+void openSpreadsheet(ofstream& dataDump, const char* filename, const char* firstColumns, unsigned int threadNo)
 {
-	// This variable is used to store this thread's calculation.
-	unsigned int unsharedVariable = 0;
+	// Create a temp filename to append the spreadsheet folder location
+	// in front of the desired filename.
+	string tempFilename = SPREADSHEET_FOLDER;
+	// Add a slash to denote that the filename is in a folder.
+	tempFilename += "/";
+	// Add the filename to the total string.
+	tempFilename += filename;
 
-	// Mangle the input parameter to equal something we can work with
-	// and pass back at the end if we are using unshared data.
-	unsigned int* threadResult = (unsigned int*)calculation;
+	// Create a file inside of the spreadsheet folder with the name
+	// that was passed by the user.
+	dataDump.open(tempFilename.c_str());
 
-	// Number of calculations to do.
-	unsigned int calcTotal;				
+	// Write the top line of the data file...
+	// The first cells are what we are sweeping, like the number of
+	// calculations 'n'.
+	dataDump << firstColumns;
+	// The next cells are number of threads and the result calculated
+	// for that number of threads alternating until we have a column for
+	// all values for each thread number.
+	for(unsigned int i = firstThreads; i <= threadNo; i++)
+	{
+		dataDump << ",Time " << i << ",Result " << i;
+	}
+	// Write a new line to prepare for the first line of data.
+	dataDump << "\n";
+}
 
-	// Find out how many calculations this function will do. This is
-	// simply the number of calculations n spread evenly across nThreads.
-	calcTotal = n/nThreads;
+// This function opens the result cache in the spreadsheet folder. If reuse
+// is set, cells that were already measured on this machine with this binary
+// are taken from the cache instead of being measured again.
+bool enableResultCache(bool reuse)
+{
+	// Build the path to the cache file.
+	string cachePath = SPREADSHEET_FOLDER;
+	cachePath += "/";
+	cachePath += CACHE_FILENAME;
 
-	// Do the calculation calcTotal times. If a shared variable is desired,
-	// use it, otherwise pass the value back to main through threadResult.
-	if(gVarUsed)
-	{
-		// If the user wants thread safety, lock the mutex before
-		// doing anything to the shared variable.  If another thread
-		// has control of the mutex, this thread will block and wait
-		// at this mutex call.  This is potentially dangerous, as it
-		// will cause a deadlock if the other thread never unlocks
-		// the mutex.  This makes unlocking when we're done very important.
-		if(threadSafe)
-		{
-			pthread_mutex_lock(&sharedVarMutex);
-		}
+	// The scenario mode opens it for every scenario, and a fresh open
+	// picks up the cells that the last scenario added.
+	delete cellCache;
+	cellCache = new resultCache;
 
-		// Do the calculation calcTotal times.
-		for(unsigned int i = 0; i < calcTotal; i++)
+	// If we can't open it, carry on without it.
+	if(!cellCache->open(cachePath.c_str(), reuse))
+	{
+		delete cellCache;
+		cellCache = NULL;
+		return false;
+	}
+
+	return true;
+}
+
+// This function returns the number of cells taken from the cache so far.
+unsigned int cachedCellsReused(void)
+{
+	return (cellCache ? cellCache->reusedCells() : 0);
+}
+
+// This function opens a binary results file in the spreadsheet folder.
+// Every cell of an automatic test gets a row in it, next to the spreadsheet.
+bool enableBinaryResults(const char* filename)
+{
+	// Build the path to the results file.
+	string binaryPath = SPREADSHEET_FOLDER;
+	binaryPath += "/";
+	binaryPath += filename;
+
+	binaryResults = new resultsWriter;
+
+	// One row per cell.
+	binaryN = binaryResults->addColumn("n", COLUMN_U32);
+	binaryThreads = binaryResults->addColumn("threads", COLUMN_U32);
+	binaryTime = binaryResults->addColumn("time_usec", COLUMN_U32);
+	binaryResult = binaryResults->addColumn("result", COLUMN_F32);
+	binaryCsNsecs = binaryResults->addColumn("cs_nsecs", COLUMN_U32);
+	binaryParNsecs = binaryResults->addColumn("par_nsecs", COLUMN_U32);
+
+	// If we can't open it, carry on without it.
+	if(!binaryResults->open(binaryPath.c_str()))
+	{
+		delete binaryResults;
+		binaryResults = NULL;
+		return false;
+	}
+
+	return true;
+}
+
+// This function adds a cell to the binary results file and the combined
+// results file, if they are open.
+void recordBinaryCell(unsigned int calcs, unsigned int threadNo, unsigned int time, float result)
+{
+	if(combinedResults)
+	{
+		const char* workload = activeDataWorkload();
+
+		combinedDump << combinedScenario << "," << (workload ? workload : "increment") << ","
+			     << gVarUsed << "," << threadSafe << ","
+			     << (processShared ? (atomicShared ? "atomic" : "mutex") : "no") << ","
+			     << calcs << "," << threadNo << "," << csNsecs << "," << parNsecs << ","
+			     << cellRepetition << "," << time << "," << result << "\n";
+	}
+
+	if(binaryResults)
+	{
+		binaryResults->setU32(binaryN, calcs);
+		binaryResults->setU32(binaryThreads, threadNo);
+		binaryResults->setU32(binaryTime, time);
+		binaryResults->setF32(binaryResult, result);
+		binaryResults->setU32(binaryCsNsecs, csNsecs);
+		binaryResults->setU32(binaryParNsecs, parNsecs);
+		binaryResults->endRow();
+	}
+}
+
+// This function closes the binary results file if it is open.
+void finishBinaryResults(void)
+{
+	if(binaryResults)
+	{
+		binaryResults->close();
+		delete binaryResults;
+		binaryResults = NULL;
+	}
+}
+
+// This function opens the combined results file of the scenario mode in
+// the spreadsheet folder. Every cell of every scenario gets a row in it,
+// with the scenario and everything that sets the cell apart from others.
+bool enableCombinedResults(const char* filename)
+{
+	// Create a temp filename to append the spreadsheet folder location
+	// in front of the desired filename.
+	string tempFilename = SPREADSHEET_FOLDER;
+	tempFilename += "/";
+	tempFilename += filename;
+
+	combinedDump.open(tempFilename.c_str());
+
+	if(!combinedDump)
+	{
+		return false;
+	}
+
+	combinedDump << "Scenario,Workload,Shared,Safe,Processes,n,Threads,CS (ns),Parallel (ns),Rep,Time (us),Result\n";
+	combinedResults = true;
+
+	return true;
+}
+
+// This function sets the scenario that the next cells belong to.
+void setCombinedScenario(const char* name)
+{
+	combinedScenario = name;
+}
+
+// This function closes the combined results file if it is open.
+void finishCombinedResults(void)
+{
+	if(combinedResults)
+	{
+		combinedDump << "\n";
+		combinedDump.close();
+		combinedResults = false;
+	}
+}
+
+// This function sets the fewest threads that the automatic tests sweep
+// from. Every row still has a column for each thread count from there on.
+void setFirstThreads(unsigned int first)
+{
+	firstThreads = ((first >= MIN_THREADS) && (first <= MAX_THREADS)) ? first : MIN_THREADS;
+}
+
+// This function builds the key that identifies the configuration of a
+// cell in the result cache. Anything that changes what a cell measures
+// has to be part of it.
+string cellKey(unsigned int threadNo, unsigned int calcs)
+{
+	stringstream key;
+
+	key << "increment"
+	    << " shared=" << gVarUsed
+	    << " safe=" << threadSafe
+	    << " threads=" << threadNo
+	    << " n=" << calcs
+	    << " cs=" << csNsecs
+	    << " par=" << parNsecs;
+
+	// A surface cell locks for every calculation, even with no work.
+	if(lockPerCalc)
+	{
+		key << " percalc=1";
+	}
+
+	// Every repetition after the first is a cell of its own, so that the
+	// first one still matches what was cached before repetitions.
+	if(cellRepetition)
+	{
+		key << " rep=" << cellRepetition;
+	}
+
+	return key.str();
+}
+
+// This function turns on the throttling check for automatic tests. It only
+// turns on if the cgroup has a CPU quota, since nothing is throttled without
+// one. From then on, every cell that is measured is checked, and gets a row
+// in the throttle spreadsheet, which is named filename.
+bool enableThrottleCheck(const char* filename)
+{
+	throttleSample sample;
+
+	if(!cgroupThrottleSample(&sample))
+	{
+		return false;
+	}
+
+	// Create a temp filename to append the spreadsheet folder location
+	// in front of the desired filename.
+	string tempFilename = SPREADSHEET_FOLDER;
+	tempFilename += "/";
+	tempFilename += filename;
+
+	throttleDump.open(tempFilename.c_str());
+	throttleDump << "n,Threads,Attempts,Throttled Periods,Throttled Time (us),Status\n";
+	throttleChecked = true;
+
+	return true;
+}
+
+// This function turns the throttling check back off and closes the throttle
+// spreadsheet.
+void finishThrottleCheck(void)
+{
+	if(throttleChecked)
+	{
+		throttleDump << "\n";
+		throttleDump.close();
+		throttleChecked = false;
+	}
+}
+
+// This function measures a cell, and if the throttling check is on, makes
+// sure that the cgroup's CPU quota didn't stop the threads while it ran. A
+// throttled cell measured the quota instead of the threads, so it is tried
+// again, up to THROTTLE_ATTEMPTS times, after waiting out a quota period so
+// that the next try starts with a full quota. If every try was throttled,
+// the last one is kept and throttled is set.
+static unsigned int measureUnthrottled(unsigned int threadNo, unsigned int calcs, float* result, bool* throttled)
+{
+	if(!throttleChecked)
+	{
+		return measureCell(threadNo, calcs, result);
+	}
+
+	unsigned int timeTaken = 0;
+	unsigned int attempts = 0;
+	throttleSample before, after;
+	unsigned long long periods = 0;
+	unsigned long long usecs = 0;
+
+	while(attempts < THROTTLE_ATTEMPTS)
+	{
+		attempts++;
+
+		cgroupThrottleSample(&before);
+		timeTaken = measureCell(threadNo, calcs, result);
+		cgroupThrottleSample(&after);
+
+		periods = after.throttled - before.throttled;
+		usecs = after.throttledUsecs - before.throttledUsecs;
+
+		if(periods == 0)
 		{
-			// This is where the calculation happens if a shared variable
-			// is used. We simply increment the shared variable here.
-			SHARED_VARIABLE++;
+			break;
 		}
 
-		// If we locked the mutex, we need to unlock it
-		// so that other threads can use the shared variable.
-		if(threadSafe)
+		// Only wait if there is another try coming.
+		if(attempts < THROTTLE_ATTEMPTS)
 		{
-			pthread_mutex_unlock(&sharedVarMutex);
+			usleep(cgroupQuotaPeriod());
 		}
 	}
+
+	*throttled = (periods > 0);
+
+	throttleDump << calcs << "," << threadNo << "," << attempts << ","
+		     << periods << "," << usecs << ","
+		     << (*throttled ? "throttled" : ((attempts > 1) ? "retried" : "ok")) << "\n";
+	throttleDump.flush();
+
+	if(*throttled)
+	{
+		cout << "WARNING: The cell with n = " << calcs << " and " << threadNo
+		     << " threads was throttled by the CPU quota every time.\n";
+	}
+
+	return timeTaken;
+}
+
+// This function turns on the clock speed check for automatic tests. From
+// then on, the clock speed is measured before and after every cell that is
+// measured, and the cell gets a row in the clock spreadsheet, which is named
+// filename.
+bool enableClockCheck(const char* filename)
+{
+	// Create a temp filename to append the spreadsheet folder location
+	// in front of the desired filename.
+	string tempFilename = SPREADSHEET_FOLDER;
+	tempFilename += "/";
+	tempFilename += filename;
+
+	clockDump.open(tempFilename.c_str());
+
+	if(!clockDump)
+	{
+		return false;
+	}
+
+	clockDump << "n,Threads,Time (us),CPU,Loop MHz Before,Loop MHz After,"
+		  << "APERF MHz Before,APERF MHz After,Source,Drift (%),Cycles/Op\n";
+	clockChecked = true;
+
+	return true;
+}
+
+// This function turns the clock speed check back off and closes the clock
+// spreadsheet.
+void finishClockCheck(void)
+{
+	if(clockChecked)
+	{
+		clockDump << "\n";
+		clockDump.close();
+		clockChecked = false;
+	}
+}
+
+// This function writes a cell's clock speeds to the clock spreadsheet. The
+// cell ran at somewhere between the speed before it and the speed after it,
+// so the average of the two turns its time into cycles. The drift is how
+// far the speed moved while the cell ran. Both sides come from the same
+// source, which is named in the row.
+static void recordClockCell(unsigned int threadNo, unsigned int calcs, unsigned int usecs,
+			    const clockReading& before, const clockReading& after)
+{
+	bool msr = clockUsesMsr(before, after);
+	double mhzBefore = (msr ? before.msrMhz : before.loopMhz);
+	double mhzAfter = (msr ? after.msrMhz : after.loopMhz);
+	double cycles = usecs*(mhzBefore + mhzAfter)/2.0;
+
+	clockDump << calcs << "," << threadNo << "," << usecs << "," << before.cpu << ","
+		  << before.loopMhz << "," << after.loopMhz << ",";
+
+	if((before.msrMhz > 0) && (after.msrMhz > 0))
+	{
+		clockDump << before.msrMhz << "," << after.msrMhz << ",";
+	}
 	else
 	{
-		// Do the calculation calcTotal times.
-		for(unsigned int i = 0; i < calcTotal; i++)
-		{
-			// This is where each calculation is carried out if the user
-			// wants to use unshared variables.
-			unsharedVariable++;
-		}
+		clockDump << "n/a,n/a,";
+	}
 
-		// Pass back the unshared variable via the pointer we created
-		// to point in the same direction as the input parameter.
-		// This statement just says to make the unsigned int that
-		// threadResult is pointing to equal to unsharedVariable.
-		*threadResult = unsharedVariable;
+	clockDump << (msr ? "APERF" : "loop") << "," << 100.0*(mhzAfter - mhzBefore)/mhzBefore << ","
+		  << cycles/calcs << "\n";
+	clockDump.flush();
+}
+
+// This function turns on the lost update count for automatic tests. From
+// then on, every cell that is measured gets a row in the lost update
+// spreadsheet, which is named filename, with exactly how many increments
+// went missing. With tagged on, the unsafe shared increments are tagged too.
+bool enableLostCheck(const char* filename, bool tagged)
+{
+	// Create a temp filename to append the spreadsheet folder location
+	// in front of the desired filename.
+	string tempFilename = SPREADSHEET_FOLDER;
+	tempFilename += "/";
+	tempFilename += filename;
+
+	lostDump.open(tempFilename.c_str());
+
+	if(!lostDump)
+	{
+		return false;
+	}
+
+	// The averages are written out in full, not as 1e+06.
+	lostDump.setf(ios::fixed);
+	lostDump.precision(2);
+
+	lostDump << "n,Threads,Expected,Counted,Lost,Lost (%)";
+	if(tagged)
+	{
+		lostDump << ",Windows,Increments/Window,Longest Window,Lost/Window";
 	}
+	lostDump << "\n";
+
+	lostChecked = true;
+	taggedWrites = tagged;
+
+	return true;
+}
+
+// This function turns the lost update count back off and closes the lost
+// update spreadsheet.
+void finishLostCheck(void)
+{
+	if(lostChecked)
+	{
+		lostDump << "\n";
+		lostDump.close();
+		lostChecked = false;
+		taggedWrites = false;
+	}
+}
+
+// This function returns whether the cell being run has its shared
+// increments tagged. Only unsafe increments of a shared variable in threads
+// are, since the safe ones can't lose anything, and processes don't share
+// the tagged word.
+static bool taggingCell(void)
+{
+	return (taggedWrites && gVarUsed && !threadSafe && !processShared);
+}
+
+// This function writes how many increments the last cell lost to the lost
+// update spreadsheet. Every window is a time that a thread found the shared
+// word last written by someone else, so the lost increments per window is
+// how much a racy counter loses every time the cache line changes hands.
+static void recordLostCell(unsigned int threadNo, unsigned int calcs)
+{
+	long long lost = (long long)cellExpected - (long long)cellCounted;
+
+	lostDump << calcs << "," << threadNo << "," << cellExpected << "," << cellCounted << ","
+		 << lost << "," << (cellExpected ? 100.0*lost/cellExpected : 0);
+
+	if(taggedWrites)
+	{
+		if(taggingCell())
+		{
+			unsigned long long windows = 0, longest = 0;
+
+			for(unsigned int i = 0; i < threadNo; i++)
+			{
+				windows += taggedThreads[i].windows;
+				longest = (taggedThreads[i].longestRun > longest) ? taggedThreads[i].longestRun : longest;
+			}
+
+			lostDump << "," << windows << "," << (windows ? (double)cellExpected/windows : 0)
+				 << "," << longest << "," << (windows ? (double)lost/windows : 0);
+		}
+		else
+		{
+			lostDump << ",n/a,n/a,n/a,n/a";
+		}
+	}
+
+	lostDump << "\n";
+	lostDump.flush();
+}
+
+// This function returns whether the cell about to be run can use the
+// result cache. A cell that writes more than its time and result somewhere
+// has to be measured every time, since the rest only comes from measuring.
+static bool cellCacheable(void)
+{
+	if(!cellCache)
+	{
+		return false;
+	}
+
+	// Process cells have a row in the per process spreadsheet.
+	if(processShared)
+	{
+		return false;
+	}
+
+	// Lost update cells have a row in the lost update spreadsheet, and
+	// tagged ones run a slower kernel than the plain increments.
+	if(lostChecked)
+	{
+		return false;
+	}
+
+	// Data parallel cells have a row in the data spreadsheet.
+	if(activeDataWorkload())
+	{
+		return false;
+	}
+
+	// Clock cells have a row in the clock spreadsheet.
+	if(clockChecked)
+	{
+		return false;
+	}
+
+	// Traced cells have slices in the trace, and the recorder adds its own
+	// time to theirs, so they are neither reused nor kept.
+	if(traceEnabled())
+	{
+		return false;
+	}
+
+	return true;
+}
+
+// This function runs a single cell of an automatic test, which is threadNo
+// threads splitting calcs calculations between them. The end result is
+// stored where result points, and the time taken in microseconds is returned.
+// If the result cache has this cell already, it is reused instead, and if
+// not, the new cell is added to the cache as soon as it is done. Cells that
+// cellCacheable turns down skip the cache. With live stats on, cells can
+// still be reused, but the ones measured are not kept, since every worker's
+// counter updates are part of their time.
+unsigned int runCell(unsigned int threadNo, unsigned int calcs, float* result)
+{
+	cachedCell cell;
+	string key;
+	bool cached = cellCacheable();
+
+	// See if we already did this one.
+	if(cached)
+	{
+		key = cellKey(threadNo, calcs);
+
+		if(cellCache->lookup(key, &cell))
+		{
+			// Count it as done in the live stats all the same.
+			liveCellBegin(calcs, threadNo);
+			liveCellEnd(calcs, cell.time);
+
+			*result = cell.result;
+			return cell.time;
+		}
+	}
+
+	// Do it for real, with the clock speed on either side if it is wanted.
+	// Both sides are measured on the same core, which is one that a
+	// worker was on, so that they can be compared.
+	clockReading clockBefore, clockAfter;
+	if(clockChecked)
+	{
+		readClockSpeed(&clockBefore, __atomic_load_n(&lastWorkerCpu, __ATOMIC_RELAXED));
+	}
+
+	bool throttled = false;
+	cell.time = measureUnthrottled(threadNo, calcs, &cell.result, &throttled);
+	*result = cell.result;
+
+	if(clockChecked)
+	{
+		readClockSpeed(&clockAfter, clockBefore.cpu);
+		recordClockCell(threadNo, calcs, cell.time, clockBefore, clockAfter);
+	}
+
+	if(lostChecked)
+	{
+		recordLostCell(threadNo, calcs);
+	}
+
+	// Record it so that nobody has to do it again. A throttled cell, or
+	// one that was slowed by the live stats, is left out, so that the
+	// next run measures it again.
+	if(cached && !throttled && !liveStatsEnabled())
+	{
+		cellCache->store(key, cell);
+	}
+
+	return cell.time;
+}
+
+// This function sets how many times runRepeatedCell measures each cell.
+void setCellRepetitions(unsigned int repetitions)
+{
+	cellRepetitions = (repetitions > 0) ? repetitions : 1;
+}
+
+// This function runs a cell as many times as setCellRepetitions said to,
+// and gives every repetition its own row in the binary results file, which
+// is where the compare mode gets its samples from. The spreadsheet only has
+// room for one time per cell, so the median time is returned, along with
+// the worst result.
+unsigned int runRepeatedCell(unsigned int threadNo, unsigned int calcs, float* result)
+{
+	vector<unsigned int> times(cellRepetitions);
+
+	*result = 1.0f;
+
+	for(cellRepetition = 0; cellRepetition < cellRepetitions; cellRepetition++)
+	{
+		float repetitionResult;
+
+		times[cellRepetition] = runCell(threadNo, calcs, &repetitionResult);
+		recordBinaryCell(calcs, threadNo, times[cellRepetition], repetitionResult);
+
+		*result = (repetitionResult < *result) ? repetitionResult : *result;
+	}
+
+	cellRepetition = 0;
+
+	sort(times.begin(), times.end());
+	return times[cellRepetitions/2];
+}
+
+// This function measures a single cell of an automatic test, which is
+// threadNo threads splitting calcs calculations between them.
+unsigned int measureCell(unsigned int threadNo, unsigned int calcs, float* result)
+{
+	// The data parallel workloads are measured their own way.
+	if(activeDataWorkload())
+	{
+		return measureDataCell(threadNo, calcs, result);
+	}
+
+	// Processes are measured their own way.
+	if(processShared)
+	{
+		return measureProcessCell(threadNo, calcs, result);
+	}
+
+	// Store the passed values into the global variables for the threads.
+	nThreads = threadNo;
+	n = calcs;
+
+	// Create an instance of timeStamp.
+	timeStamp threadTimer;
+
+	// This array stores the integer total that each thread comes to.
+	// These unshared totals are combined and used for the calculation
+	// if global variable use is toggled off (gVarUsed = 0).
+	unsigned int unsharedTotal[nThreads];
+
+	// Array of thread handles. These are used as thread IDs.
+	pthread_t threads[nThreads];
+
+	// Clear the shared variable to zero before using it.
+	SHARED_VARIABLE = 0;
+
+	// Clear the tagged word too, if we are tagging.
+	if(taggingCell())
+	{
+		taggedWord = 0;
+		taggedNextId = 0;
+		memset(taggedThreads, 0, sizeof(taggedThreads));
+	}
+
+	// Mark the cell on the trace and in the live stats, if they are on.
+	traceCellBegin(calcs, threadNo);
+	liveCellBegin(calcs, threadNo);
+
+	// Grab the first time stamp.
+	threadTimer.getTime();
+
+	// Set this process's concurrency to the number of threads used.
+	// This is not entirely necessary for parallel execution, but is done
+	// as a precaution, in case the system wants a weird concurrency value.
+	if(pthread_setconcurrency(nThreads) == 0)
+	{
+		// Create nThreads number of threads.
+		for(unsigned int i = 0; i < nThreads; i++)
+		{
+			// Create thread i with handle threads[i] that executes
+			// the sharedIncrementer function and returns its end
+			// increment value in unsharedTotal[i].
+			pthread_create(&threads[i], NULL, calcGenerator, &unsharedTotal[i]);
+		}
+
+		// Wait for threads to finish.
+		for(unsigned int i = 0; i < nThreads; i++)
+		{
+			// This joins the thread with handle threads[i] and won't
+			// go further until it is done.  Needless to say, the program
+			// won't exit this for loop until all threads are done.
+			pthread_join(threads[i], NULL);
+		}
+	}
+
+	traceCellEnd();
+
+	// The tagged word holds the count instead of the shared variable.
+	if(taggingCell())
+	{
+		SHARED_VARIABLE = taggedWord & ((1ULL << TAG_COUNT_BITS) - 1);
+	}
+
+	// If we are not using a global variable, total the unshared values.
+	if(!gVarUsed)
+	{
+		// Cram them into the global variable that would have
+		// held them if they were shared.
+		for(unsigned int i = 0; i < nThreads; i++)
+		{
+			SHARED_VARIABLE += unsharedTotal[i];
+		}
+	}
+
+	// This is the end result calculation that is talked about at the top of this file.
+	*result = ((float)SHARED_VARIABLE)/n;
+
+	// The exact count, for the lost update spreadsheet. Every thread does
+	// n/nThreads calculations, so that is what we should have.
+	cellExpected = (unsigned long long)(n/nThreads)*nThreads;
+	cellCounted = SHARED_VARIABLE;
+
+	// Get the second time stamp after the work is done.
+	threadTimer.getTime();
+
+	// Return the time taken.
+	unsigned int timeTaken = threadTimer.timeTaken();
+	liveCellEnd(calcs, timeTaken);
+
+	return timeTaken;
+}
+
+// This function turns on processes for automatic tests. Every cell from
+// now on forks its workers instead of starting threads, and gets a row in
+// the per process spreadsheet, which is named filename.
+bool enableProcessMode(const char* filename, bool atomic)
+{
+	processShared = createProcessSegment();
+
+	if(!processShared)
+	{
+		return false;
+	}
+
+	atomicShared = atomic;
+
+	// Create a temp filename to append the spreadsheet folder location
+	// in front of the desired filename.
+	string tempFilename = SPREADSHEET_FOLDER;
+	tempFilename += "/";
+	tempFilename += filename;
+
+	processDump.open(tempFilename.c_str());
+	processDump << "n,Processes,Minor Faults/Process,Major Faults/Process,dTLB Misses/Process,Status\n";
+
+	return true;
+}
+
+// This function turns processes back off and closes the per process
+// spreadsheet.
+void finishProcessMode(void)
+{
+	if(processShared)
+	{
+		processDump << "\n";
+		processDump.close();
+
+		destroyProcessSegment(processShared);
+		processShared = NULL;
+		atomicShared = false;
+	}
+}
+
+// This function measures a single cell of an automatic test with processes,
+// which is processNo forked processes splitting calcs calculations between
+// them. The time includes forking them and waiting for them to exit, since
+// that is what using processes costs.
+unsigned int measureProcessCell(unsigned int processNo, unsigned int calcs, float* result)
+{
+	// Store the passed values into the global variables. The children
+	// get their own copies of them when they are forked.
+	nThreads = processNo;
+	n = calcs;
+
+	// Create an instance of timeStamp.
+	timeStamp processTimer;
+
+	// The process IDs of the children.
+	pid_t children[processNo];
+
+	// Clear the shared segment before using it.
+	processShared->sharedVariable = 0;
+	for(unsigned int i = 0; i < processNo; i++)
+	{
+		processShared->results[i] = 0;
+		processShared->tlbMisses[i] = 0;
+		processShared->tlbCounted[i] = 0;
+	}
+
+	processFailed = false;
+
+	// Anything still in the output buffers would be printed again by
+	// every child, so get it out first.
+	cout.flush();
+	liveCellBegin(calcs, processNo);
+
+	// Grab the first time stamp.
+	processTimer.getTime();
+
+	for(unsigned int i = 0; i < processNo; i++)
+	{
+		children[i] = fork();
+
+		if(children[i] == 0)
+		{
+			// This is the child. Point calcGenerator at the shared
+			// segment and run it, just like a thread would.
+			sharedVariable = &processShared->sharedVariable;
+			sharedMutex = &processShared->mutex;
+
+			int counter = startTlbCounter();
+			calcGenerator(&processShared->results[i]);
+			processShared->tlbMisses[i] = stopTlbCounter(counter);
+			processShared->tlbCounted[i] = (counter >= 0);
+
+			// Leave without running any of the parent's clean up.
+			_exit(0);
+		}
+		else if(children[i] < 0)
+		{
+			cout << "WARNING: Process " << i + 1 << " could not be forked.\n";
+			processFailed = true;
+		}
+	}
+
+	// Wait for the children to finish, and collect their page faults.
+	unsigned long long minorFaults = 0;
+	unsigned long long majorFaults = 0;
+
+	for(unsigned int i = 0; i < processNo; i++)
+	{
+		struct rusage usage;
+		int status;
+
+		if((children[i] > 0) && (wait4(children[i], &status, 0, &usage) == children[i]))
+		{
+			minorFaults += usage.ru_minflt;
+			majorFaults += usage.ru_majflt;
+		}
+		else if(children[i] > 0)
+		{
+			cout << "WARNING: Process " << i + 1 << " could not be waited for.\n";
+			processFailed = true;
+		}
+	}
+
+	// Total the results the same way measureCell does.
+	unsigned int total = processShared->sharedVariable;
+	if(!gVarUsed)
+	{
+		total = 0;
+		for(unsigned int i = 0; i < processNo; i++)
+		{
+			total += processShared->results[i];
+		}
+	}
+
+	// This is the end result calculation that is talked about at the top of this file.
+	*result = ((float)total)/n;
+
+	// The exact count, for the lost update spreadsheet.
+	cellExpected = (unsigned long long)(n/nThreads)*nThreads;
+	cellCounted = total;
+
+	// Get the second time stamp after the work is done.
+	processTimer.getTime();
+
+	// Write the per process costs.
+	unsigned long long tlbMisses = 0;
+	bool tlbCounted = true;
+
+	for(unsigned int i = 0; i < processNo; i++)
+	{
+		tlbMisses += processShared->tlbMisses[i];
+		tlbCounted = tlbCounted && processShared->tlbCounted[i];
+	}
+
+	processDump << calcs << "," << processNo << ","
+		    << (double)minorFaults/processNo << ","
+		    << (double)majorFaults/processNo << ",";
+	if(tlbCounted)
+	{
+		processDump << (double)tlbMisses/processNo;
+	}
+	else
+	{
+		processDump << "n/a";
+	}
+	processDump << "," << (processFailed ? "failed" : "ok") << "\n";
+	processDump.flush();
+
+	// Return the time taken.
+	unsigned int timeTaken = processTimer.timeTaken();
+	liveCellEnd(calcs, timeTaken);
+
+	return timeTaken;
+}
+
+// This function runs an adaptive automatic test. Instead of stepping n by
+// a fixed delta, a sweepPlanner picks the values of n to measure until the
+// time budget runs out. The rows are written to the spreadsheet sorted by n.
+void runAdaptiveTest(const char* filename, bool gVar, bool tSafe,
+		     unsigned int min, unsigned int max, unsigned int threadNo,
+		     unsigned int budgetSecs)
+{
+	// Store the passed values into the global variable equivalents.
+	gVarUsed = gVar;
+	threadSafe = tSafe;
+
+	// The number of thread counts in each row.
+	unsigned int threadCounts = (threadNo - firstThreads) + 1;
+
+	// The planner that picks our values of n.
+	sweepPlanner planner(min, max, firstThreads, threadCounts, budgetSecs);
+
+	// These store the measurements of the current row.
+	unsigned int times[threadCounts];
+	float results[threadCounts];
+
+	// The value of n that we are measuring next.
+	unsigned int rowN;
+
+	// Stores the previous percentage for comparison when we are
+	// re-printing the percentage to the terminal.
+	int lastPercentage = 0;
+
+	// Keep going until the planner says we are done.
+	while(planner.nextN(&rowN))
+	{
+		// The time the row took. Cells that come out of the cache cost
+		// nothing now, but the planner still needs to know what they
+		// cost when they were measured, so we total the cell times.
+		unsigned long long rowNsecs = 0;
+
+		// Measure every thread count for this value of n.
+		for(unsigned int i = 0; i < threadCounts; i++)
+		{
+			times[i] = runCell(firstThreads + i, rowN, &results[i]);
+			rowNsecs += (unsigned long long)times[i]*1000ULL;
+		}
+
+		// Hand the row to the planner so it can decide what is next.
+		planner.recordRow(rowN, times, results, rowNsecs);
+		liveProgress(planner.budgetUsed()/100.0);
+
+		// Only print if we are ticking over a percent.
+		if((int)planner.budgetUsed() != lastPercentage)
+		{
+			lastPercentage = (int)planner.budgetUsed();
+			cout << "Budget Used: " << lastPercentage << "% ("
+			     << planner.rowCount() << " samples)\n";
+		}
+	}
+
+	// Create an output file stream.
+	ofstream dataDump;
+
+	// Create the spreadsheet and write the top line of the data file.
+	openSpreadsheet(dataDump, filename, "n", threadNo);
+
+	// Write every row in order of n.
+	for(unsigned int r = 0; r < planner.rowCount(); r++)
+	{
+		const sweepRow& row = planner.row(r);
+
+		dataDump << row.n;
+
+		for(unsigned int i = 0; i < threadCounts; i++)
+		{
+			dataDump << "," << row.times[i] << "," << row.results[i];
+			recordBinaryCell(row.n, firstThreads + i, row.times[i], row.results[i]);
+		}
+
+		dataDump << "\n";
+	}
+
+	// Append an extra new line character to the end of the file.
+	dataDump << "\n";
+
+	// Close the file.
+	dataDump.close();
+}
+
+// This function sets the synthetic work done for each calculation, inside
+// of the critical section and outside of it. With no synthetic work, the
+// threads hold the lock for their whole share, the way they always have.
+// With some, every calculation takes the lock on its own.
+void setSyntheticWork(unsigned int criticalNsecs, unsigned int parallelNsecs)
+{
+	csNsecs = criticalNsecs;
+	parNsecs = parallelNsecs;
+	csLoops = workLoopsFor(csNsecs);
+	parLoops = workLoopsFor(parNsecs);
+}
+
+// This function fills a list with the amounts of synthetic work that a
+// surface test sweeps over: none, and then doubling up to max.
+static void workSteps(unsigned int max, vector<unsigned int>& steps)
+{
+	steps.push_back(0);
+
+	for(unsigned int work = WORK_SWEEP_MIN; (work < max) && (max > 0); work *= 2)
+	{
+		steps.push_back(work);
+	}
+
+	if(max > 0)
+	{
+		steps.push_back(max);
+	}
+}
+
+// This function runs an automatic contention surface test. At a fixed n,
+// it sweeps the synthetic work inside of the critical section and outside
+// of it, and measures every thread count at every point of the surface.
+void runWorkSurfaceTest(const char* filename, bool gVar, bool tSafe,
+			unsigned int calcs, unsigned int threadNo,
+			unsigned int csMax, unsigned int parMax)
+{
+	// Store the passed values into the global variable equivalents.
+	gVarUsed = gVar;
+	threadSafe = tSafe;
+
+	// The amounts of work we sweep over.
+	vector<unsigned int> csSteps, parSteps;
+	workSteps(csMax, csSteps);
+	workSteps(parMax, parSteps);
+
+	// Stores the previous percentage for comparison when we are
+	// re-printing the percentage to the terminal.
+	int lastPercentage = 0;
+	unsigned int pointsDone = 0;
+	unsigned int pointCount = csSteps.size()*parSteps.size();
+
+	// Create an output file stream.
+	ofstream dataDump;
+
+	// Create the spreadsheet and write the top line of the data file.
+	openSpreadsheet(dataDump, filename, "n,CS (ns),Parallel (ns)", threadNo);
+
+	// Every point of the surface locks the same way, so that the point
+	// with no work is the floor of the others and not a different test.
+	lockPerCalc = true;
+
+	for(unsigned int c = 0; c < csSteps.size(); c++)
+	{
+		for(unsigned int p = 0; p < parSteps.size(); p++)
+		{
+			setSyntheticWork(csSteps[c], parSteps[p]);
+
+			dataDump << calcs << "," << csNsecs << "," << parNsecs;
+
+			for(unsigned int threads = firstThreads; threads <= threadNo; threads++)
+			{
+				float endResult;
+				unsigned int timeTaken = runRepeatedCell(threads, calcs, &endResult);
+
+				dataDump << "," << timeTaken << "," << endResult;
+			}
+
+			dataDump << "\n";
+			dataDump.flush();
+
+			// Only print if we are ticking over a percent.
+			pointsDone++;
+			liveProgress((double)pointsDone/pointCount);
+			if((int)(100*pointsDone/pointCount) != lastPercentage)
+			{
+				lastPercentage = (int)(100*pointsDone/pointCount);
+				cout << "Percentage Complete: " << lastPercentage << "%\n";
+			}
+		}
+	}
+
+	lockPerCalc = false;
+	setSyntheticWork(0, 0);
+
+	// Append an extra new line character to the end of the file.
+	dataDump << "\n";
+
+	// Close the file.
+	dataDump.close();
+}
+
+// This function returns where the chunk of calculations that starts at done
+// ends, which is chunkSize later or at calcTotal, whichever comes first.
+static inline unsigned int nextChunkEnd(unsigned int done, unsigned int chunkSize, unsigned int calcTotal)
+{
+	return (((calcTotal - done) > chunkSize) ? (done + chunkSize) : calcTotal);
+}
+
+// This function publishes a worker's progress to its live stats counter,
+// if it has one, and returns the progress.
+static inline unsigned int publishProgress(volatile unsigned long long* progress, unsigned int done)
+{
+	if(progress)
+	{
+		__atomic_store_n(progress, done, __ATOMIC_RELAXED);
+	}
+
+	return done;
+}
+
+// This function is the unsafe increment with a tag. It reads the shared word
+// and writes back one more than its count with our own tag, just as racily
+// as a plain increment, but with atomics so that the compiler can't merge
+// the increments. If the tag that we read isn't the one that we wrote last,
+// someone else had the word since, and a new window starts.
+static inline void taggedIncrement(taggedThread* state, unsigned long long id)
+{
+	const unsigned long long countMask = (1ULL << TAG_COUNT_BITS) - 1;
+	const unsigned long long sequenceMask = (1ULL << TAG_SEQUENCE_BITS) - 1;
+	unsigned long long word = __atomic_load_n(&taggedWord, __ATOMIC_RELAXED);
+
+	if((word >> TAG_COUNT_BITS) != state->lastTag)
+	{
+		state->windows++;
+		state->run = 0;
+	}
+
+	state->run++;
+	state->longestRun = (state->run > state->longestRun) ? state->run : state->longestRun;
+
+	state->sequence++;
+	state->lastTag = (id << TAG_SEQUENCE_BITS) | (state->sequence & sequenceMask);
+
+	__atomic_store_n(&taggedWord, (((word & countMask) + 1) & countMask) | (state->lastTag << TAG_COUNT_BITS),
+			 __ATOMIC_RELAXED);
+}
+
+// This is the function that all threads run, which does the calculation.
+void* calcGenerator(void* calculation)
+{
+	// This variable is used to store this thread's calculation.
+	unsigned int unsharedVariable = 0;
+
+	// Mangle the input parameter to equal something we can work with
+	// and pass back at the end if we are using unshared data.
+	unsigned int* threadResult = (unsigned int*)calculation;
+
+	// Number of calculations to do.
+	unsigned int calcTotal;				
+
+	// Find out how many calculations this function will do. This is
+	// simply the number of calculations n spread evenly across nThreads.
+	calcTotal = n/nThreads;
+
+	// If the trace recorder is on, every lock and every chunk of
+	// calculations is recorded. This is only looked up once.
+	bool traced = traceEnabled();
+	if(traced)
+	{
+		traceThreadBegin();
+	}
+
+	// If the live stats are on, this is where our progress goes. The
+	// loops below publish it every LIVE_CHUNK calculations, and without
+	// live stats, the whole share is one chunk and the loops are as tight
+	// as they always were.
+	volatile unsigned long long* progress = liveThreadCounter();
+	unsigned int chunkSize = (progress ? LIVE_CHUNK : calcTotal);
+
+	// If the unsafe increments are tagged, take the next thread id. Our
+	// last tag starts out as one that nobody writes, so that our first
+	// increment starts a window.
+	taggedThread* tagState = NULL;
+	unsigned long long tagId = 0;
+	if(taggingCell())
+	{
+		tagId = __atomic_fetch_add(&taggedNextId, 1, __ATOMIC_RELAXED);
+		tagState = &taggedThreads[tagId];
+		tagState->lastTag = ~0ULL;
+	}
+
+	// Do the calculation calcTotal times. If a shared variable is desired,
+	// use it, otherwise pass the value back to main through threadResult.
+	if(lockPerCalc || (csLoops > 0) || (parLoops > 0))
+	{
+		// With synthetic work (or in a surface test), each calculation does its parallel work
+		// first, and then takes the lock (if there is one) just long
+		// enough for its critical section work and the increment.
+		for(unsigned int i = 0; i < calcTotal; i++)
+		{
+			if(traced && ((i%TRACE_CHUNK) == 0))
+			{
+				traceEvent(TRACE_CHUNK_BEGIN, TRACE_CHUNK);
+			}
+
+			doSyntheticWork(parLoops);
+
+			if(gVarUsed && threadSafe && !atomicShared)
+			{
+				if(traced)
+				{
+					traceEvent(TRACE_LOCK_BEGIN, 0);
+				}
+
+				pthread_mutex_lock(sharedMutex);
+
+				if(traced)
+				{
+					traceEvent(TRACE_LOCK_ACQUIRED, 0);
+				}
+			}
+
+			doSyntheticWork(csLoops);
+
+			if(gVarUsed && threadSafe && atomicShared)
+			{
+				__atomic_fetch_add(sharedVariable, 1, __ATOMIC_RELAXED);
+			}
+			else if(tagState)
+			{
+				taggedIncrement(tagState, tagId);
+			}
+			else if(gVarUsed)
+			{
+				(*sharedVariable)++;
+			}
+			else
+			{
+				unsharedVariable++;
+			}
+
+			if(gVarUsed && threadSafe && !atomicShared)
+			{
+				pthread_mutex_unlock(sharedMutex);
+
+				if(traced)
+				{
+					traceEvent(TRACE_LOCK_RELEASED, 0);
+				}
+			}
+
+			if(traced && ((((i + 1)%TRACE_CHUNK) == 0) || ((i + 1) == calcTotal)))
+			{
+				traceEvent(TRACE_CHUNK_END, 0);
+			}
+
+			if(progress && (((i + 1)%LIVE_CHUNK) == 0))
+			{
+				__atomic_store_n(progress, i + 1, __ATOMIC_RELAXED);
+			}
+		}
+
+		// Pass back the unshared variable if we used it.
+		if(!gVarUsed)
+		{
+			*threadResult = unsharedVariable;
+		}
+	}
+	else if(gVarUsed)
+	{
+		if(threadSafe && atomicShared)
+		{
+			// With atomics, there is no lock. Every increment is
+			// made safe on its own instead.
+			if(traced)
+			{
+				traceEvent(TRACE_CHUNK_BEGIN, calcTotal);
+			}
+
+			for(unsigned int done = 0; done < calcTotal; )
+			{
+				unsigned int chunkEnd = nextChunkEnd(done, chunkSize, calcTotal);
+
+				for(unsigned int i = done; i < chunkEnd; i++)
+				{
+					__atomic_fetch_add(sharedVariable, 1, __ATOMIC_RELAXED);
+				}
+
+				done = publishProgress(progress, chunkEnd);
+			}
+
+			if(traced)
+			{
+				traceEvent(TRACE_CHUNK_END, 0);
+			}
+		}
+		else
+		{
+			// If the user wants thread safety, lock the mutex before
+			// doing anything to the shared variable.  If another thread
+			// has control of the mutex, this thread will block and wait
+			// at this mutex call.  This is potentially dangerous, as it
+			// will cause a deadlock if the other thread never unlocks
+			// the mutex.  This makes unlocking when we're done very important.
+			if(threadSafe)
+			{
+				if(traced)
+				{
+					traceEvent(TRACE_LOCK_BEGIN, 0);
+				}
+
+				pthread_mutex_lock(sharedMutex);
+
+				if(traced)
+				{
+					traceEvent(TRACE_LOCK_ACQUIRED, 0);
+				}
+			}
+
+			// The whole share is one chunk.
+			if(traced)
+			{
+				traceEvent(TRACE_CHUNK_BEGIN, calcTotal);
+			}
+
+			// Do the calculation calcTotal times.
+			for(unsigned int done = 0; done < calcTotal; )
+			{
+				unsigned int chunkEnd = nextChunkEnd(done, chunkSize, calcTotal);
+
+				if(tagState)
+				{
+					for(unsigned int i = done; i < chunkEnd; i++)
+					{
+						taggedIncrement(tagState, tagId);
+					}
+				}
+				else
+				{
+					for(unsigned int i = done; i < chunkEnd; i++)
+					{
+						// This is where the calculation happens if a shared variable
+						// is used. We simply increment the shared variable here.
+						(*sharedVariable)++;
+					}
+				}
+
+				done = publishProgress(progress, chunkEnd);
+			}
+
+			if(traced)
+			{
+				traceEvent(TRACE_CHUNK_END, 0);
+			}
+
+			// If we locked the mutex, we need to unlock it
+			// so that other threads can use the shared variable.
+			if(threadSafe)
+			{
+				pthread_mutex_unlock(sharedMutex);
+
+				if(traced)
+				{
+					traceEvent(TRACE_LOCK_RELEASED, 0);
+				}
+			}
+		}
+	}
+	else
+	{
+		// The whole share is one chunk.
+		if(traced)
+		{
+			traceEvent(TRACE_CHUNK_BEGIN, calcTotal);
+		}
+
+		// Do the calculation calcTotal times.
+		for(unsigned int done = 0; done < calcTotal; )
+		{
+			unsigned int chunkEnd = nextChunkEnd(done, chunkSize, calcTotal);
+
+			for(unsigned int i = done; i < chunkEnd; i++)
+			{
+				// This is where each calculation is carried out if the user
+				// wants to use unshared variables.
+				unsharedVariable++;
+			}
+
+			done = publishProgress(progress, chunkEnd);
+		}
+
+		if(traced)
+		{
+			traceEvent(TRACE_CHUNK_END, 0);
+		}
+
+		// Pass back the unshared variable via the pointer we created
+		// to point in the same direction as the input parameter.
+		// This statement just says to make the unsigned int that
+		// threadResult is pointing to equal to unsharedVariable.
+		*threadResult = unsharedVariable;
+	}
+
+	if(traced)
+	{
+		traceThreadEnd();
+	}
+
+	publishProgress(progress, calcTotal);
+
+	// Leave word of where we ran, for the clock speed check.
+	__atomic_store_n(&lastWorkerCpu, sched_getcpu(), __ATOMIC_RELAXED);
 
 	// There is no variable to return.
 	return (NULL);
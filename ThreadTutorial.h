@@ -5,8 +5,9 @@
 // This file contains the function prototypes for the thread tutorial program.  The minimum and
 // maximum thread and calculation count are set in this file. MAX_CALCULATIONS cannot be set any
 // higher than 4294967295 for a 32-bit unsigned integer (which is what we are using). It is also
-// not recommended that MAX_THREADS is set any higher than the number of CPUs that you have. In
-// order for the percentage calculation to work, MAX_CALCULATIONS can be no greater than 2000000000.
+// not recommended that MAX_THREADS is set any higher than the number of CPUs that you have (the
+// -oversub mode is there to measure what happens when you do). In order for the percentage
+// calculation to work, MAX_CALCULATIONS can be no greater than 2000000000.
 
 #ifndef ThreadTutorial_h_
 #define ThreadTutorial_h_
@@ -17,6 +18,10 @@
 #include <cstdlib>
 #include "TimeStamp.h"
 #include "CatHerder.h"
+#include "SweepPlanner.h"
+#include "ResultCache.h"
+#include "ResultsFile.h"
+#include "SyntheticWork.h"
 
 #define MIN_THREADS		(1)				// Minimum amount of threads.
 #define MAX_THREADS		(16)				// Maximum amount of threads.
@@ -30,13 +35,116 @@
 #define DEFAULT_FILENAME	("ThreadTutorial")		// Default filename.
 #define SPREADSHEET_FOLDER	("spreadsheets")		// Name of the data folder.
 #define FILE_EXTENSION		(".csv")			// File extension.
+#define MAX_BUDGET		(604800)			// Adaptive budget cap (secs).
+#define MAX_REPETITIONS		(1000)				// Most repetitions per cell.
+#define LOST_EXTENSION		("_lost.csv")			// Ending of the lost update file.
+#define TAG_COUNT_BITS		(40)				// Bits of a tagged word that count.
+#define TAG_SEQUENCE_BITS	(16)				// Bits of a tag that number writes.
 
 // This is the routine used to run a single test.
 void runTest(unsigned int threadNo, unsigned int calcs, bool gVar, bool tSafe);
 
-// This function runs an automatic performance test.
+// This function runs an automatic performance test, with n going from min
+// up to max in steps of delta.
 void runAutoTest(const char* filename, bool gVar, bool tSafe,
-		 unsigned int delta, unsigned int max, unsigned int threadNo);
+		 unsigned int min, unsigned int delta, unsigned int max, unsigned int threadNo);
+
+// This function runs an adaptive automatic test within a time budget.
+void runAdaptiveTest(const char* filename, bool gVar, bool tSafe,
+		     unsigned int min, unsigned int max, unsigned int threadNo,
+		     unsigned int budgetSecs);
+
+// This function turns on the result cache for automatic tests.
+bool enableResultCache(bool reuse);
+
+// This function returns the number of cells reused from the cache.
+unsigned int cachedCellsReused(void);
+
+// This function turns on the binary results file for automatic tests.
+bool enableBinaryResults(const char* filename);
+
+// This function adds a cell to the binary results file if it is open.
+void recordBinaryCell(unsigned int calcs, unsigned int threadNo, unsigned int time, float result);
+
+// This function closes the binary results file if it is open.
+void finishBinaryResults(void);
+
+// This function opens the combined results file that every scenario of
+// the scenario mode writes its cells to.
+bool enableCombinedResults(const char* filename);
+
+// This function sets the scenario that the next cells belong to.
+void setCombinedScenario(const char* name);
+
+// This function closes the combined results file if it is open.
+void finishCombinedResults(void);
+
+// This function sets the fewest threads that the automatic tests sweep from.
+void setFirstThreads(unsigned int first);
+
+// This function builds the result cache key for a cell.
+std::string cellKey(unsigned int threadNo, unsigned int calcs);
+
+// This function runs one cell of an automatic test and returns its time.
+// Cells are taken from the result cache when it is on and has them.
+unsigned int runCell(unsigned int threadNo, unsigned int calcs, float* result);
+
+// This function sets how many times each cell of the fixed step and
+// surface tests is measured.
+void setCellRepetitions(unsigned int repetitions);
+
+// This function runs one cell as many times as it is set to be repeated,
+// records every repetition in the binary results file, and returns the
+// median time. The result is the worst of the repetitions.
+unsigned int runRepeatedCell(unsigned int threadNo, unsigned int calcs, float* result);
+
+// This function measures one cell of an automatic test and returns its time.
+unsigned int measureCell(unsigned int threadNo, unsigned int calcs, float* result);
+
+// This function turns on processes instead of threads for automatic tests.
+bool enableProcessMode(const char* filename, bool atomic);
+
+// This function turns processes back off.
+void finishProcessMode(void);
+
+// This function measures one cell with processes and returns its time.
+unsigned int measureProcessCell(unsigned int processNo, unsigned int calcs, float* result);
+
+// This function turns on the throttling check for automatic tests.
+bool enableThrottleCheck(const char* filename);
+
+// This function turns the throttling check back off.
+void finishThrottleCheck(void);
+
+// This function turns on the clock speed check for automatic tests.
+bool enableClockCheck(const char* filename);
+
+// This function turns the clock speed check back off.
+void finishClockCheck(void);
+
+// This function turns on the lost update count for automatic tests. With
+// tagged on, every unsafe increment also writes the id of its thread and a
+// sequence number next to the count, so the runs of increments that each
+// thread gets in before another one takes the cache line can be counted.
+bool enableLostCheck(const char* filename, bool tagged);
+
+// This function turns the lost update count back off.
+void finishLostCheck(void);
+
+// This function creates a spreadsheet file and writes its top line.
+void openSpreadsheet(std::ofstream& dataDump, const char* filename,
+		     const char* firstColumns, unsigned int threadNo);
+
+// This function sets the synthetic work done inside and outside of the
+// critical section for each calculation, in nanoseconds.
+void setSyntheticWork(unsigned int criticalNsecs, unsigned int parallelNsecs);
+
+// This function runs an automatic test over a surface of synthetic work.
+// Every point, even the one with no work, takes the lock for each
+// calculation, so that the points can be compared with each other.
+void runWorkSurfaceTest(const char* filename, bool gVar, bool tSafe,
+			unsigned int calcs, unsigned int threadNo,
+			unsigned int csMax, unsigned int parMax);
 
 // The function that each thread executes.
 void* calcGenerator(void* threadObject);
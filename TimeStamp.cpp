@@ -7,6 +7,7 @@
 // calculate the time difference and print them nicely.
 
 #include "TimeStamp.h"
+#include <cerrno>
 
 using namespace std;
 
@@ -162,3 +163,35 @@ unsigned int timeStamp::timeTaken(void)
 	// Return the total time in microseconds.
 	return totalTime;
 }
+
+// Returns a monotonic time stamp in nanoseconds.
+unsigned long long timeStamp::monotonicNsecs(void)
+{
+	struct timespec ts;		// Time spec structure for grabbing time.
+
+	// The monotonic clock never jumps around when the time of day changes.
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	// Return the whole thing in nanoseconds.
+	return ((unsigned long long)ts.tv_sec*1000000000ULL) + (unsigned long long)ts.tv_nsec;
+}
+
+// Sleeps until the monotonic clock reaches wakeNsecs.
+bool timeStamp::sleepUntilNsecs(unsigned long long wakeNsecs)
+{
+	struct timespec wake;		// Time spec structure for the wake time.
+	int error;			// What clock_nanosleep() returned.
+
+	wake.tv_sec = wakeNsecs/1000000000ULL;
+	wake.tv_nsec = wakeNsecs%1000000000ULL;
+
+	// clock_nanosleep() returns the error instead of setting errno. Only
+	// a signal is worth going back to sleep for, since anything else
+	// would fail the same way every time.
+	do
+	{
+		error = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, NULL);
+	} while(error == EINTR);
+
+	return (error == 0);
+}
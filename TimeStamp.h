@@ -11,6 +11,7 @@
 
 #include <iostream>
 #include <sys/time.h>
+#include <time.h>
 
 // This class contains the variables and function prototypes necessary
 // to store and evaluate start, end, and total time with the purpose of
@@ -40,6 +41,16 @@ class timeStamp
 		// and returns that time value.
 		unsigned int timeTaken(void);
 
+		// This function returns a monotonic time stamp in nanoseconds.
+		// It does not care about the time of day, so it is safe to use
+		// for measuring anything that might take more than an hour.
+		static unsigned long long monotonicNsecs(void);
+
+		// This function sleeps until the monotonic clock reaches
+		// wakeNsecs, going back to sleep if a signal wakes it early.
+		// Returns false if the sleep fails for any other reason.
+		static bool sleepUntilNsecs(unsigned long long wakeNsecs);
+
 	private:
 		// These are all the time variables that we use to measure time.
 		int startHrs, startMins, startSecs, startUsecs;
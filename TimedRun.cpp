@@ -0,0 +1,136 @@
+// Author: Jason Tennyson
+// File: TimedRun.cpp
+// Date: 10/19/26
+//
+// This file contains the implementation of timed runs. The threads wait at
+// a gate instead of a barrier, since a barrier has to be told how many
+// threads are coming before any of them are created, and there is no way
+// to let the ones waiting at it go if a pthread_create() fails after them.
+
+#include "TimedRun.h"
+#include "TimeStamp.h"
+#include "Workload.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <pthread.h>
+
+using namespace std;
+
+// This is set when the time is up.
+volatile bool timedRunStop = false;
+
+// This is the gate that the threads wait at, and how many are at it.
+static pthread_mutex_t gateMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t gateChanged = PTHREAD_COND_INITIALIZER;
+static unsigned int readyThreads = 0;
+static bool gateOpen = false;
+
+// This function allocates the slots for the threads of a test.
+void* allocateThreadSlots(unsigned int threadNo, size_t slotSize)
+{
+	void* slots;
+
+	if(posix_memalign(&slots, CACHE_LINE_SIZE, threadNo*slotSize) != 0)
+	{
+		cout << "Could not allocate the thread slots!\n";
+		return NULL;
+	}
+
+	memset(slots, 0, threadNo*slotSize);
+
+	return slots;
+}
+
+// This function gives back the slots for the threads of a test.
+void freeThreadSlots(void* slots)
+{
+	free(slots);
+}
+
+// This function waits at the gate until every thread is ready.
+void timedRunBegin(void)
+{
+	pthread_mutex_lock(&gateMutex);
+
+	// Tell the main thread that one more of us is here.
+	readyThreads++;
+	pthread_cond_broadcast(&gateChanged);
+
+	while(!gateOpen)
+	{
+		pthread_cond_wait(&gateChanged, &gateMutex);
+	}
+
+	pthread_mutex_unlock(&gateMutex);
+}
+
+// This function runs the threads of a timed run.
+bool runTimedThreads(void* (*generator)(void*), void* slots, size_t slotSize,
+		     unsigned int threadNo, unsigned int msecs, double* elapsedSecs,
+		     void (*watch)(void*), void* watchContext, unsigned int watchUsecs)
+{
+	pthread_t threads[threadNo];
+
+	readyThreads = 0;
+	gateOpen = false;
+	timedRunStop = false;
+
+	// Stop at the first thread that can't be created.
+	unsigned int created = 0;
+	while((created < threadNo) &&
+	      (pthread_create(&threads[created], NULL, generator, (char*)slots + created*slotSize) == 0))
+	{
+		created++;
+	}
+
+	// If we didn't get them all, the ones we did get stop right away.
+	if(created < threadNo)
+	{
+		__atomic_store_n(&timedRunStop, true, __ATOMIC_RELEASE);
+	}
+
+	// Wait for everyone to be ready, then let them go and start the clock.
+	pthread_mutex_lock(&gateMutex);
+	while(readyThreads < created)
+	{
+		pthread_cond_wait(&gateChanged, &gateMutex);
+	}
+	gateOpen = true;
+	pthread_cond_broadcast(&gateChanged);
+	pthread_mutex_unlock(&gateMutex);
+
+	unsigned long long startNsecs = timeStamp::monotonicNsecs();
+	unsigned long long endNsecs = startNsecs + (unsigned long long)msecs*1000000ULL;
+
+	if(created == threadNo)
+	{
+		if(watch)
+		{
+			// Wake up every watchUsecs to look in on the threads,
+			// until the time is up.
+			for(unsigned long long now = startNsecs; now < endNsecs; now = timeStamp::monotonicNsecs())
+			{
+				unsigned long long wake = now + (unsigned long long)watchUsecs*1000ULL;
+
+				timeStamp::sleepUntilNsecs((wake < endNsecs) ? wake : endNsecs);
+				watch(watchContext);
+			}
+		}
+		else
+		{
+			timeStamp::sleepUntilNsecs(endNsecs);
+		}
+
+		__atomic_store_n(&timedRunStop, true, __ATOMIC_RELEASE);
+	}
+
+	for(unsigned int i = 0; i < created; i++)
+	{
+		pthread_join(threads[i], NULL);
+	}
+
+	*elapsedSecs = (double)(timeStamp::monotonicNsecs() - startNsecs)/1000000000.0;
+
+	return (created == threadNo);
+}
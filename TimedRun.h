@@ -0,0 +1,68 @@
+// Author: Jason Tennyson
+// File: TimedRun.h
+// Date: 10/19/26
+//
+// This file contains the function prototypes for timed runs. Most of the
+// tests that count operations run the same way: give every thread a slot
+// to count in, start every thread, let them all go at once, start the
+// clock, wait out the time, tell them to stop, and join them. This is that,
+// so that each test only has to say what its threads do. A test's threads
+// look like this:
+//
+//	timedRunBegin();
+//
+//	while(!timedRunOver())
+//	{
+//		...do a chunk of operations and count them...
+//	}
+//
+// Only one timed run goes at a time.
+
+#ifndef TimedRun_h_
+#define TimedRun_h_
+
+#include <cstddef>
+
+// This function allocates threadNo slots of slotSize bytes, cleared to
+// zero, for the threads of a test to be handed one each. Every thread
+// writes to its own slot the whole time it runs, so if two slots shared a
+// cache line, the line would bounce between their cores and slow both of
+// them down. The slots start on a cache line, and every slot type is
+// padded out to at least a cache line, so no two threads ever share one.
+// Returns NULL (and says so) if they can't be allocated. They are given
+// back with freeThreadSlots.
+void* allocateThreadSlots(unsigned int threadNo, size_t slotSize);
+
+// This function is allocateThreadSlots for threadNo slots of type T.
+template <typename T> T* allocateThreadSlots(unsigned int threadNo)
+{
+	return (T*)allocateThreadSlots(threadNo, sizeof(T));
+}
+
+// This function gives back slots from allocateThreadSlots.
+void freeThreadSlots(void* slots);
+
+// This is set when the time is up. It is only read through timedRunOver.
+extern volatile bool timedRunStop;
+
+// This function is called by each thread of a timed run once it is ready
+// to go, and waits there until every thread is ready.
+void timedRunBegin(void);
+
+// This function returns true once the threads of a timed run should stop.
+static inline bool timedRunOver(void)
+{
+	return __atomic_load_n(&timedRunStop, __ATOMIC_ACQUIRE);
+}
+
+// This function runs threadNo threads of generator for msecs milliseconds,
+// handing thread i the slot at slots + i*slotSize, and stores how long they
+// ran for in elapsedSecs. If watch isn't NULL, it is called with
+// watchContext every watchUsecs while the threads run. Returns false if
+// the threads couldn't all be created, in which case the ones that were are
+// told to stop before they start, and are joined.
+bool runTimedThreads(void* (*generator)(void*), void* slots, size_t slotSize,
+		     unsigned int threadNo, unsigned int msecs, double* elapsedSecs,
+		     void (*watch)(void*), void* watchContext, unsigned int watchUsecs);
+
+#endif
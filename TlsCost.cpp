@@ -0,0 +1,290 @@
+// Author: Jason Tennyson
+// File: TlsCost.cpp
+// Date: 10/19/26
+//
+// This file contains the implementation of the thread local storage test.
+// Each thread adds 0 up to TLS_CHUNK - 1 to its total over and over, so when
+// it is done, its total has to be what its adds come to. If it isn't, the
+// way that was being tested wasn't really per thread.
+
+#include "TlsCost.h"
+#include "NameList.h"
+#include "ThreadTutorial.h"
+#include "TimedRun.h"
+#include "Workload.h"
+#include <dlfcn.h>
+#include <time.h>
+
+using namespace std;
+
+// These are the names of the ways, in the order of tlsType.
+static const char* tlsNames[TLS_TYPES] = { "context", "thread_local", "getspecific", "dynamic" };
+
+// This is how each way finds the total, for the spreadsheet.
+static const char* tlsModels[TLS_TYPES] = { "argument", "static", "pthread key", "dlopen" };
+
+// This is what every add looks like, whichever way it finds the total.
+typedef void (*tlsAdd)(unsigned long long* context, unsigned long long value);
+
+// This structure is one thread's way of adding, its totals in every place
+// they can be kept, and what its adds cost.
+struct tlsSlot
+{
+	tlsAdd add;				// How this thread adds.
+	unsigned long long ops;			// Adds done.
+	unsigned long long total;		// The context total.
+	unsigned long long keyed;		// What the pthread key points to.
+	unsigned long long found;		// The total the thread found.
+	unsigned long long cpuNsecs;		// CPU time the thread used.
+	char pad[CACHE_LINE_SIZE];
+};
+
+// These are the way being tested and what the threads need to find their
+// totals with it.
+static tlsType tlsKind;
+static pthread_key_t totalKey;
+static unsigned long long (*moduleTotal)(void);
+
+// This is the thread_local total.
+static __thread unsigned long long localTotal;
+
+// This function returns the name of a way.
+const char* tlsName(tlsType type)
+{
+	return ((type < TLS_TYPES) ? tlsNames[type] : "unknown");
+}
+
+// This function reads a comma separated list of way names. Names we don't
+// know and repeats are skipped.
+unsigned int tlsListFromNames(const char* names, tlsType* types)
+{
+	return readNameList(names, tlsNames, TLS_TYPES, types);
+}
+
+// This function adds to the total that it was handed.
+static void __attribute__((noinline)) addContext(unsigned long long* context, unsigned long long value)
+{
+	*context += value;
+}
+
+// This function adds to the thread_local total. It has no use for the
+// context, but takes it so that every add looks the same.
+static void __attribute__((noinline)) addThreadLocal(unsigned long long*, unsigned long long value)
+{
+	localTotal += value;
+}
+
+// This function looks up the total with the pthread key and adds to it,
+// leaving the context alone like addThreadLocal.
+static void __attribute__((noinline)) addSpecific(unsigned long long*, unsigned long long value)
+{
+	*(unsigned long long*)pthread_getspecific(totalKey) += value;
+}
+
+// This function returns how much CPU time the calling thread has used, in
+// nanoseconds. With more threads than CPUs, the threads take turns, so the
+// time on the wall says nothing about what an add costs.
+static unsigned long long threadCpuNsecs(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+
+	return ((unsigned long long)ts.tv_sec*1000000000ULL) + (unsigned long long)ts.tv_nsec;
+}
+
+// This is the function that each thread runs during the test.
+static void* tlsGenerator(void* slotObject)
+{
+	tlsSlot* slot = (tlsSlot*)slotObject;
+	unsigned long long* context = &slot->total;
+	tlsAdd add = slot->add;
+
+	if(tlsKind == TLS_GETSPECIFIC)
+	{
+		pthread_setspecific(totalKey, &slot->keyed);
+	}
+
+	// Only the adds are timed, not the setup above.
+	timedRunBegin();
+	unsigned long long startNsecs = threadCpuNsecs();
+
+	while(!timedRunOver())
+	{
+		for(unsigned int i = 0; i < TLS_CHUNK; i++)
+		{
+			add(context, i);
+		}
+
+		slot->ops += TLS_CHUNK;
+	}
+
+	slot->cpuNsecs = threadCpuNsecs() - startNsecs;
+
+	// Hand back the total from wherever it was kept.
+	switch(tlsKind)
+	{
+		case TLS_THREAD_LOCAL:
+			slot->found = localTotal;
+			break;
+		case TLS_GETSPECIFIC:
+			slot->found = *(unsigned long long*)pthread_getspecific(totalKey);
+			break;
+		case TLS_DYNAMIC:
+			slot->found = moduleTotal();
+			break;
+		default:
+			slot->found = slot->total;
+			break;
+	}
+
+	return (NULL);
+}
+
+// This function runs the thread local storage test.
+void runTlsTest(const char* filename, const tlsType* mechanisms, unsigned int mechanismCount,
+		unsigned int maxThreads, unsigned int cellMsecs, const char* modulePath)
+{
+	// Load the shared object for the dynamic way, if it is being tested.
+	tlsAdd moduleAdd = NULL;
+	void* module = NULL;
+
+	for(unsigned int m = 0; m < mechanismCount; m++)
+	{
+		if(mechanisms[m] == TLS_DYNAMIC)
+		{
+			module = dlopen(modulePath, RTLD_NOW | RTLD_LOCAL);
+
+			if(module)
+			{
+				moduleAdd = (tlsAdd)dlsym(module, TLS_MODULE_ADD);
+				moduleTotal = (unsigned long long (*)(void))dlsym(module, TLS_MODULE_TOTAL);
+			}
+
+			if(!moduleAdd || !moduleTotal)
+			{
+				const char* error = dlerror();
+
+				cout << "NOTE: " << modulePath << " could not be loaded ("
+				     << (error ? error : "missing functions")
+				     << "), so the dynamic way is skipped. See TlsCost.h to build it.\n";
+				moduleAdd = NULL;
+				moduleTotal = NULL;
+			}
+		}
+	}
+
+	// Create a temp filename to append the spreadsheet folder location
+	// in front of the desired filename.
+	string tempFilename = SPREADSHEET_FOLDER;
+	tempFilename += "/";
+	tempFilename += filename;
+
+	ofstream dataDump(tempFilename.c_str());
+
+	// Write the top line of the data file.
+	dataDump << "Mechanism,Model";
+	for(unsigned int t = MIN_THREADS; t <= maxThreads; t++)
+	{
+		dataDump << ",Ns/Op " << t;
+	}
+	dataDump << ",Result\n";
+
+	pthread_key_create(&totalKey, NULL);
+
+	for(unsigned int m = 0; m < mechanismCount; m++)
+	{
+		tlsAdd add;
+		bool correct = true;
+
+		tlsKind = mechanisms[m];
+
+		switch(tlsKind)
+		{
+			case TLS_THREAD_LOCAL:
+				add = addThreadLocal;
+				break;
+			case TLS_GETSPECIFIC:
+				add = addSpecific;
+				break;
+			case TLS_DYNAMIC:
+				add = moduleAdd;
+				break;
+			default:
+				add = addContext;
+				break;
+		}
+
+		if(!add || ((tlsKind == TLS_DYNAMIC) && !moduleTotal))
+		{
+			continue;
+		}
+
+		dataDump << tlsName(tlsKind) << "," << tlsModels[tlsKind];
+
+		for(unsigned int threadNo = MIN_THREADS; threadNo <= maxThreads; threadNo++)
+		{
+			tlsSlot* slots = allocateThreadSlots<tlsSlot>(threadNo);
+			if(!slots)
+			{
+				break;
+			}
+
+			for(unsigned int i = 0; i < threadNo; i++)
+			{
+				slots[i].add = add;
+			}
+
+			// The time on the wall isn't used, since every thread
+			// measures its own CPU time.
+			double elapsedSecs;
+			if(!runTimedThreads(tlsGenerator, slots, sizeof(tlsSlot), threadNo, cellMsecs,
+					    &elapsedSecs, NULL, NULL, 0))
+			{
+				cout << "Could not create the threads!\n";
+				freeThreadSlots(slots);
+				break;
+			}
+
+			// Every chunk adds up to the same thing, so each thread's
+			// total has to be that many times its chunks.
+			unsigned long long totalOps = 0, cpuNsecs = 0;
+			for(unsigned int i = 0; i < threadNo; i++)
+			{
+				totalOps += slots[i].ops;
+				cpuNsecs += slots[i].cpuNsecs;
+				correct = correct &&
+					  (slots[i].found == (slots[i].ops/TLS_CHUNK)*((TLS_CHUNK*(TLS_CHUNK - 1ULL))/2));
+			}
+
+			// This is what one add cost the thread that did it.
+			double nsPerOp = totalOps ? (double)cpuNsecs/totalOps : 0;
+
+			dataDump << "," << nsPerOp;
+
+			cout << tlsName(tlsKind) << ": " << threadNo << " threads, "
+			     << nsPerOp << " ns/op\n";
+
+			freeThreadSlots(slots);
+		}
+
+		if(!correct)
+		{
+			cout << "WARNING: The " << tlsName(tlsKind) << " totals were not per thread!\n";
+		}
+
+		dataDump << "," << (correct ? 1 : 0) << "\n";
+		dataDump.flush();
+	}
+
+	pthread_key_delete(totalKey);
+
+	if(module)
+	{
+		dlclose(module);
+	}
+
+	// Append an extra new line character to the end of the file.
+	dataDump << "\n";
+	dataDump.close();
+}
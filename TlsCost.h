@@ -0,0 +1,72 @@
+// Author: Jason Tennyson
+// File: TlsCost.h
+// Date: 10/19/26
+//
+// This file contains the definitions for the thread local storage test.
+// calcGenerator is handed its slot through its void* argument, but there
+// are other ways for a thread to find its own data, and they don't cost the
+// same. This test has every thread add to its own total as fast as it can,
+// finding the total each of four ways:
+//
+//	context		The total is in the slot that the thread was handed,
+//			and its address is passed in with every add.
+//	thread_local	The total is a __thread variable in this program, which
+//			is what thread_local is for plain types. The compiler
+//			finds it at a fixed offset from the thread pointer.
+//	getspecific	The total is found with pthread_getspecific() on every
+//			add, which is what code without compiler support does.
+//	dynamic		The total is a __thread variable in a shared object that
+//			is loaded with dlopen(). Its offset isn't known until
+//			the object is loaded, so every add goes through
+//			__tls_get_addr().
+//
+// Every add is a call through a function pointer, whichever way the total
+// is found, so that the compiler can't keep the total in a register and the
+// only difference between the ways is the lookup. The context way is the
+// baseline, and the others cost whatever they take on top of it.
+//
+// The shared object is built from TlsModule.cpp on its own:
+//
+//	g++ -O2 -shared -fPIC -DTLS_MODULE -o libtlsmodule.so TlsModule.cpp
+//
+// Without TLS_MODULE, TlsModule.cpp is empty, so it does no harm when it is
+// built into the program with everything else. The program needs -ldl with
+// a C library older than glibc 2.34. If the object can't be loaded, the
+// dynamic way is skipped.
+
+#ifndef TlsCost_h_
+#define TlsCost_h_
+
+#define DEFAULT_TLS_MSECS	(200)				// Default time per cell (ms).
+#define MAX_TLS_MSECS		(60000)				// Maximum time per cell (ms).
+#define TLS_CHUNK		(1024)				// Adds between flag checks.
+#define TLS_MODULE_PATH		("./libtlsmodule.so")		// Default shared object.
+#define TLS_MODULE_ADD		("tlsModuleAdd")		// Its add function.
+#define TLS_MODULE_TOTAL	("tlsModuleTotal")		// Its total function.
+
+// These are the ways that a thread can find its total.
+enum tlsType
+{
+	TLS_CONTEXT = 0,	// Passed in as an argument.
+	TLS_THREAD_LOCAL,	// A __thread variable in this program.
+	TLS_GETSPECIFIC,	// A pthread key.
+	TLS_DYNAMIC,		// A __thread variable in a dlopen'd object.
+	TLS_TYPES		// The number of ways.
+};
+
+// This function returns the name of a way.
+const char* tlsName(tlsType type);
+
+// This function reads a comma separated list of names into types, which
+// must have room for TLS_TYPES entries. Returns the count.
+unsigned int tlsListFromNames(const char* names, tlsType* types);
+
+// This function runs every way with 1 up to maxThreads threads for
+// cellMsecs each, and saves the nanoseconds per add of each thread to
+// filename in the spreadsheet folder. The time is each thread's CPU time, so
+// it still means something with more threads than CPUs. The dynamic way
+// loads modulePath.
+void runTlsTest(const char* filename, const tlsType* mechanisms, unsigned int mechanismCount,
+		unsigned int maxThreads, unsigned int cellMsecs, const char* modulePath);
+
+#endif
@@ -0,0 +1,29 @@
+// Author: Jason Tennyson
+// File: TlsModule.cpp
+// Date: 10/19/26
+//
+// This file is the shared object for the dynamic way of the thread local
+// storage test. It is only compiled with TLS_MODULE defined, as a shared
+// object of its own (see TlsCost.h), so that its __thread variable uses the
+// dynamic model and lives in the block that is set up for every thread when
+// the object is loaded.
+
+#ifdef TLS_MODULE
+
+// This is the calling thread's total.
+static __thread unsigned long long moduleTotal;
+
+// This function adds value to the calling thread's total. The context is
+// ignored, it is only there so that every way is called the same way.
+extern "C" void tlsModuleAdd(unsigned long long*, unsigned long long value)
+{
+	moduleTotal += value;
+}
+
+// This function returns the calling thread's total.
+extern "C" unsigned long long tlsModuleTotal(void)
+{
+	return moduleTotal;
+}
+
+#endif
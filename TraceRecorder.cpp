@@ -0,0 +1,319 @@
+// Author: Jason Tennyson
+// File: TraceRecorder.cpp
+// Date: 10/19/26
+//
+// This file contains the implementation of the trace recorder. Ring 0
+// belongs to the main thread, and the rest are handed out to the worker
+// threads in the order that they start. Every ring only ever has one thread
+// writing to it at a time, and it is only read after that thread has been
+// joined, so the rings need no locks and no atomics. The only thing the
+// threads share is the counter that hands out the rings. A ring is only
+// allocated by the first thread that is handed it, so a run with a few
+// threads doesn't pay for all TRACE_SLOTS of them.
+//
+// In the JSON, every lock request shows up as a "lock wait" slice that ends
+// when the lock is acquired, followed by a "lock held" slice that ends when
+// it is released. A convoy looks like a staircase of lock waits, and a
+// preempted lock holder looks like a long lock held slice with everyone
+// else stuck in lock wait under it.
+
+#include "TraceRecorder.h"
+#include "ThreadTutorial.h"
+#include <iomanip>
+#include <vector>
+
+using namespace std;
+
+// This is one recorded event.
+struct traceRecord
+{
+	unsigned long long time;	// Monotonic time stamp (ns).
+	unsigned long long argument;	// Whatever goes with the event.
+	unsigned int type;		// What happened.
+};
+
+// This is one thread's ring. It is padded so that the rings' counters
+// don't share cache lines.
+struct traceRing
+{
+	traceRecord* records;		// The ring itself.
+	unsigned long long written;	// Events written, ever.
+	char pad[64 - sizeof(traceRecord*) - sizeof(unsigned long long)];
+};
+
+// These values have to be stored globally to be accessed by the threads.
+static traceRing rings[TRACE_SLOTS];
+static unsigned long long ringCapacity = 0;
+static unsigned long long ringMask = 0;
+static bool tracing = false;
+static unsigned int nextSlot = 0;
+
+// This is the ring of the calling thread, or null if it doesn't have one.
+static __thread traceRing* threadRing = NULL;
+
+// This function turns the recorder on.
+bool traceEnable(unsigned int eventsPerThread)
+{
+	// The ring size has to be a power of two for the mask to work.
+	unsigned long long capacity = 1;
+	while(capacity < eventsPerThread)
+	{
+		capacity *= 2;
+	}
+
+	// The main thread's ring is allocated now, so that a size that can't
+	// be allocated at all is caught before anything runs.
+	rings[0].records = new (nothrow) traceRecord[capacity];
+	rings[0].written = 0;
+
+	if(rings[0].records == NULL)
+	{
+		return false;
+	}
+
+	ringCapacity = capacity;
+	ringMask = capacity - 1;
+	nextSlot = 0;
+	tracing = true;
+
+	return true;
+}
+
+// This function returns true if the recorder is on.
+bool traceEnabled(void)
+{
+	return tracing;
+}
+
+// This function records an event for the calling thread.
+void traceEvent(traceType type, unsigned long long argument)
+{
+	if(threadRing == NULL)
+	{
+		return;
+	}
+
+	traceRecord* record = &threadRing->records[threadRing->written & ringMask];
+
+	record->time = timeStamp::monotonicNsecs();
+	record->argument = argument;
+	record->type = type;
+	threadRing->written++;
+}
+
+// This function gives the calling thread a ring and records its start. If
+// every ring is taken, or the ring can't be allocated, the thread just isn't
+// traced.
+void traceThreadBegin(void)
+{
+	if(!tracing)
+	{
+		return;
+	}
+
+	unsigned int slot = __atomic_fetch_add(&nextSlot, 1, __ATOMIC_RELAXED) + 1;
+
+	threadRing = (slot < TRACE_SLOTS) ? &rings[slot] : NULL;
+
+	// Only this thread has the ring, so it can allocate it without a lock.
+	if(threadRing && (threadRing->records == NULL))
+	{
+		threadRing->records = new (nothrow) traceRecord[ringCapacity];
+		threadRing->written = 0;
+
+		if(threadRing->records == NULL)
+		{
+			threadRing = NULL;
+		}
+	}
+
+	traceEvent(TRACE_THREAD_BEGIN, 0);
+}
+
+// This function records that the calling thread is about to exit.
+void traceThreadEnd(void)
+{
+	traceEvent(TRACE_THREAD_END, 0);
+	threadRing = NULL;
+}
+
+// This function marks the start of a cell on the main thread's timeline.
+void traceCellBegin(unsigned int calcs, unsigned int threadNo)
+{
+	if(!tracing)
+	{
+		return;
+	}
+
+	threadRing = &rings[0];
+	nextSlot = 0;
+
+	// Both numbers fit in 32 bits, so they share the argument.
+	traceEvent(TRACE_CELL_BEGIN, ((unsigned long long)calcs << 32) | threadNo);
+}
+
+// This function marks the end of a cell on the main thread's timeline.
+void traceCellEnd(void)
+{
+	if(tracing)
+	{
+		traceEvent(TRACE_CELL_END, 0);
+	}
+}
+
+// This function frees the rings.
+static void freeRings(void)
+{
+	for(unsigned int i = 0; i < TRACE_SLOTS; i++)
+	{
+		delete [] rings[i].records;
+		rings[i].records = NULL;
+		rings[i].written = 0;
+	}
+}
+
+// This function writes one Chrome trace event.
+static void writeEvent(ofstream& json, bool& first, const char* name, char phase,
+		       double usecs, unsigned int tid, const string& args)
+{
+	json << (first ? "\n" : ",\n")
+	     << "{\"name\":\"" << name << "\",\"ph\":\"" << phase << "\",\"ts\":"
+	     << fixed << setprecision(3) << usecs << ",\"pid\":1,\"tid\":" << tid;
+
+	if(!args.empty())
+	{
+		json << ",\"args\":{" << args << "}";
+	}
+
+	json << "}";
+	first = false;
+}
+
+// This function writes the rings out as Chrome Trace Event JSON.
+bool traceExport(const char* filename)
+{
+	if(!tracing)
+	{
+		return false;
+	}
+
+	tracing = false;
+
+	// Create a temp filename to append the spreadsheet folder location
+	// in front of the desired filename.
+	string tempFilename = SPREADSHEET_FOLDER;
+	tempFilename += "/";
+	tempFilename += filename;
+
+	ofstream json(tempFilename.c_str());
+
+	if(!json)
+	{
+		freeRings();
+		return false;
+	}
+
+	// The time stamps start at the first event that is still in a ring.
+	unsigned long long capacity = ringCapacity;
+	unsigned long long origin = ~0ULL;
+
+	for(unsigned int slot = 0; slot < TRACE_SLOTS; slot++)
+	{
+		if(rings[slot].written > 0)
+		{
+			unsigned long long oldest = (rings[slot].written > capacity) ? (rings[slot].written - capacity) : 0;
+
+			if(rings[slot].records[oldest & ringMask].time < origin)
+			{
+				origin = rings[slot].records[oldest & ringMask].time;
+			}
+		}
+	}
+
+	json << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+	bool first = true;
+
+	writeEvent(json, first, "process_name", 'M', 0, 0, "\"name\":\"ThreadTutorial\"");
+
+	for(unsigned int slot = 0; slot < TRACE_SLOTS; slot++)
+	{
+		traceRing* ring = &rings[slot];
+
+		if(ring->written == 0)
+		{
+			continue;
+		}
+
+		ostringstream threadName;
+		if(slot == 0)
+		{
+			threadName << "\"name\":\"main\"";
+		}
+		else
+		{
+			threadName << "\"name\":\"worker " << slot << "\"";
+		}
+		writeEvent(json, first, "thread_name", 'M', 0, slot, threadName.str());
+
+		// If the ring wrapped, the oldest events are gone, and some
+		// of the slices we have the ends of were started before them.
+		// The open slices are counted so those ends can be dropped.
+		unsigned long long oldest = (ring->written > capacity) ? (ring->written - capacity) : 0;
+		unsigned int open = 0;
+
+		for(unsigned long long i = oldest; i < ring->written; i++)
+		{
+			traceRecord* record = &ring->records[i & ringMask];
+			double usecs = (double)(record->time - origin)/1000.0;
+			ostringstream args;
+
+			switch(record->type)
+			{
+				case TRACE_THREAD_BEGIN:
+					writeEvent(json, first, "thread", 'B', usecs, slot, "");
+					open++;
+					break;
+				case TRACE_LOCK_BEGIN:
+					writeEvent(json, first, "lock wait", 'B', usecs, slot, "");
+					open++;
+					break;
+				case TRACE_LOCK_ACQUIRED:
+					// The wait ends and the hold starts.
+					if(open > 0)
+					{
+						writeEvent(json, first, "lock wait", 'E', usecs, slot, "");
+						open--;
+					}
+					writeEvent(json, first, "lock held", 'B', usecs, slot, "");
+					open++;
+					break;
+				case TRACE_CHUNK_BEGIN:
+					args << "\"ops\":" << record->argument;
+					writeEvent(json, first, "chunk", 'B', usecs, slot, args.str());
+					open++;
+					break;
+				case TRACE_CELL_BEGIN:
+					args << "\"n\":" << (record->argument >> 32)
+					     << ",\"threads\":" << (record->argument & 0xFFFFFFFFULL);
+					writeEvent(json, first, "cell", 'B', usecs, slot, args.str());
+					open++;
+					break;
+				default:
+					// Everything else closes the slice it is in.
+					if(open > 0)
+					{
+						writeEvent(json, first, "", 'E', usecs, slot, "");
+						open--;
+					}
+					break;
+			}
+		}
+	}
+
+	json << "\n]}\n";
+	json.close();
+
+	freeRings();
+
+	return true;
+}
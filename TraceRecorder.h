@@ -0,0 +1,74 @@
+// Author: Jason Tennyson
+// File: TraceRecorder.h
+// Date: 10/19/26
+//
+// This file contains the function prototypes for the trace recorder. The
+// spreadsheets say how long a run took, but not why. When the recorder is
+// on, every thread writes what it is doing (starting, waiting for the lock,
+// holding it, finishing a chunk of work, exiting) into a ring buffer of its
+// own, with a time stamp. Nothing is shared between the threads while they
+// record, so there is no lock to slow them down and no lock to change what
+// is being measured. At the end, the rings are written out as Chrome Trace
+// Event JSON, which opens in Perfetto (ui.perfetto.dev) or chrome://tracing
+// and shows every thread on its own timeline.
+//
+// When a ring fills up, the newest events write over the oldest ones, so a
+// long run keeps its last events.
+
+#ifndef TraceRecorder_h_
+#define TraceRecorder_h_
+
+#define TRACE_SLOTS		(64)				// Most threads traced at once.
+#define DEFAULT_TRACE_EVENTS	(65536)				// Default events kept per thread.
+#define TRACE_CHUNK		(1024)				// Operations between chunk marks.
+#define TRACE_EXTENSION		("_trace.json")			// Ending of the trace file.
+
+// These are the kinds of events that are recorded.
+enum traceType
+{
+	TRACE_THREAD_BEGIN = 0,	// A thread started.
+	TRACE_THREAD_END,	// A thread is about to exit.
+	TRACE_LOCK_BEGIN,	// A thread asked for the lock.
+	TRACE_LOCK_ACQUIRED,	// A thread got the lock.
+	TRACE_LOCK_RELEASED,	// A thread let go of the lock.
+	TRACE_CHUNK_BEGIN,	// A thread started a chunk of work.
+	TRACE_CHUNK_END,	// A thread finished a chunk of work.
+	TRACE_CELL_BEGIN,	// The main thread started a cell.
+	TRACE_CELL_END,		// The main thread finished a cell.
+	TRACE_TYPES		// The number of event types.
+};
+
+// This function turns the recorder on, with room for eventsPerThread
+// events (rounded up to a power of two) in every thread's ring. The main
+// thread's ring is allocated now and the others when a thread first gets
+// them. Returns false if the main thread's ring can't be allocated.
+bool traceEnable(unsigned int eventsPerThread);
+
+// This function returns true if the recorder is on.
+bool traceEnabled(void);
+
+// This function gives the calling thread a ring and records that it
+// started. It does nothing if the recorder is off, and the thread isn't
+// traced if its ring can't be allocated.
+void traceThreadBegin(void);
+
+// This function records that the calling thread is about to exit.
+void traceThreadEnd(void);
+
+// This function records an event for the calling thread. The argument is
+// shown with the event, like the number of operations in a chunk. It does
+// nothing if the calling thread has no ring.
+void traceEvent(traceType type, unsigned long long argument);
+
+// This function marks the start of a cell on the main thread's timeline.
+// The worker rings are handed out again from the start for every cell.
+void traceCellBegin(unsigned int calcs, unsigned int threadNo);
+
+// This function marks the end of a cell on the main thread's timeline.
+void traceCellEnd(void);
+
+// This function writes every ring to filename in the spreadsheet folder as
+// Chrome Trace Event JSON, turns the recorder off and frees the rings.
+bool traceExport(const char* filename);
+
+#endif
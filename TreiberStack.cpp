@@ -0,0 +1,604 @@
+// Author: Jason Tennyson
+// File: TreiberStack.cpp
+// Date: 10/19/26
+//
+// This file contains the implementation of the stack test. Every thread
+// frees only the nodes that it popped itself, so the lists of nodes waiting
+// to be freed belong to one thread each and need no locks.
+//
+// A retired node is tagged with the global epoch read after it was taken
+// off the stack. A thread that could still be looking at it had to have
+// come in before that, in that epoch or an earlier one, and the epoch can't
+// get two past a thread that is still in, so once the global epoch is two
+// past the tag, nobody can be looking at it.
+//
+// Only one retired node in RECLAIM_SAMPLE is time stamped, so that reading
+// the clock doesn't slow down every pop. The memory waiting to be freed is
+// sampled by the main thread while the run goes on, and the peak is kept.
+
+#include "TreiberStack.h"
+#include "NameList.h"
+#include "ThreadTutorial.h"
+#include "TimedRun.h"
+#include "Workload.h"
+
+using namespace std;
+
+// These are the names of the stacks, in the order of stackType.
+static const char* stackNames[STACK_TYPES] = { "mutex", "leak", "hazard", "epoch" };
+
+// This structure is one node of a stack. The retired list has its own link,
+// so that a thread that is still looking at a popped node never sees its
+// next pointer change.
+struct stackNode
+{
+	unsigned long long value;		// What was pushed.
+	stackNode* next;			// The node under this one.
+	stackNode* retiredNext;			// The next node waiting to be freed.
+	unsigned long long retiredNsecs;	// When it was popped, if timed.
+};
+
+// This structure is one thread's counts and the nodes it has retired but
+// not freed yet.
+struct stackSlot
+{
+	unsigned int index;			// Index of the thread.
+	unsigned long long ops;			// Operations done.
+	unsigned long long pushes;		// Nodes pushed.
+	unsigned long long pops;		// Nodes popped.
+	volatile unsigned long long pending;	// Nodes popped but not freed.
+	unsigned long long retiredCount;	// Nodes retired, ever.
+	unsigned long long latencyNsecs;	// Total wait of the timed nodes.
+	unsigned long long latencyCount;	// Timed nodes freed.
+	unsigned long long latencyMax;		// Longest wait of a timed node.
+	stackNode* retired;			// Waiting for the hazards to clear.
+	unsigned long long retiredLength;	// Nodes in that list.
+	stackNode* limbo[3];			// Waiting for the epoch, by epoch.
+	unsigned long long limboEpoch[3];	// The epoch of each limbo list.
+	char pad[CACHE_LINE_SIZE];
+};
+
+// This structure is one thread's published pointer or epoch, on a cache
+// line of its own since every other thread reads it.
+struct announceSlot
+{
+	stackNode* volatile hazard;		// The node being looked at.
+	volatile unsigned long long epoch;	// (epoch << 1) | 1 while in.
+	char pad[CACHE_LINE_SIZE - sizeof(stackNode*) - sizeof(unsigned long long)];
+};
+
+// This structure is what the main thread keeps while it watches the memory
+// waiting to be freed.
+struct stackWatch
+{
+	stackSlot* slots;			// The threads' slots.
+	unsigned int threadNo;			// How many there are.
+	unsigned long long peakPending;		// The most nodes ever waiting.
+};
+
+// These are the stack every thread pushes and pops, and what the ways of
+// freeing its nodes share.
+static stackType stackKind;
+static stackNode* volatile stackTop;
+static pthread_mutex_t stackMutex;
+static announceSlot* announcements;
+static unsigned int announceCount;
+static volatile unsigned long long globalEpoch;
+
+// This function returns the name of a stack.
+const char* stackName(stackType type)
+{
+	return ((type < STACK_TYPES) ? stackNames[type] : "unknown");
+}
+
+// This function reads a comma separated list of stack names. Names we
+// don't know and repeats are skipped.
+unsigned int stackListFromNames(const char* names, stackType* types)
+{
+	return readNameList(names, stackNames, STACK_TYPES, types);
+}
+
+// This function frees a node that was waiting, and times how long it
+// waited if it was one of the timed ones.
+static void freeNode(stackSlot* slot, stackNode* node)
+{
+	if(node->retiredNsecs)
+	{
+		unsigned long long waited = timeStamp::monotonicNsecs() - node->retiredNsecs;
+
+		slot->latencyNsecs += waited;
+		slot->latencyCount++;
+		if(waited > slot->latencyMax)
+		{
+			slot->latencyMax = waited;
+		}
+	}
+
+	delete node;
+	__atomic_store_n(&slot->pending, slot->pending - 1, __ATOMIC_RELAXED);
+}
+
+// This function frees a whole list of nodes that were waiting.
+static void freeList(stackSlot* slot, stackNode* node)
+{
+	while(node)
+	{
+		stackNode* next = node->retiredNext;
+		freeNode(slot, node);
+		node = next;
+	}
+}
+
+// This function frees every retired node that no thread has a hazard
+// pointer to.
+static void scanHazards(stackSlot* slot)
+{
+	stackNode* hazards[announceCount];
+
+	for(unsigned int i = 0; i < announceCount; i++)
+	{
+		hazards[i] = __atomic_load_n(&announcements[i].hazard, __ATOMIC_SEQ_CST);
+	}
+
+	stackNode* keep = NULL;
+	unsigned long long kept = 0;
+	stackNode* node = slot->retired;
+
+	while(node)
+	{
+		stackNode* next = node->retiredNext;
+		bool hazardous = false;
+
+		for(unsigned int i = 0; (i < announceCount) && !hazardous; i++)
+		{
+			hazardous = (hazards[i] == node);
+		}
+
+		if(hazardous)
+		{
+			node->retiredNext = keep;
+			keep = node;
+			kept++;
+		}
+		else
+		{
+			freeNode(slot, node);
+		}
+
+		node = next;
+	}
+
+	slot->retired = keep;
+	slot->retiredLength = kept;
+}
+
+// This function frees every limbo list that the global epoch is at least
+// two past.
+static void freeLimbo(stackSlot* slot, unsigned long long epoch)
+{
+	for(unsigned int i = 0; i < 3; i++)
+	{
+		if(slot->limbo[i] && ((slot->limboEpoch[i] + 2) <= epoch))
+		{
+			freeList(slot, slot->limbo[i]);
+			slot->limbo[i] = NULL;
+		}
+	}
+}
+
+// This function says that the calling thread is using the stack, in the
+// current epoch. Its old limbo lists are freed while it is at it.
+static void enterEpoch(stackSlot* slot)
+{
+	unsigned long long epoch = __atomic_load_n(&globalEpoch, __ATOMIC_SEQ_CST);
+
+	__atomic_store_n(&announcements[slot->index].epoch, (epoch << 1) | 1, __ATOMIC_SEQ_CST);
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+	freeLimbo(slot, epoch);
+}
+
+// This function says that the calling thread is done with the stack.
+static void leaveEpoch(stackSlot* slot)
+{
+	__atomic_store_n(&announcements[slot->index].epoch, 0, __ATOMIC_RELEASE);
+}
+
+// This function moves the global epoch on, if every thread that is using
+// the stack is in the current one.
+static void advanceEpoch(void)
+{
+	unsigned long long epoch = __atomic_load_n(&globalEpoch, __ATOMIC_SEQ_CST);
+
+	for(unsigned int i = 0; i < announceCount; i++)
+	{
+		unsigned long long announced = __atomic_load_n(&announcements[i].epoch, __ATOMIC_SEQ_CST);
+
+		if((announced & 1) && ((announced >> 1) != epoch))
+		{
+			return;
+		}
+	}
+
+	__atomic_compare_exchange_n(&globalEpoch, &epoch, epoch + 1, false,
+				    __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+}
+
+// This function hands a popped node over to be freed when it is safe.
+static void retireNode(stackSlot* slot, stackNode* node)
+{
+	slot->retiredCount++;
+	node->retiredNsecs = ((slot->retiredCount % RECLAIM_SAMPLE) == 0) ? timeStamp::monotonicNsecs() : 0;
+	__atomic_store_n(&slot->pending, slot->pending + 1, __ATOMIC_RELAXED);
+
+	if(stackKind == STACK_HAZARD)
+	{
+		node->retiredNext = slot->retired;
+		slot->retired = node;
+
+		if(++slot->retiredLength >= HAZARD_SCAN)
+		{
+			scanHazards(slot);
+		}
+	}
+	else if(stackKind == STACK_EPOCH)
+	{
+		// The epoch is read after the node came off the stack.
+		unsigned long long epoch = __atomic_load_n(&globalEpoch, __ATOMIC_SEQ_CST);
+		unsigned int list = epoch%3;
+
+		// Whatever is still in this list is from three epochs ago.
+		if(slot->limbo[list] && (slot->limboEpoch[list] != epoch))
+		{
+			freeList(slot, slot->limbo[list]);
+			slot->limbo[list] = NULL;
+		}
+
+		node->retiredNext = slot->limbo[list];
+		slot->limbo[list] = node;
+		slot->limboEpoch[list] = epoch;
+	}
+	else
+	{
+		// Leaking, so it just waits for the end of the run.
+		node->retiredNext = slot->retired;
+		slot->retired = node;
+	}
+}
+
+// This function pushes a node on the Treiber stack. Push never looks inside
+// of another node, so it needs no protection.
+static void treiberPush(stackNode* node)
+{
+	stackNode* top = __atomic_load_n(&stackTop, __ATOMIC_RELAXED);
+
+	do
+	{
+		node->next = top;
+	}
+	while(!__atomic_compare_exchange_n(&stackTop, &top, node, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+// This function pops a node off of the Treiber stack, or returns NULL if
+// it is empty. With hazard pointers, the top is published and then checked
+// again, since it could have been popped and freed in between.
+static stackNode* treiberPop(stackSlot* slot)
+{
+	announceSlot* mine = &announcements[slot->index];
+	stackNode* top;
+
+	while(true)
+	{
+		top = __atomic_load_n(&stackTop, __ATOMIC_ACQUIRE);
+
+		if(top == NULL)
+		{
+			break;
+		}
+
+		if(stackKind == STACK_HAZARD)
+		{
+			__atomic_store_n(&mine->hazard, top, __ATOMIC_SEQ_CST);
+
+			if(__atomic_load_n(&stackTop, __ATOMIC_SEQ_CST) != top)
+			{
+				continue;
+			}
+		}
+
+		stackNode* next = top->next;
+
+		if(__atomic_compare_exchange_n(&stackTop, &top, next, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+		{
+			break;
+		}
+	}
+
+	if(stackKind == STACK_HAZARD)
+	{
+		__atomic_store_n(&mine->hazard, NULL, __ATOMIC_RELEASE);
+	}
+
+	return top;
+}
+
+// This function adds up how many nodes are waiting to be freed while the
+// stack test runs, and keeps the most that there ever were.
+static void watchPending(void* watchObject)
+{
+	stackWatch* watch = (stackWatch*)watchObject;
+	unsigned long long pending = 0;
+
+	for(unsigned int i = 0; i < watch->threadNo; i++)
+	{
+		pending += __atomic_load_n(&watch->slots[i].pending, __ATOMIC_RELAXED);
+	}
+
+	if(pending > watch->peakPending)
+	{
+		watch->peakPending = pending;
+	}
+}
+
+// This is the function that each thread runs during the stack test. Every
+// thread pushes and pops in turn, so the stack stays about the same size.
+static void* stackGenerator(void* slotObject)
+{
+	stackSlot* slot = (stackSlot*)slotObject;
+
+	timedRunBegin();
+
+	while(!timedRunOver())
+	{
+		for(unsigned int i = 0; i < STACK_CHUNK; i++)
+		{
+			if(stackKind == STACK_MUTEX)
+			{
+				// The mutex stack can free a node as soon as it
+				// has it, since nobody else can be looking at it.
+				if(i & 1)
+				{
+					pthread_mutex_lock(&stackMutex);
+					stackNode* top = stackTop;
+					if(top)
+					{
+						stackTop = top->next;
+					}
+					pthread_mutex_unlock(&stackMutex);
+
+					if(top)
+					{
+						delete top;
+						slot->pops++;
+					}
+				}
+				else
+				{
+					stackNode* node = new stackNode;
+					node->value = slot->ops + i;
+
+					pthread_mutex_lock(&stackMutex);
+					node->next = stackTop;
+					stackTop = node;
+					pthread_mutex_unlock(&stackMutex);
+
+					slot->pushes++;
+				}
+
+				continue;
+			}
+
+			if(i & 1)
+			{
+				// Only pop looks inside of nodes that another
+				// thread could free, so only pop is in an epoch.
+				if(stackKind == STACK_EPOCH)
+				{
+					enterEpoch(slot);
+				}
+
+				stackNode* top = treiberPop(slot);
+
+				if(top)
+				{
+					retireNode(slot, top);
+					slot->pops++;
+				}
+
+				if(stackKind == STACK_EPOCH)
+				{
+					leaveEpoch(slot);
+				}
+			}
+			else
+			{
+				stackNode* node = new stackNode;
+				node->value = slot->ops + i;
+				treiberPush(node);
+				slot->pushes++;
+			}
+
+			if((stackKind == STACK_EPOCH) && (((i + 1) % EPOCH_ADVANCE) == 0))
+			{
+				advanceEpoch();
+			}
+		}
+
+		slot->ops += STACK_CHUNK;
+	}
+
+	return (NULL);
+}
+
+// This function runs the stack test.
+void runStackTest(const char* filename, const stackType* stacks, unsigned int stackCount,
+		  unsigned int maxThreads, unsigned int cellMsecs)
+{
+	// Create a temp filename to append the spreadsheet folder location
+	// in front of the desired filename.
+	string tempFilename = SPREADSHEET_FOLDER;
+	tempFilename += "/";
+	tempFilename += filename;
+
+	ofstream dataDump(tempFilename.c_str());
+
+	// Write the top line of the data file.
+	dataDump << "Stack,Threads,Ops/Sec,Peak Unfreed (KB),Freed During Run (%),"
+		 << "Avg Reclaim Latency (us),Max Reclaim Latency (us),Result\n";
+
+	pthread_mutex_init(&stackMutex, NULL);
+
+	for(unsigned int s = 0; s < stackCount; s++)
+	{
+		stackKind = stacks[s];
+
+		for(unsigned int threadNo = MIN_THREADS; threadNo <= maxThreads; threadNo++)
+		{
+			// Start every run from the same stack.
+			stackTop = NULL;
+			for(unsigned int i = 0; i < STACK_PREFILL; i++)
+			{
+				stackNode* node = new stackNode;
+				node->value = i;
+				node->next = stackTop;
+				stackTop = node;
+			}
+
+			stackSlot* slots = allocateThreadSlots<stackSlot>(threadNo);
+			announcements = allocateThreadSlots<announceSlot>(threadNo);
+
+			if(!slots || !announcements)
+			{
+				freeThreadSlots(announcements);
+				announcements = NULL;
+				freeThreadSlots(slots);
+				break;
+			}
+			announceCount = threadNo;
+			globalEpoch = 0;
+
+			for(unsigned int i = 0; i < threadNo; i++)
+			{
+				slots[i].index = i;
+			}
+
+			// Keep an eye on how much memory is waiting to be freed
+			// until the time is up.
+			stackWatch watch;
+			watch.slots = slots;
+			watch.threadNo = threadNo;
+			watch.peakPending = 0;
+
+			double elapsedSecs;
+			bool created = runTimedThreads(stackGenerator, slots, sizeof(stackSlot), threadNo, cellMsecs,
+						       &elapsedSecs, watchPending, &watch, STACK_SAMPLE_USECS);
+			unsigned long long peakPending = watch.peakPending;
+
+			// Total everything up.
+			unsigned long long totalOps = 0, pushes = 0, pops = 0, retired = 0, stillPending = 0;
+			unsigned long long latencyNsecs = 0, latencyCount = 0, latencyMax = 0;
+
+			for(unsigned int i = 0; i < threadNo; i++)
+			{
+				totalOps += slots[i].ops;
+				pushes += slots[i].pushes;
+				pops += slots[i].pops;
+				retired += slots[i].retiredCount;
+				stillPending += slots[i].pending;
+				latencyNsecs += slots[i].latencyNsecs;
+				latencyCount += slots[i].latencyCount;
+
+				if(slots[i].latencyMax > latencyMax)
+				{
+					latencyMax = slots[i].latencyMax;
+				}
+			}
+
+			if(stillPending > peakPending)
+			{
+				peakPending = stillPending;
+			}
+
+			// Every node has to be on the stack, or have been popped.
+			unsigned long long left = 0;
+			while(stackTop)
+			{
+				stackNode* next = stackTop->next;
+				delete stackTop;
+				stackTop = next;
+				left++;
+			}
+
+			unsigned long long expected = STACK_PREFILL + pushes - pops;
+			float endResult = (expected ? (float)((double)left/(double)expected) : 1.0f);
+
+			// Now that nobody is looking, free what is still waiting.
+			// It doesn't count towards the latency.
+			for(unsigned int i = 0; i < threadNo; i++)
+			{
+				stackNode* node = slots[i].retired;
+				while(node)
+				{
+					stackNode* next = node->retiredNext;
+					delete node;
+					node = next;
+				}
+
+				for(unsigned int j = 0; j < 3; j++)
+				{
+					node = slots[i].limbo[j];
+					while(node)
+					{
+						stackNode* next = node->retiredNext;
+						delete node;
+						node = next;
+					}
+				}
+			}
+
+			if(!created)
+			{
+				cout << "Could not create the threads!\n";
+				freeThreadSlots(announcements);
+				announcements = NULL;
+				freeThreadSlots(slots);
+				break;
+			}
+
+			double throughput = (double)totalOps/elapsedSecs;
+
+			dataDump << stackName(stackKind) << "," << threadNo << ","
+				 << (unsigned long long)throughput << ","
+				 << (double)peakPending*sizeof(stackNode)/1024.0 << ",";
+
+			if(stackKind == STACK_MUTEX)
+			{
+				// The mutex stack frees every node right away.
+				dataDump << "100,0,0,";
+			}
+			else
+			{
+				dataDump << (retired ? 100.0*(retired - stillPending)/retired : 100.0) << ","
+					 << (latencyCount ? (double)latencyNsecs/latencyCount/1000.0 : 0) << ","
+					 << (double)latencyMax/1000.0 << ",";
+			}
+
+			dataDump << endResult << "\n";
+			dataDump.flush();
+
+			cout << stackName(stackKind) << ": " << threadNo << " threads, "
+			     << (unsigned long long)throughput << " ops/sec, "
+			     << peakPending << " nodes waiting at most\n";
+
+			freeThreadSlots(announcements);
+			announcements = NULL;
+			freeThreadSlots(slots);
+		}
+	}
+
+	pthread_mutex_destroy(&stackMutex);
+
+	// Append an extra new line character to the end of the file.
+	dataDump << "\n";
+	dataDump.close();
+}
@@ -0,0 +1,62 @@
+// Author: Jason Tennyson
+// File: TreiberStack.h
+// Date: 10/19/26
+//
+// This file contains the definitions for the stack test. A Treiber stack is
+// a linked list where push and pop swing the top pointer with a compare and
+// swap, so it never takes a lock. The catch is the node that pop takes off.
+// Another thread can still be looking at it, having read the top pointer
+// just before the pop, so it can't be freed right away. How the program
+// finds out when it is safe to free is called memory reclamation, and what
+// it costs decides whether the lock free stack beats a mutex at all.
+//
+// The test runs a stack behind a mutex and a Treiber stack with three kinds
+// of reclamation:
+//
+//	leak		Nothing is freed until the run is over. This is what
+//			the stack costs with no reclamation at all.
+//	hazard		Hazard pointers. Before a thread looks at a node, it
+//			publishes a pointer to it, and a node is only freed
+//			once no thread has published a pointer to it.
+//	epoch		Epoch based reclamation. Threads say which epoch they
+//			are in while they use the stack, and a node is freed
+//			once every thread has moved two epochs past the one it
+//			was taken off in.
+
+#ifndef TreiberStack_h_
+#define TreiberStack_h_
+
+#define DEFAULT_STACK_MSECS	(200)				// Default time per cell (ms).
+#define MAX_STACK_MSECS		(60000)				// Maximum time per cell (ms).
+#define STACK_CHUNK		(256)				// Operations between flag checks.
+#define STACK_PREFILL		(1024)				// Nodes on the stack to start.
+#define HAZARD_SCAN		(128)				// Retired nodes between scans.
+#define EPOCH_ADVANCE		(64)				// Operations between advance tries.
+#define RECLAIM_SAMPLE		(64)				// Retired nodes per timed one.
+#define STACK_SAMPLE_USECS	(1000)				// Time between memory samples (us).
+
+// These are the stacks that can be compared.
+enum stackType
+{
+	STACK_MUTEX = 0,	// A linked list behind a mutex.
+	STACK_LEAK,		// Treiber, with nothing freed until the end.
+	STACK_HAZARD,		// Treiber, with hazard pointers.
+	STACK_EPOCH,		// Treiber, with epoch based reclamation.
+	STACK_TYPES		// The number of stacks.
+};
+
+// This function returns the name of a stack.
+const char* stackName(stackType type);
+
+// This function reads a comma separated list of stack names into types,
+// which must have room for STACK_TYPES entries. Returns the count.
+unsigned int stackListFromNames(const char* names, stackType* types);
+
+// This function runs every stack with 1 up to maxThreads threads for
+// cellMsecs each, with every thread pushing and popping in turn, and saves
+// the throughput, the most memory that was waiting to be freed and how long
+// nodes waited to be freed to filename in the spreadsheet folder.
+void runStackTest(const char* filename, const stackType* stacks, unsigned int stackCount,
+		  unsigned int maxThreads, unsigned int cellMsecs);
+
+#endif
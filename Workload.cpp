@@ -0,0 +1,198 @@
+// Author: Jason Tennyson
+// File: Workload.cpp
+// Date: 10/19/26
+//
+// This file contains the workload kernels and the function that creates
+// them by name.
+
+#include "Workload.h"
+#include "SyntheticWork.h"
+#include "TraceRecorder.h"
+#include <cstring>
+#include <cstdlib>
+#include <strings.h>
+
+// This is the constructor for the incrementWorkload class.
+incrementWorkload::incrementWorkload(const workloadConfig& config)
+{
+	shared = config.shared;
+	safe = config.safe;
+	csLoops = workLoopsFor(config.csNsecs);
+	parLoops = workLoopsFor(config.parNsecs);
+	threads = 0;
+	sharedValue = 0;
+	counters = NULL;
+
+	sharedLock = new syncLock(config.strategy);
+}
+
+// This is the destructor for the incrementWorkload class.
+incrementWorkload::~incrementWorkload(void)
+{
+	free(counters);
+	delete sharedLock;
+}
+
+// This function clears the counters for a new run.
+void incrementWorkload::prepare(unsigned int threadCount)
+{
+	threads = threadCount;
+	sharedValue = 0;
+
+	// The private counters are cache line aligned so that threads do not
+	// fight over a line that they don't actually share.
+	free(counters);
+	if(posix_memalign((void**)&counters, CACHE_LINE_SIZE, threads*sizeof(paddedCounter)) != 0)
+	{
+		counters = NULL;
+		return;
+	}
+	memset(counters, 0, threads*sizeof(paddedCounter));
+}
+
+// This function does ops increments for one thread, the same way that
+// calcGenerator does them. Every increment goes through a volatile pointer
+// so that the compiler can't fold a whole chunk into a single add, which
+// would make every chunk cost the same no matter how big it is.
+void incrementWorkload::run(unsigned int threadIndex, unsigned int ops)
+{
+	// If the recorder is on, every trip through the lock is recorded.
+	bool traced = traceEnabled();
+
+	// With synthetic work, every operation takes the lock on its own, just
+	// long enough for its critical section work and the increment.
+	if((csLoops > 0) || (parLoops > 0))
+	{
+		volatile unsigned long long* value = (shared ? &sharedValue : &counters[threadIndex].value);
+		bool locking = (shared && safe);
+		bool atomic = (sharedLock->type() == SYNC_ATOMIC);
+		bool tracedLock = (traced && locking && !atomic);
+
+		for(unsigned int i = 0; i < ops; i++)
+		{
+			doSyntheticWork(parLoops);
+
+			if(tracedLock)
+			{
+				traceEvent(TRACE_LOCK_BEGIN, 0);
+			}
+
+			if(locking)
+			{
+				sharedLock->lock();
+			}
+
+			if(tracedLock)
+			{
+				traceEvent(TRACE_LOCK_ACQUIRED, 0);
+			}
+
+			doSyntheticWork(csLoops);
+
+			// The atomic strategy has no lock, so its critical section
+			// work is done unprotected, like calcGenerator does.
+			if(locking && atomic)
+			{
+				__atomic_fetch_add(value, 1, __ATOMIC_RELAXED);
+			}
+			else
+			{
+				(*value)++;
+			}
+
+			if(locking)
+			{
+				sharedLock->unlock();
+			}
+
+			if(tracedLock)
+			{
+				traceEvent(TRACE_LOCK_RELEASED, 0);
+			}
+		}
+	}
+	else if(shared)
+	{
+		volatile unsigned long long* value = &sharedValue;
+
+		if(safe && (sharedLock->type() == SYNC_ATOMIC))
+		{
+			// With atomics, every increment is made safe on its own.
+			for(unsigned int i = 0; i < ops; i++)
+			{
+				__atomic_fetch_add(value, 1, __ATOMIC_RELAXED);
+			}
+		}
+		else
+		{
+			// Hold the lock for the whole chunk, like calcGenerator does.
+			if(safe)
+			{
+				if(traced)
+				{
+					traceEvent(TRACE_LOCK_BEGIN, 0);
+				}
+
+				sharedLock->lock();
+
+				if(traced)
+				{
+					traceEvent(TRACE_LOCK_ACQUIRED, 0);
+				}
+			}
+
+			for(unsigned int i = 0; i < ops; i++)
+			{
+				(*value)++;
+			}
+
+			if(safe)
+			{
+				sharedLock->unlock();
+
+				if(traced)
+				{
+					traceEvent(TRACE_LOCK_RELEASED, 0);
+				}
+			}
+		}
+	}
+	else
+	{
+		// Count in this thread's own cache line.
+		volatile unsigned long long* value = &counters[threadIndex].value;
+
+		for(unsigned int i = 0; i < ops; i++)
+		{
+			(*value)++;
+		}
+	}
+}
+
+// This function compares the count to the number of operations done.
+float incrementWorkload::finish(unsigned long long totalOps)
+{
+	unsigned long long total = sharedValue;
+
+	// Total the private counters if we used them.
+	if(!shared)
+	{
+		for(unsigned int i = 0; i < threads; i++)
+		{
+			total += counters[i].value;
+		}
+	}
+
+	return (totalOps ? (float)((double)total/(double)totalOps) : 1.0f);
+}
+
+// This function creates the workload with the given name.
+workload* createWorkload(const char* name, const workloadConfig& config)
+{
+	if(strcasecmp(name, "increment") == 0)
+	{
+		return new incrementWorkload(config);
+	}
+
+	return NULL;
+}
@@ -0,0 +1,105 @@
+// Author: Jason Tennyson
+// File: Workload.h
+// Date: 10/19/26
+//
+// This file contains the interface that every workload kernel implements.
+// A workload is the thing the threads do over and over. The tests that are
+// not tied to a fixed n (like the duration test) hand out operations to the
+// kernel in chunks, so every kernel has to be able to pick up where it left
+// off on the next call.
+
+#ifndef Workload_h_
+#define Workload_h_
+
+#include <pthread.h>
+#include "SyncStrategy.h"
+
+#define MAX_WORKLOAD_THREADS	(1024)				// Most threads a kernel serves.
+#define CACHE_LINE_SIZE		(64)				// Bytes in a cache line.
+
+// This structure holds every setting a workload can be given. Each kernel
+// only looks at the settings that mean something to it.
+struct workloadConfig
+{
+	bool shared;		// Use one shared variable instead of one per thread.
+	bool safe;		// Protect the shared variable.
+	syncType strategy;	// How to protect it, if safe.
+	unsigned int csNsecs;	// Synthetic work inside the critical section.
+	unsigned int parNsecs;	// Synthetic work outside the critical section.
+
+	// This is the constructor. It fills in the defaults.
+	workloadConfig(void)
+	{
+		shared = false;
+		safe = false;
+		strategy = SYNC_MUTEX;
+		csNsecs = 0;
+		parNsecs = 0;
+	}
+};
+
+// This class is the interface every workload kernel implements.
+class workload
+{
+	public:
+		// This is the class destructor.
+		virtual ~workload(void) {}
+
+		// This function returns the name used to pick the kernel.
+		virtual const char* name(void) = 0;
+
+		// This function gets the kernel ready for a run with the given
+		// number of threads. It is not timed.
+		virtual void prepare(unsigned int threadCount) = 0;
+
+		// This function does ops operations on behalf of thread
+		// threadIndex. It can be called any number of times per run.
+		virtual void run(unsigned int threadIndex, unsigned int ops) = 0;
+
+		// This function checks the work after all of the threads are
+		// done. It returns 1 if every one of totalOps operations was
+		// accounted for, and less than 1 if data hazards lost some.
+		virtual float finish(unsigned long long totalOps) = 0;
+};
+
+// This class is the increment kernel that calcGenerator runs: every
+// operation adds one to either a private counter or the shared variable.
+class incrementWorkload : public workload
+{
+	public:
+		// This is the class constructor.
+		incrementWorkload(const workloadConfig& config);
+		// This is the class destructor.
+		~incrementWorkload(void);
+
+		const char* name(void) { return "increment"; }
+		void prepare(unsigned int threadCount);
+		void run(unsigned int threadIndex, unsigned int ops);
+		float finish(unsigned long long totalOps);
+
+	private:
+		// This structure keeps each private counter on its own cache line.
+		struct paddedCounter
+		{
+			unsigned long long value;
+			char pad[CACHE_LINE_SIZE - sizeof(unsigned long long)];
+		};
+
+		// The settings we were given.
+		bool shared, safe;
+		// The synthetic work per operation, in loops.
+		unsigned long long csLoops, parLoops;
+		// The number of threads in the current run.
+		unsigned int threads;
+		// The shared variable and the lock that protects it.
+		unsigned long long sharedValue;
+		syncLock* sharedLock;
+		// One private counter per thread.
+		paddedCounter* counters;
+};
+
+// This function creates the workload with the given name. It returns
+// NULL if there is no such workload. The caller deletes it when done.
+workload* createWorkload(const char* name, const workloadConfig& config);
+
+#endif
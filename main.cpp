@@ -7,6 +7,28 @@
 
 #include "ThreadTutorial.h"
 #include "CatHerder.h"
+#include "DurationTest.h"
+#include "OpenLoop.h"
+#include "PingPong.h"
+#include "Oversubscribe.h"
+#include "MemorySweep.h"
+#include "Numa.h"
+#include "ProcessMode.h"
+#include "TraceRecorder.h"
+#include "LiveStats.h"
+#include "CgroupLimits.h"
+#include "ClockSpeed.h"
+#include "HashMap.h"
+#include "TreiberStack.h"
+#include "PhaseBarrier.h"
+#include "RandomContention.h"
+#include "AutoTuner.h"
+#include "ResultCompare.h"
+#include "TlsCost.h"
+#include "DataParallel.h"
+#include "ScenarioFile.h"
+#include <unistd.h>
+#include <strings.h>
 
 using namespace std;
 
@@ -16,6 +38,63 @@ char* extractFilename(const char* filename);
 // This function is used to extract a user-provided number from the command line.
 unsigned int extractNumber(const char* argument);
 
+// This function checks whether an argument is the flag with the given name.
+bool argumentIs(const char* argument, const char* name);
+
+// This function is used to extract the text after the '=' in an argument.
+const char* extractText(const char* argument);
+
+// This function reads a -csns or -parns argument into csNsecs or parNsecs.
+bool extractWork(const char* argument, unsigned int* csNsecs, unsigned int* parNsecs);
+
+// This function reads the arguments for an automatic test and runs it.
+int autoMode(int argc, char** argv);
+
+// This function reads the arguments for a duration test and runs it.
+int durationMode(int argc, char** argv);
+
+// This function reads the arguments for an open loop test and runs it.
+int openLoopMode(int argc, char** argv);
+
+// This function reads the arguments for a ping-pong test and runs it.
+int pingPongMode(int argc, char** argv);
+
+// This function reads the arguments for an oversubscription test and runs it.
+int oversubscribeMode(int argc, char** argv);
+
+// This function reads the arguments for a memory test and runs it.
+int memoryMode(int argc, char** argv);
+
+// This function reads the arguments for a NUMA test and runs it.
+int numaMode(int argc, char** argv);
+
+// This function reads the arguments for a hash map test and runs it.
+int hashMapMode(int argc, char** argv);
+
+// This function reads the arguments for a stack test and runs it.
+int stackMode(int argc, char** argv);
+
+// This function reads the arguments for a phased test and runs it.
+int phasedMode(int argc, char** argv);
+
+// This function reads the arguments for a random number test and runs it.
+int randomMode(int argc, char** argv);
+
+// This function reads the arguments for the tuner and runs it.
+int tuneMode(int argc, char** argv);
+
+// This function reads the arguments for the compare mode and runs it.
+int compareMode(int argc, char** argv);
+
+// This function reads the arguments for a thread local storage test and runs it.
+int tlsMode(int argc, char** argv);
+
+// This function reads the arguments for the scenario mode and runs it.
+int scenarioMode(int argc, char** argv);
+
+// This function reads the arguments for the live stats reader and runs it.
+int statsMode(int argc, char** argv);
+
 // This is the function that starts everything.
 int main(int argc, char** argv)
 {
@@ -30,124 +109,117 @@ int main(int argc, char** argv)
 	// If the user has specified an argument in addition to running the program...
 	if(argc > 1)
 	{
+		// The modes with whole word names are checked first, so that they
+		// don't get mistaken for the single letter modes below.
+		if(argumentIs(argv[1], "duration"))
+		{
+			return durationMode(argc, argv);
+		}
+		else if(argumentIs(argv[1], "openloop"))
+		{
+			return openLoopMode(argc, argv);
+		}
+		else if(argumentIs(argv[1], "pingpong"))
+		{
+			return pingPongMode(argc, argv);
+		}
+		else if(argumentIs(argv[1], "oversub"))
+		{
+			return oversubscribeMode(argc, argv);
+		}
+		else if(argumentIs(argv[1], "memory"))
+		{
+			return memoryMode(argc, argv);
+		}
+		else if(argumentIs(argv[1], "numa"))
+		{
+			return numaMode(argc, argv);
+		}
+		else if(argumentIs(argv[1], "hashmap"))
+		{
+			return hashMapMode(argc, argv);
+		}
+		else if(argumentIs(argv[1], "stack"))
+		{
+			return stackMode(argc, argv);
+		}
+		else if(argumentIs(argv[1], "phased"))
+		{
+			return phasedMode(argc, argv);
+		}
+		else if(argumentIs(argv[1], "rng"))
+		{
+			return randomMode(argc, argv);
+		}
+		else if(argumentIs(argv[1], "tune"))
+		{
+			return tuneMode(argc, argv);
+		}
+		else if(argumentIs(argv[1], "compare"))
+		{
+			return compareMode(argc, argv);
+		}
+		else if(argumentIs(argv[1], "tls"))
+		{
+			return tlsMode(argc, argv);
+		}
+		else if(argumentIs(argv[1], "scenario"))
+		{
+			return scenarioMode(argc, argv);
+		}
+		else if(argumentIs(argv[1], "stats"))
+		{
+			return statsMode(argc, argv);
+		}
 		// If the user has specified an automatic test, look for more
 		// arguments that they have passed. Otherwise, we do nothing and exit.
-		if((argv[1][0] == '-') && ((argv[1][1] == 'a') || (argv[1][1] == 'A')))
+		else if((argv[1][0] == '-') && ((argv[1][1] == 'a') || (argv[1][1] == 'A')))
+		{
+			return autoMode(argc, argv);
+		}
+		// If the user wants a binary results file converted, look for the
+		// file name and the format that they want.
+		else if((argv[1][0] == '-') && ((argv[1][1] == 'c') || (argv[1][1] == 'C')))
 		{
-			// Set all possible input parameters to their default values.
 			string filename = DEFAULT_FILENAME;
-			unsigned int delta = DEFAULT_DELTA;
-			unsigned int max = DEFAULT_CALCULATIONS;
-			unsigned int samples = 0;
+			bool json = false;
+			bool summary = false;
 
-			// If we have more than just an auto flag, parse the rest.
-			if(argc > 2)
+			for(int i = 2; i < argc; i++)
 			{
-				// Argument 3 (index 2) is the first argument after the -auto argument.
-				// We start there and parse until we reach the argument count.
-				for(int i = 2; i < argc; i++)
+				if(argv[i][0] == '-')
 				{
-					// If we have found an argument indicator, decode it.
-					if(argv[i][0] == '-')
+					if(((argv[i][1] == 'f') || (argv[i][1] == 'F')) && extractFilename(argv[i]))
 					{
-						if((argv[i][1] == 'f') || (argv[i][1] == 'F'))
-						{
-							// The user is specifying a file name.
-							// If the file name is valid, use it.
-							if(extractFilename(argv[i]))
-							{
-								filename = strdup(extractFilename(argv[i]));
-							}
-						}
-						else if((argv[i][1] == 'd') || (argv[i][1] == 'D'))
-						{
-							// The user is specifying the n step size.
-							delta = extractNumber(argv[i]);
-
-							// If the number is out of bounds, throw it out.
-							if((delta < MIN_CALCULATIONS) || (delta > MAX_CALCULATIONS))
-							{
-								delta = DEFAULT_DELTA;
-							}
-						}
-						else if((argv[i][1] == 'm') || (argv[i][1] == 'M'))
-						{
-							// Store the user-defined maximum.
-							max = extractNumber(argv[i]);
-
-							// If the number is out of bounds, throw it out.
-							if((max < MIN_CALCULATIONS) || (max > MAX_CALCULATIONS))
-							{
-								max = DEFAULT_CALCULATIONS;
-							}
-						}
-						else if((argv[i][1] == 't') || (argv[i][1] == 'T'))
-						{
-							// Store the user-defined thread count.
-							nThreads = extractNumber(argv[i]);
-
-							// If the number is out of bounds, throw it out.
-							if((nThreads < MIN_THREADS) || (nThreads > MAX_THREADS))
-							{
-								nThreads = DEFAULT_THREADS;
-							}
-						}
-						else if((argv[i][1] == 's') || (argv[i][1] == 'S'))
-						{
-							if((argv[i][2] == 'h') || (argv[i][2] == 'H'))
-							{
-								// The user wants shared variable usage.
-								gVarUsed = true;
-							}
-							else if((argv[i][2] == 'a') || (argv[i][2] == 'A'))
-							{
-								if((argv[i][3] == 'f') || (argv[i][3] == 'F'))
-								{
-									// The user wants thread safety.
-									threadSafe = true;
-								}
-								else if((argv[i][3] == 'm') || (argv[i][3] == 'M'))
-								{
-									// The user is specifying the number of samples.
-									samples = extractNumber(argv[i]);
-
-									// If the number is out of bounds, throw it out.
-									if(samples > MAX_CALCULATIONS)
-									{
-										samples = 0;
-									}
-								}
-							}
-						}
+						// The user is specifying a file name.
+						filename = extractFilename(argv[i]);
+					}
+					else if((argv[i][1] == 'j') || (argv[i][1] == 'J'))
+					{
+						// The user wants JSON instead of CSV.
+						json = true;
+					}
+					else if((argv[i][1] == 's') || (argv[i][1] == 'S'))
+					{
+						// The user only wants a summary printed.
+						summary = true;
 					}
 				}
 			}
 
-			// Append the file extension to the file name we are using.
-			filename += FILE_EXTENSION;
+			// The results file lives in the spreadsheet folder.
+			string binaryPath = SPREADSHEET_FOLDER;
+			binaryPath += "/";
+			binaryPath += filename + BINARY_EXTENSION;
 
-			// If the user has specified a sample number, calculate delta.
-			if(samples)
-			{
-				delta = max/samples;
-			}
+			bool converted = (summary ? summarizeResults(binaryPath.c_str())
+						  : exportResults(binaryPath.c_str(), json));
 
-			// If the user gave a delta value that is larger than max, fix it.
-			if((delta > max) || (delta == 0))
+			if(!converted)
 			{
-				max = DEFAULT_CALCULATIONS;
-				delta = DEFAULT_DELTA;
+				cout << binaryPath << " is not a results file that we can read!\n";
+				return 1;
 			}
-
-			// Tell the user that we are starting.
-			cout << "Auto test started! This may take a while...\n";
-
-			// Call the auto test function.
-			runAutoTest(filename.c_str(), gVarUsed, threadSafe, delta, max, nThreads);
-
-			cout << filename << " has been saved in the '"
-				 << SPREADSHEET_FOLDER << "' folder!\n";
-			cout << "Open a spreadsheet program to do operations on the data!\n\n";
 		}
 	}
 	else
@@ -269,3 +341,1828 @@ unsigned int extractNumber(const char* argument)
 
 	return output;
 }
+
+// This function returns the text after the '=' sign of an argument, or an
+// empty string if there is no '=' sign.
+const char* extractText(const char* argument)
+{
+	const char* equals = strchr(argument, '=');
+
+	return (equals ? (equals + 1) : "");
+}
+
+// This function checks whether an argument is the flag with the given name.
+// The name is everything between the dash and the '=' sign (if there is
+// one), and the check does not care about upper or lower case.
+bool argumentIs(const char* argument, const char* name)
+{
+	// Flags always start with a dash.
+	if(argument[0] != '-')
+	{
+		return false;
+	}
+
+	unsigned int length = strlen(name);
+
+	// The name has to match and then the flag has to end or hit the '='.
+	return ((strncasecmp(&argument[1], name, length) == 0) &&
+		((argument[length + 1] == '\0') || (argument[length + 1] == '=')));
+}
+
+// This function reads the synthetic work flags, which every mode with a
+// critical section takes. -csns is the work inside of the critical section
+// and -parns is the work outside of it, both in nanoseconds, and a number
+// that is out of bounds is thrown out. Returns false if the argument is
+// neither flag.
+bool extractWork(const char* argument, unsigned int* csNsecs, unsigned int* parNsecs)
+{
+	unsigned int* work;
+
+	if(argumentIs(argument, "csns"))
+	{
+		work = csNsecs;
+	}
+	else if(argumentIs(argument, "parns"))
+	{
+		work = parNsecs;
+	}
+	else
+	{
+		return false;
+	}
+
+	*work = extractNumber(argument);
+
+	// If the number is out of bounds, throw it out.
+	if(*work > MAX_WORK_NSECS)
+	{
+		*work = 0;
+	}
+
+	return true;
+}
+
+// This function reads the arguments for an automatic test and runs it. The
+// scenario mode calls it once for every scenario, with the arguments that
+// the scenario turns into.
+int autoMode(int argc, char** argv)
+{
+	// These are the same as the ones that main starts with, but every
+	// automatic test starts over from them.
+	bool gVarUsed = false;
+	bool threadSafe = false;
+	unsigned int nThreads = DEFAULT_THREADS;
+
+	// Set all possible input parameters to their default values.
+	string filename = DEFAULT_FILENAME;
+	unsigned int delta = DEFAULT_DELTA;
+	unsigned int max = DEFAULT_CALCULATIONS;
+	unsigned int samples = 0;
+	unsigned int budget = 0;
+	unsigned int repetitions = 1;
+	unsigned int firstThreads = MIN_THREADS;
+	unsigned int min = 0;
+	bool reuseCache = true;
+	bool binary = false;
+	bool surface = false;
+	bool processes = false;
+	bool atomicProcesses = false;
+	bool trace = false;
+	bool liveStats = false;
+	bool uncapped = false;
+	bool clockCheck = false;
+	bool lostCheck = false;
+	bool taggedWrites = false;
+	bool dataWorkload = false;
+	dataKernel kernel = DATA_SAMPLESORT;
+	unsigned int csWork = 0;
+	unsigned int parWork = 0;
+
+	// If we have more than just an auto flag, parse the rest.
+	if(argc > 2)
+	{
+		// Argument 3 (index 2) is the first argument after the -auto argument.
+		// We start there and parse until we reach the argument count.
+		for(int i = 2; i < argc; i++)
+		{
+			// The whole word flags are checked first, so that they
+			// don't get mistaken for the single letter ones.
+			if(extractWork(argv[i], &csWork, &parWork))
+			{
+				// The user wants synthetic work in the operations.
+			}
+			else if(argumentIs(argv[i], "procs"))
+			{
+				// The user wants processes instead of threads,
+				// sharing a mutex or using atomics.
+				processes = true;
+				atomicProcesses = (strcasecmp(extractText(argv[i]), "atomic") == 0);
+			}
+			else if(argumentIs(argv[i], "trace"))
+			{
+				// The user wants a timeline of the threads.
+				trace = true;
+			}
+			else if(argumentIs(argv[i], "live"))
+			{
+				// The user wants to watch from another terminal.
+				liveStats = true;
+			}
+			else if(argumentIs(argv[i], "uncapped"))
+			{
+				// The user wants every thread count, even the
+				// ones that the container can't run at once.
+				uncapped = true;
+			}
+			else if(argumentIs(argv[i], "clock"))
+			{
+				// The user wants the clock speed around every
+				// cell, and cycles per operation.
+				clockCheck = true;
+			}
+			else if(argumentIs(argv[i], "lost"))
+			{
+				// The user wants to know how many increments were
+				// lost in every cell, and with tagged, how often
+				// the shared variable changed hands.
+				lostCheck = true;
+				taggedWrites = (strcasecmp(extractText(argv[i]), "tagged") == 0);
+			}
+			else if(argumentIs(argv[i], "data"))
+			{
+				// The user wants every cell to sort or group n
+				// records instead of doing the increments.
+				dataWorkload = dataKernelFromName(extractText(argv[i]), &kernel);
+
+				if(!dataWorkload)
+				{
+					cout << "WARNING: There is no data workload called '"
+					     << extractText(argv[i]) << "', using the increments.\n";
+				}
+			}
+			else if(argumentIs(argv[i], "reps"))
+			{
+				// The user wants every cell measured more than
+				// once, for the compare mode.
+				repetitions = extractNumber(argv[i]);
+
+				// If the number is out of bounds, throw it out.
+				if((repetitions == 0) || (repetitions > MAX_REPETITIONS))
+				{
+					repetitions = 1;
+				}
+			}
+			else if(argumentIs(argv[i], "tmin"))
+			{
+				// The user wants the sweep to start at more
+				// than one thread.
+				firstThreads = extractNumber(argv[i]);
+
+				// If the number is out of bounds, throw it out.
+				if((firstThreads < MIN_THREADS) || (firstThreads > MAX_THREADS))
+				{
+					firstThreads = MIN_THREADS;
+				}
+			}
+			else if(argumentIs(argv[i], "nmin"))
+			{
+				// The user wants n to start somewhere other
+				// than the step size.
+				min = extractNumber(argv[i]);
+
+				// If the number is out of bounds, throw it out.
+				if((min < MIN_CALCULATIONS) || (min > MAX_CALCULATIONS))
+				{
+					min = 0;
+				}
+			}
+			else if(argumentIs(argv[i], "surface"))
+			{
+				// The user wants to sweep the synthetic work
+				// instead of n.
+				surface = true;
+			}
+			// If we have found an argument indicator, decode it.
+			else if(argv[i][0] == '-')
+			{
+				if((argv[i][1] == 'f') || (argv[i][1] == 'F'))
+				{
+					// The user is specifying a file name.
+					// If the file name is valid, use it.
+					if(extractFilename(argv[i]))
+					{
+						filename = strdup(extractFilename(argv[i]));
+					}
+				}
+				else if((argv[i][1] == 'd') || (argv[i][1] == 'D'))
+				{
+					// The user is specifying the n step size.
+					delta = extractNumber(argv[i]);
+
+					// If the number is out of bounds, throw it out.
+					if((delta < MIN_CALCULATIONS) || (delta > MAX_CALCULATIONS))
+					{
+						delta = DEFAULT_DELTA;
+					}
+				}
+				else if((argv[i][1] == 'm') || (argv[i][1] == 'M'))
+				{
+					// Store the user-defined maximum.
+					max = extractNumber(argv[i]);
+
+					// If the number is out of bounds, throw it out.
+					if((max < MIN_CALCULATIONS) || (max > MAX_CALCULATIONS))
+					{
+						max = DEFAULT_CALCULATIONS;
+					}
+				}
+				else if((argv[i][1] == 'b') || (argv[i][1] == 'B'))
+				{
+					if((argv[i][2] == 'i') || (argv[i][2] == 'I'))
+					{
+						// The user wants a binary results file too.
+						binary = true;
+					}
+					else
+					{
+						// The user wants an adaptive test with a time
+						// budget in seconds instead of fixed steps.
+						budget = extractNumber(argv[i]);
+
+						// If the number is out of bounds, throw it out.
+						if(budget > MAX_BUDGET)
+						{
+							budget = 0;
+						}
+					}
+				}
+				else if((argv[i][1] == 'n') || (argv[i][1] == 'N'))
+				{
+					// The user wants everything measured fresh,
+					// even if the result cache already has it.
+					reuseCache = false;
+				}
+				else if((argv[i][1] == 't') || (argv[i][1] == 'T'))
+				{
+					// Store the user-defined thread count.
+					nThreads = extractNumber(argv[i]);
+
+					// If the number is out of bounds, throw it out.
+					if((nThreads < MIN_THREADS) || (nThreads > MAX_THREADS))
+					{
+						nThreads = DEFAULT_THREADS;
+					}
+				}
+				else if((argv[i][1] == 's') || (argv[i][1] == 'S'))
+				{
+					if((argv[i][2] == 'h') || (argv[i][2] == 'H'))
+					{
+						// The user wants shared variable usage.
+						gVarUsed = true;
+					}
+					else if((argv[i][2] == 'a') || (argv[i][2] == 'A'))
+					{
+						if((argv[i][3] == 'f') || (argv[i][3] == 'F'))
+						{
+							// The user wants thread safety.
+							threadSafe = true;
+						}
+						else if((argv[i][3] == 'm') || (argv[i][3] == 'M'))
+						{
+							// The user is specifying the number of samples.
+							samples = extractNumber(argv[i]);
+
+							// If the number is out of bounds, throw it out.
+							if(samples > MAX_CALCULATIONS)
+							{
+								samples = 0;
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+
+	// The binary results file gets the same name as the spreadsheet.
+	string binaryFilename = filename + BINARY_EXTENSION;
+	string processFilename = filename + PROCESS_EXTENSION;
+	string traceFilename = filename + TRACE_EXTENSION;
+	string throttleFilename = filename + THROTTLE_EXTENSION;
+	string clockFilename = filename + CLOCK_EXTENSION;
+	string lostFilename = filename + LOST_EXTENSION;
+	string dataFilename = filename + DATA_EXTENSION;
+
+	// Append the file extension to the file name we are using.
+	filename += FILE_EXTENSION;
+
+	// Open the binary results file if the user asked for it.
+	if(binary && !enableBinaryResults(binaryFilename.c_str()))
+	{
+		cout << "WARNING: The binary results file could not be opened.\n";
+		binary = false;
+	}
+
+	// Turn on the trace recorder if the user wants a timeline.
+	if(trace && !traceEnable(DEFAULT_TRACE_EVENTS))
+	{
+		cout << "WARNING: The trace recorder could not be turned on.\n";
+		trace = false;
+	}
+
+	// The data parallel workloads only run in threads, and they
+	// don't increment anything.
+	if(dataWorkload && processes)
+	{
+		cout << "NOTE: The data workloads only run in threads, so -procs is ignored.\n";
+		processes = false;
+	}
+	if(dataWorkload && lostCheck)
+	{
+		cout << "NOTE: The data workloads don't increment anything, so -lost is ignored.\n";
+		lostCheck = false;
+	}
+	if(dataWorkload && !enableDataWorkload(dataFilename.c_str(), kernel))
+	{
+		cout << "WARNING: The data file could not be opened, using the increments.\n";
+		dataWorkload = false;
+	}
+
+	// Set up the shared memory if the user wants processes.
+	if(processes && !enableProcessMode(processFilename.c_str(), atomicProcesses))
+	{
+		cout << "WARNING: The shared memory could not be set up, using threads.\n";
+		processes = false;
+	}
+
+	// In a container, the cgroup can allow fewer CPUs than the
+	// machine has. Past that, the sweep measures the cgroup and not
+	// the threads, so it stops there unless the user says not to.
+	unsigned int cpuLimit = cgroupCpuLimit();
+	if(cpuLimit && (nThreads > cpuLimit))
+	{
+		cout << "NOTE: The cgroup limits this program to " << cpuLimit << " CPU"
+		     << ((cpuLimit == 1) ? "" : "s") << " (";
+		if(cgroupCpuQuota() > 0)
+		{
+			cout << "a quota of " << cgroupCpuQuota() << " CPUs, ";
+		}
+		cout << cgroupCpusetSize() << " in the cpuset).\n";
+
+		if(uncapped)
+		{
+			cout << "NOTE: Sweeping up to " << nThreads << " threads anyway, "
+			     << "the cells past " << cpuLimit << " will be oversubscribed.\n";
+		}
+		else
+		{
+			cout << "NOTE: The sweep will stop at " << cpuLimit
+			     << " threads. Use -uncapped to sweep them all anyway.\n";
+			nThreads = cpuLimit;
+		}
+	}
+
+	// Measure the clock speed around every cell if the user wants it.
+	if(clockCheck && !enableClockCheck(clockFilename.c_str()))
+	{
+		cout << "WARNING: The clock speed file could not be opened.\n";
+		clockCheck = false;
+	}
+
+	// Count the lost updates in every cell if the user wants it.
+	// The processes don't share the tagged word, so they only
+	// get the counts.
+	if(lostCheck && processes && taggedWrites)
+	{
+		cout << "NOTE: Tagged writes only work with threads, so the processes are only counted.\n";
+		taggedWrites = false;
+	}
+	if(lostCheck && !enableLostCheck(lostFilename.c_str(), taggedWrites))
+	{
+		cout << "WARNING: The lost update file could not be opened.\n";
+		lostCheck = false;
+	}
+
+	// With a CPU quota, every cell is checked for throttling.
+	bool throttleCheck = enableThrottleCheck(throttleFilename.c_str());
+	if(throttleCheck)
+	{
+		cout << "NOTE: The cgroup has a CPU quota, so throttled cells will be tried again.\n";
+	}
+
+	// If the user has specified a sample number, calculate delta.
+	if(samples)
+	{
+		delta = max/samples;
+	}
+
+	// If the user gave a delta value that is larger than max, fix it.
+	if((delta > max) || (delta == 0))
+	{
+		max = DEFAULT_CALCULATIONS;
+		delta = DEFAULT_DELTA;
+	}
+
+	// n starts at delta unless the user said otherwise, and can't
+	// start past max.
+	if((min == 0) || (min > max))
+	{
+		min = delta;
+	}
+
+	// The sweep can't start at more threads than it ends at.
+	if(firstThreads > nThreads)
+	{
+		cout << "NOTE: The sweep can't start at " << firstThreads << " threads and end at "
+		     << nThreads << ", so it will start at " << MIN_THREADS << ".\n";
+		firstThreads = MIN_THREADS;
+	}
+	setFirstThreads(firstThreads);
+
+	// Turn on the result cache so that finished cells survive an
+	// interruption and can be reused by the next run.
+	if(!enableResultCache(reuseCache))
+	{
+		cout << "WARNING: The result cache could not be opened.\n";
+	}
+
+	// Publish the live stats if the user wants to watch.
+	if(liveStats)
+	{
+		if(liveStatsEnable(surface ? "surface" : (budget ? "adaptive" : "auto")))
+		{
+			cout << "Live stats are on. Run this program with -stats to see them.\n";
+		}
+		else
+		{
+			cout << "WARNING: The live stats could not be published.\n";
+			liveStats = false;
+		}
+	}
+
+	// The planner measures every cell once, so repetitions are
+	// only for the fixed step and surface tests.
+	if(budget && !surface && (repetitions > 1))
+	{
+		cout << "NOTE: Adaptive tests measure every cell once, so -reps is ignored.\n";
+		repetitions = 1;
+	}
+	setCellRepetitions(repetitions);
+
+	// Tell the user that we are starting.
+	cout << "Auto test started! This may take a while...\n";
+
+	// If the user wants a surface, sweep the synthetic work at n = max.
+	// Otherwise, every cell uses the synthetic work they asked for.
+	if(surface)
+	{
+		runWorkSurfaceTest(filename.c_str(), gVarUsed, threadSafe, max, nThreads, csWork, parWork);
+	}
+	else
+	{
+		setSyntheticWork(csWork, parWork);
+
+		// If the user gave us a time budget, let the planner pick the
+		// samples, starting at delta. Otherwise, step through them.
+		if(budget)
+		{
+			runAdaptiveTest(filename.c_str(), gVarUsed, threadSafe, min, max, nThreads, budget);
+		}
+		else
+		{
+			runAutoTest(filename.c_str(), gVarUsed, threadSafe, min, delta, max, nThreads);
+		}
+	}
+
+	// Let the user know if we picked up where we left off.
+	if(cachedCellsReused())
+	{
+		cout << cachedCellsReused() << " cells were reused from the result cache.\n";
+	}
+
+	cout << filename << " has been saved in the '"
+		 << SPREADSHEET_FOLDER << "' folder!\n";
+
+	if(liveStats)
+	{
+		liveStatsFinish();
+	}
+
+	// Write out the timeline.
+	if(trace && traceExport(traceFilename.c_str()))
+	{
+		cout << traceFilename << " has been saved in the '"
+			 << SPREADSHEET_FOLDER << "' folder!\n";
+	}
+
+	// Close off the throttle file.
+	if(throttleCheck)
+	{
+		finishThrottleCheck();
+
+		cout << throttleFilename << " has been saved in the '"
+			 << SPREADSHEET_FOLDER << "' folder!\n";
+	}
+
+	// Close off the clock speed file.
+	if(clockCheck)
+	{
+		finishClockCheck();
+
+		cout << clockFilename << " has been saved in the '"
+			 << SPREADSHEET_FOLDER << "' folder!\n";
+	}
+
+	// Close off the data file.
+	if(dataWorkload)
+	{
+		finishDataWorkload();
+
+		cout << dataFilename << " has been saved in the '"
+			 << SPREADSHEET_FOLDER << "' folder!\n";
+	}
+
+	// Close off the lost update file.
+	if(lostCheck)
+	{
+		finishLostCheck();
+
+		cout << lostFilename << " has been saved in the '"
+			 << SPREADSHEET_FOLDER << "' folder!\n";
+	}
+
+	// Close off the per process file.
+	if(processes)
+	{
+		finishProcessMode();
+
+		cout << processFilename << " has been saved in the '"
+			 << SPREADSHEET_FOLDER << "' folder!\n";
+	}
+
+	// Close off the binary results file too.
+	if(binary)
+	{
+		finishBinaryResults();
+
+		cout << binaryFilename << " has been saved in the '"
+			 << SPREADSHEET_FOLDER << "' folder!\n";
+	}
+	cout << "Open a spreadsheet program to do operations on the data!\n\n";
+
+	return 0;
+}
+
+// This function reads the arguments for a duration test and runs it. The
+// kernel runs on every thread until the time is up.
+int durationMode(int argc, char** argv)
+{
+	// Set all possible input parameters to their default values.
+	string filename = DEFAULT_FILENAME;
+	string kernelName = "increment";
+	unsigned int nThreads = DEFAULT_THREADS;
+	unsigned int seconds = DEFAULT_DURATION;
+	unsigned int interval = DEFAULT_INTERVAL;
+	bool trace = false;
+	workloadConfig config;
+
+	for(int i = 2; i < argc; i++)
+	{
+		if(argumentIs(argv[i], "f") && extractFilename(argv[i]))
+		{
+			// The user is specifying a file name.
+			filename = extractFilename(argv[i]);
+		}
+		else if(argumentIs(argv[i], "t"))
+		{
+			// Store the user-defined thread count.
+			nThreads = extractNumber(argv[i]);
+
+			// If the number is out of bounds, throw it out.
+			if((nThreads < MIN_THREADS) || (nThreads > MAX_THREADS))
+			{
+				nThreads = DEFAULT_THREADS;
+			}
+		}
+		else if(argumentIs(argv[i], "secs"))
+		{
+			// Store the user-defined test length.
+			seconds = extractNumber(argv[i]);
+
+			// If the number is out of bounds, throw it out.
+			if((seconds == 0) || (seconds > MAX_DURATION))
+			{
+				seconds = DEFAULT_DURATION;
+			}
+		}
+		else if(argumentIs(argv[i], "interval"))
+		{
+			// Store the user-defined sample interval.
+			interval = extractNumber(argv[i]);
+
+			// If the number is out of bounds, throw it out.
+			if((interval < MIN_INTERVAL) || (interval > MAX_INTERVAL))
+			{
+				interval = DEFAULT_INTERVAL;
+			}
+		}
+		else if(argumentIs(argv[i], "workload") && extractFilename(argv[i]))
+		{
+			// The user is picking the kernel.
+			kernelName = extractFilename(argv[i]);
+		}
+		else if(extractWork(argv[i], &config.csNsecs, &config.parNsecs))
+		{
+			// The user wants synthetic work in the operations.
+		}
+		else if(argumentIs(argv[i], "sh"))
+		{
+			// The user wants shared variable usage.
+			config.shared = true;
+		}
+		else if(argumentIs(argv[i], "saf"))
+		{
+			// The user wants thread safety.
+			config.safe = true;
+		}
+		else if(argumentIs(argv[i], "trace"))
+		{
+			// The user wants a timeline of the threads.
+			trace = true;
+		}
+	}
+
+	// Find the kernel the user asked for.
+	workload* kernel = createWorkload(kernelName.c_str(), config);
+
+	if(!kernel)
+	{
+		cout << kernelName << " is not a workload that we know!\n";
+		return 1;
+	}
+
+	// The trace file gets the same name as the spreadsheet.
+	string traceFilename = filename + TRACE_EXTENSION;
+
+	// Append the file extension to the file name we are using.
+	filename += FILE_EXTENSION;
+
+	if(trace && !traceEnable(DEFAULT_TRACE_EVENTS))
+	{
+		cout << "WARNING: The trace recorder could not be turned on.\n";
+		trace = false;
+	}
+
+	cout << "Duration test started! This will take " << seconds << " sec...\n";
+
+	runDurationTest(filename.c_str(), kernel, nThreads, seconds, interval);
+
+	cout << filename << " has been saved in the '"
+		 << SPREADSHEET_FOLDER << "' folder!\n\n";
+
+	if(trace && traceExport(traceFilename.c_str()))
+	{
+		cout << traceFilename << " has been saved in the '"
+			 << SPREADSHEET_FOLDER << "' folder!\n\n";
+	}
+
+	delete kernel;
+	return 0;
+}
+
+// This function reads the arguments for an open loop test and runs it.
+// Every strategy is run at every offered load.
+int openLoopMode(int argc, char** argv)
+{
+	// Set all possible input parameters to their default values.
+	string filename = DEFAULT_FILENAME;
+	unsigned int nThreads = DEFAULT_THREADS;
+	unsigned int minRate = DEFAULT_MIN_RATE;
+	unsigned int maxRate = DEFAULT_MAX_RATE;
+	unsigned int steps = DEFAULT_RATE_STEPS;
+	unsigned int seconds = DEFAULT_OPEN_LOOP_SECS;
+	bool poisson = false;
+	syncType strategies[SYNC_TYPES] = { SYNC_MUTEX, SYNC_SPINLOCK, SYNC_ATOMIC };
+	unsigned int strategyCount = 3;
+	unsigned int csWork = 0;
+	unsigned int parWork = 0;
+
+	for(int i = 2; i < argc; i++)
+	{
+		if(argumentIs(argv[i], "f") && extractFilename(argv[i]))
+		{
+			// The user is specifying a file name.
+			filename = extractFilename(argv[i]);
+		}
+		else if(argumentIs(argv[i], "t"))
+		{
+			// Store the user-defined thread count.
+			nThreads = extractNumber(argv[i]);
+
+			// If the number is out of bounds, throw it out.
+			if((nThreads < MIN_THREADS) || (nThreads > MAX_THREADS))
+			{
+				nThreads = DEFAULT_THREADS;
+			}
+		}
+		else if(argumentIs(argv[i], "rate"))
+		{
+			// Store the user-defined lowest offered load.
+			minRate = extractNumber(argv[i]);
+		}
+		else if(argumentIs(argv[i], "maxrate"))
+		{
+			// Store the user-defined highest offered load.
+			maxRate = extractNumber(argv[i]);
+		}
+		else if(argumentIs(argv[i], "steps"))
+		{
+			// Store the user-defined number of offered loads.
+			steps = extractNumber(argv[i]);
+
+			// If the number is out of bounds, throw it out.
+			if((steps == 0) || (steps > MAX_RATE_STEPS))
+			{
+				steps = DEFAULT_RATE_STEPS;
+			}
+		}
+		else if(argumentIs(argv[i], "secs"))
+		{
+			// Store the user-defined time per offered load.
+			seconds = extractNumber(argv[i]);
+
+			// If the number is out of bounds, throw it out.
+			if((seconds == 0) || (seconds > MAX_DURATION))
+			{
+				seconds = DEFAULT_OPEN_LOOP_SECS;
+			}
+		}
+		else if(extractWork(argv[i], &csWork, &parWork))
+		{
+			// The user wants synthetic work in the operations.
+		}
+		else if(argumentIs(argv[i], "poisson"))
+		{
+			// The user wants random arrivals instead of a fixed rate.
+			poisson = true;
+		}
+		else if(argumentIs(argv[i], "sync"))
+		{
+			// The user is picking the strategies to compare.
+			unsigned int count = syncListFromNames(extractText(argv[i]), strategies);
+
+			if(count)
+			{
+				strategyCount = count;
+			}
+		}
+	}
+
+	// If the rates are out of bounds or backwards, throw them out.
+	if((minRate == 0) || (maxRate > MAX_RATE) || (minRate > maxRate))
+	{
+		minRate = DEFAULT_MIN_RATE;
+		maxRate = DEFAULT_MAX_RATE;
+	}
+
+	// Append the file extension to the file name we are using.
+	filename += FILE_EXTENSION;
+
+	cout << "Open loop test started! This will take about "
+	     << strategyCount*steps*seconds << " sec...\n";
+
+	runOpenLoopTest(filename.c_str(), nThreads, strategies, strategyCount,
+			minRate, maxRate, steps, seconds, poisson, csWork, parWork);
+
+	cout << filename << " has been saved in the '"
+		 << SPREADSHEET_FOLDER << "' folder!\n\n";
+
+	return 0;
+}
+
+// This function reads the arguments for a ping-pong test and runs it.
+// Every mechanism is run pinned and unpinned unless the user picks one.
+int pingPongMode(int argc, char** argv)
+{
+	// Set all possible input parameters to their default values.
+	string filename = DEFAULT_FILENAME;
+	unsigned int pairs = DEFAULT_PAIRS;
+	unsigned int rounds = DEFAULT_ROUNDS;
+	bool pinned = true;
+	bool unpinned = true;
+	wakeType mechanisms[WAKE_TYPES] = { WAKE_CONDVAR, WAKE_FUTEX, WAKE_EVENTFD, WAKE_PIPE, WAKE_SPIN };
+	unsigned int mechanismCount = WAKE_TYPES;
+
+	for(int i = 2; i < argc; i++)
+	{
+		if(argumentIs(argv[i], "f") && extractFilename(argv[i]))
+		{
+			// The user is specifying a file name.
+			filename = extractFilename(argv[i]);
+		}
+		else if(argumentIs(argv[i], "pairs"))
+		{
+			// Store the user-defined number of thread pairs.
+			pairs = extractNumber(argv[i]);
+
+			// If the number is out of bounds, throw it out.
+			if((pairs == 0) || (pairs > MAX_PAIRS))
+			{
+				pairs = DEFAULT_PAIRS;
+			}
+		}
+		else if(argumentIs(argv[i], "rounds"))
+		{
+			// Store the user-defined number of round trips.
+			rounds = extractNumber(argv[i]);
+
+			// If the number is out of bounds, throw it out.
+			if((rounds == 0) || (rounds > MAX_ROUNDS))
+			{
+				rounds = DEFAULT_ROUNDS;
+			}
+		}
+		else if(argumentIs(argv[i], "pinned"))
+		{
+			// The user only wants the pinned runs.
+			pinned = true;
+			unpinned = false;
+		}
+		else if(argumentIs(argv[i], "unpinned"))
+		{
+			// The user only wants the unpinned runs.
+			pinned = false;
+			unpinned = true;
+		}
+		else if(argumentIs(argv[i], "mech"))
+		{
+			// The user is picking the mechanisms to compare.
+			unsigned int count = wakeListFromNames(extractText(argv[i]), mechanisms);
+
+			if(count)
+			{
+				mechanismCount = count;
+			}
+		}
+	}
+
+	// Append the file extension to the file name we are using.
+	filename += FILE_EXTENSION;
+
+	cout << "Ping-pong test started!\n";
+
+	runPingPongTest(filename.c_str(), mechanisms, mechanismCount, pairs, rounds, pinned, unpinned);
+
+	cout << filename << " has been saved in the '"
+		 << SPREADSHEET_FOLDER << "' folder!\n\n";
+
+	return 0;
+}
+
+// This function reads the arguments for an oversubscription test and runs
+// it. Every strategy is run at every number of threads per CPU.
+int oversubscribeMode(int argc, char** argv)
+{
+	// Set all possible input parameters to their default values.
+	string filename = DEFAULT_FILENAME;
+	unsigned int maxFactor = DEFAULT_OVERSUB_FACTOR;
+	unsigned int seconds = DEFAULT_OVERSUB_SECS;
+	syncType strategies[SYNC_TYPES] = { SYNC_MUTEX, SYNC_SPINLOCK, SYNC_TAS, SYNC_ATOMIC };
+	unsigned int strategyCount = 4;
+	unsigned int csWork = 0;
+	unsigned int parWork = 0;
+
+	for(int i = 2; i < argc; i++)
+	{
+		if(argumentIs(argv[i], "f") && extractFilename(argv[i]))
+		{
+			// The user is specifying a file name.
+			filename = extractFilename(argv[i]);
+		}
+		else if(argumentIs(argv[i], "factor"))
+		{
+			// Store the user-defined most threads per CPU.
+			maxFactor = extractNumber(argv[i]);
+
+			// If the number is out of bounds, throw it out.
+			if((maxFactor == 0) || (maxFactor > MAX_OVERSUB_FACTOR))
+			{
+				maxFactor = DEFAULT_OVERSUB_FACTOR;
+			}
+		}
+		else if(argumentIs(argv[i], "secs"))
+		{
+			// Store the user-defined time per run.
+			seconds = extractNumber(argv[i]);
+
+			// If the number is out of bounds, throw it out.
+			if((seconds == 0) || (seconds > MAX_DURATION))
+			{
+				seconds = DEFAULT_OVERSUB_SECS;
+			}
+		}
+		else if(extractWork(argv[i], &csWork, &parWork))
+		{
+			// The user wants synthetic work in the operations.
+		}
+		else if(argumentIs(argv[i], "sync"))
+		{
+			// The user is picking the strategies to compare.
+			unsigned int count = syncListFromNames(extractText(argv[i]), strategies);
+
+			if(count)
+			{
+				strategyCount = count;
+			}
+		}
+	}
+
+	// Append the file extension to the file name we are using.
+	filename += FILE_EXTENSION;
+
+	cout << "Oversubscription test started! This will take about "
+	     << strategyCount*maxFactor*seconds << " sec...\n";
+
+	runOversubscribeTest(filename.c_str(), strategies, strategyCount, maxFactor, seconds, csWork, parWork);
+
+	cout << filename << " has been saved in the '"
+		 << SPREADSHEET_FOLDER << "' folder!\n\n";
+
+	return 0;
+}
+
+// This function reads the arguments for a memory test and runs it. Both
+// patterns are run unless the user picks one.
+int memoryMode(int argc, char** argv)
+{
+	// Set all possible input parameters to their default values. The
+	// most threads defaults to one per online CPU.
+	string filename = DEFAULT_FILENAME;
+	unsigned int nThreads = sysconf(_SC_NPROCESSORS_ONLN);
+	unsigned int llcMultiple = DEFAULT_LLC_MULTIPLE;
+	unsigned int cellMsecs = DEFAULT_MEMORY_MSECS;
+	accessPattern patterns[ACCESS_PATTERNS] = { ACCESS_STREAM, ACCESS_RANDOM };
+	unsigned int patternCount = ACCESS_PATTERNS;
+	pageType pages = PAGES_NORMAL;
+
+	if((nThreads < MIN_THREADS) || (nThreads > MAX_THREADS))
+	{
+		nThreads = MAX_THREADS;
+	}
+
+	for(int i = 2; i < argc; i++)
+	{
+		if(argumentIs(argv[i], "f") && extractFilename(argv[i]))
+		{
+			// The user is specifying a file name.
+			filename = extractFilename(argv[i]);
+		}
+		else if(argumentIs(argv[i], "t"))
+		{
+			// Store the user-defined most threads.
+			unsigned int number = extractNumber(argv[i]);
+
+			// If the number is out of bounds, throw it out.
+			if((number >= MIN_THREADS) && (number <= MAX_THREADS))
+			{
+				nThreads = number;
+			}
+		}
+		else if(argumentIs(argv[i], "llcx"))
+		{
+			// Store the user-defined biggest buffer, in LLCs.
+			llcMultiple = extractNumber(argv[i]);
+
+			// If the number is out of bounds, throw it out.
+			if((llcMultiple == 0) || (llcMultiple > MAX_LLC_MULTIPLE))
+			{
+				llcMultiple = DEFAULT_LLC_MULTIPLE;
+			}
+		}
+		else if(argumentIs(argv[i], "ms"))
+		{
+			// Store the user-defined time per cell.
+			cellMsecs = extractNumber(argv[i]);
+
+			// If the number is out of bounds, throw it out.
+			if((cellMsecs == 0) || (cellMsecs > MAX_MEMORY_MSECS))
+			{
+				cellMsecs = DEFAULT_MEMORY_MSECS;
+			}
+		}
+		else if(argumentIs(argv[i], "stream"))
+		{
+			// The user only wants the bandwidth.
+			patterns[0] = ACCESS_STREAM;
+			patternCount = 1;
+		}
+		else if(argumentIs(argv[i], "random"))
+		{
+			// The user only wants the latency.
+			patterns[0] = ACCESS_RANDOM;
+			patternCount = 1;
+		}
+		else if(argumentIs(argv[i], "thp"))
+		{
+			// The user wants transparent huge pages.
+			pages = PAGES_THP;
+		}
+		else if(argumentIs(argv[i], "hugetlb"))
+		{
+			// The user wants explicit huge pages.
+			pages = PAGES_HUGETLB;
+		}
+	}
+
+	// Append the file extension to the file name we are using.
+	filename += FILE_EXTENSION;
+
+	cout << "Memory test started!\n";
+
+	runMemorySweep(filename.c_str(), patterns, patternCount, nThreads, llcMultiple, pages, cellMsecs);
+
+	cout << filename << " has been saved in the '"
+		 << SPREADSHEET_FOLDER << "' folder!\n\n";
+
+	return 0;
+}
+
+// This function reads the arguments for a NUMA test and runs it. The
+// buffers default to twice the last level cache, so they can't hide in it.
+int numaMode(int argc, char** argv)
+{
+	// Set all possible input parameters to their default values. The
+	// threads default to one per online CPU.
+	string filename = DEFAULT_FILENAME;
+	unsigned int nThreads = sysconf(_SC_NPROCESSORS_ONLN);
+	unsigned int bufferMbytes = 0;
+	unsigned int msecs = DEFAULT_NUMA_MSECS;
+
+	if((nThreads < MIN_THREADS) || (nThreads > MAX_THREADS))
+	{
+		nThreads = MAX_THREADS;
+	}
+
+	for(int i = 2; i < argc; i++)
+	{
+		if(argumentIs(argv[i], "f") && extractFilename(argv[i]))
+		{
+			// The user is specifying a file name.
+			filename = extractFilename(argv[i]);
+		}
+		else if(argumentIs(argv[i], "t"))
+		{
+			// Store the user-defined thread count.
+			unsigned int number = extractNumber(argv[i]);
+
+			// If the number is out of bounds, throw it out.
+			if((number >= MIN_THREADS) && (number <= MAX_THREADS))
+			{
+				nThreads = number;
+			}
+		}
+		else if(argumentIs(argv[i], "mb"))
+		{
+			// Store the user-defined buffer size.
+			bufferMbytes = extractNumber(argv[i]);
+
+			// If the number is out of bounds, throw it out.
+			if(bufferMbytes > MAX_NUMA_BUFFER_MB)
+			{
+				bufferMbytes = 0;
+			}
+		}
+		else if(argumentIs(argv[i], "ms"))
+		{
+			// Store the user-defined time per measurement.
+			msecs = extractNumber(argv[i]);
+
+			// If the number is out of bounds, throw it out.
+			if((msecs == 0) || (msecs > MAX_MEMORY_MSECS))
+			{
+				msecs = DEFAULT_NUMA_MSECS;
+			}
+		}
+	}
+
+	unsigned long long bufferBytes = (unsigned long long)bufferMbytes*1024ULL*1024ULL;
+	if(bufferBytes == 0)
+	{
+		unsigned long long l1Size, llcSize;
+		findCacheSizes(&l1Size, &llcSize);
+		bufferBytes = 2*llcSize;
+	}
+
+	// Append the file extension to the file name we are using.
+	filename += FILE_EXTENSION;
+
+	cout << "NUMA test started!\n";
+
+	runNumaTest(filename.c_str(), nThreads, bufferBytes, msecs);
+
+	cout << filename << " has been saved in the '"
+		 << SPREADSHEET_FOLDER << "' folder!\n\n";
+
+	return 0;
+}
+
+// This function reads the arguments for a hash map test and runs it. Every
+// map is compared on a read mostly mix and an even mix unless the user
+// picks their own.
+int hashMapMode(int argc, char** argv)
+{
+	// Set all possible input parameters to their default values. The
+	// most threads defaults to one per online CPU.
+	string filename = DEFAULT_FILENAME;
+	unsigned int nThreads = sysconf(_SC_NPROCESSORS_ONLN);
+	unsigned long long maxKeys = DEFAULT_MAP_KEYS;
+	unsigned int cellMsecs = DEFAULT_MAP_MSECS;
+	mapType maps[MAP_TYPES] = { MAP_LOCKED, MAP_STRIPED, MAP_LOCKFREE };
+	unsigned int mapCount = MAP_TYPES;
+	mapMix mixes[MAX_MAP_MIXES] = { { 90, 5, 5 }, { 50, 25, 25 } };
+	unsigned int mixCount = 2;
+
+	if((nThreads < MIN_THREADS) || (nThreads > MAX_THREADS))
+	{
+		nThreads = MAX_THREADS;
+	}
+
+	for(int i = 2; i < argc; i++)
+	{
+		if(argumentIs(argv[i], "f") && extractFilename(argv[i]))
+		{
+			// The user is specifying a file name.
+			filename = extractFilename(argv[i]);
+		}
+		else if(argumentIs(argv[i], "t"))
+		{
+			// Store the user-defined most threads.
+			unsigned int number = extractNumber(argv[i]);
+
+			// If the number is out of bounds, throw it out.
+			if((number >= MIN_THREADS) && (number <= MAX_THREADS))
+			{
+				nThreads = number;
+			}
+		}
+		else if(argumentIs(argv[i], "keys"))
+		{
+			// Store the user-defined most keys.
+			unsigned int number = extractNumber(argv[i]);
+
+			// If the number is out of bounds, throw it out.
+			if((number >= MIN_MAP_KEYS) && (number <= MAX_MAP_KEYS))
+			{
+				maxKeys = number;
+			}
+		}
+		else if(argumentIs(argv[i], "ms"))
+		{
+			// Store the user-defined time per cell.
+			cellMsecs = extractNumber(argv[i]);
+
+			// If the number is out of bounds, throw it out.
+			if((cellMsecs == 0) || (cellMsecs > MAX_MAP_MSECS))
+			{
+				cellMsecs = DEFAULT_MAP_MSECS;
+			}
+		}
+		else if(argumentIs(argv[i], "maps"))
+		{
+			// The user is picking the maps to compare.
+			unsigned int count = mapListFromNames(extractText(argv[i]), maps);
+
+			if(count)
+			{
+				mapCount = count;
+			}
+		}
+		else if(argumentIs(argv[i], "mix"))
+		{
+			// The user is picking the mixes of operations.
+			unsigned int count = mapMixesFromText(extractText(argv[i]), mixes);
+
+			if(count)
+			{
+				mixCount = count;
+			}
+		}
+	}
+
+	// Append the file extension to the file name we are using.
+	filename += FILE_EXTENSION;
+
+	cout << "Hash map test started!\n";
+
+	runHashMapTest(filename.c_str(), maps, mapCount, mixes, mixCount, maxKeys, nThreads, cellMsecs);
+
+	cout << filename << " has been saved in the '"
+		 << SPREADSHEET_FOLDER << "' folder!\n\n";
+
+	return 0;
+}
+
+// This function reads the arguments for a stack test and runs it. Every
+// stack is compared unless the user picks some.
+int stackMode(int argc, char** argv)
+{
+	// Set all possible input parameters to their default values. The
+	// most threads defaults to one per online CPU.
+	string filename = DEFAULT_FILENAME;
+	unsigned int nThreads = sysconf(_SC_NPROCESSORS_ONLN);
+	unsigned int cellMsecs = DEFAULT_STACK_MSECS;
+	stackType stacks[STACK_TYPES] = { STACK_MUTEX, STACK_LEAK, STACK_HAZARD, STACK_EPOCH };
+	unsigned int stackCount = STACK_TYPES;
+
+	if((nThreads < MIN_THREADS) || (nThreads > MAX_THREADS))
+	{
+		nThreads = MAX_THREADS;
+	}
+
+	for(int i = 2; i < argc; i++)
+	{
+		if(argumentIs(argv[i], "f") && extractFilename(argv[i]))
+		{
+			// The user is specifying a file name.
+			filename = extractFilename(argv[i]);
+		}
+		else if(argumentIs(argv[i], "t"))
+		{
+			// Store the user-defined most threads.
+			unsigned int number = extractNumber(argv[i]);
+
+			// If the number is out of bounds, throw it out.
+			if((number >= MIN_THREADS) && (number <= MAX_THREADS))
+			{
+				nThreads = number;
+			}
+		}
+		else if(argumentIs(argv[i], "ms"))
+		{
+			// Store the user-defined time per cell.
+			cellMsecs = extractNumber(argv[i]);
+
+			// If the number is out of bounds, throw it out.
+			if((cellMsecs == 0) || (cellMsecs > MAX_STACK_MSECS))
+			{
+				cellMsecs = DEFAULT_STACK_MSECS;
+			}
+		}
+		else if(argumentIs(argv[i], "stacks"))
+		{
+			// The user is picking the stacks to compare.
+			unsigned int count = stackListFromNames(extractText(argv[i]), stacks);
+
+			if(count)
+			{
+				stackCount = count;
+			}
+		}
+	}
+
+	// Append the file extension to the file name we are using.
+	filename += FILE_EXTENSION;
+
+	cout << "Stack test started!\n";
+
+	runStackTest(filename.c_str(), stacks, stackCount, nThreads, cellMsecs);
+
+	cout << filename << " has been saved in the '"
+		 << SPREADSHEET_FOLDER << "' folder!\n\n";
+
+	return 0;
+}
+
+// This function reads the arguments for a phased test and runs it. Every
+// barrier is compared unless the user picks some.
+int phasedMode(int argc, char** argv)
+{
+	// Set all possible input parameters to their default values. The
+	// most threads defaults to one per online CPU.
+	string filename = DEFAULT_FILENAME;
+	unsigned int nThreads = sysconf(_SC_NPROCESSORS_ONLN);
+	unsigned int phases = DEFAULT_PHASES;
+	unsigned int sliceOps = DEFAULT_SLICE_OPS;
+	barrierType barriers[BARRIER_TYPES] = { BARRIER_PTHREAD, BARRIER_CENTRAL, BARRIER_DISSEMINATION, BARRIER_TOURNAMENT };
+	unsigned int barrierCount = BARRIER_TYPES;
+
+	if((nThreads < MIN_THREADS) || (nThreads > MAX_THREADS))
+	{
+		nThreads = MAX_THREADS;
+	}
+
+	for(int i = 2; i < argc; i++)
+	{
+		if(argumentIs(argv[i], "f") && extractFilename(argv[i]))
+		{
+			// The user is specifying a file name.
+			filename = extractFilename(argv[i]);
+		}
+		else if(argumentIs(argv[i], "t"))
+		{
+			// Store the user-defined most threads.
+			unsigned int number = extractNumber(argv[i]);
+
+			// If the number is out of bounds, throw it out.
+			if((number >= MIN_THREADS) && (number <= MAX_THREADS))
+			{
+				nThreads = number;
+			}
+		}
+		else if(argumentIs(argv[i], "phases"))
+		{
+			// Store the user-defined phases per run.
+			phases = extractNumber(argv[i]);
+
+			// If the number is out of bounds, throw it out.
+			if((phases == 0) || (phases > MAX_PHASES))
+			{
+				phases = DEFAULT_PHASES;
+			}
+		}
+		else if(argumentIs(argv[i], "slice"))
+		{
+			// Store the user-defined operations per phase. A slice
+			// of nothing is allowed, to time the barrier alone.
+			sliceOps = extractNumber(argv[i]);
+
+			// If the number is out of bounds, throw it out.
+			if(sliceOps > MAX_SLICE_OPS)
+			{
+				sliceOps = DEFAULT_SLICE_OPS;
+			}
+		}
+		else if(argumentIs(argv[i], "barriers"))
+		{
+			// The user is picking the barriers to compare.
+			unsigned int count = barrierListFromNames(extractText(argv[i]), barriers);
+
+			if(count)
+			{
+				barrierCount = count;
+			}
+		}
+	}
+
+	// Append the file extension to the file name we are using.
+	filename += FILE_EXTENSION;
+
+	cout << "Phased test started!\n";
+
+	runPhasedTest(filename.c_str(), barriers, barrierCount, nThreads, phases, sliceOps);
+
+	cout << filename << " has been saved in the '"
+		 << SPREADSHEET_FOLDER << "' folder!\n\n";
+
+	return 0;
+}
+
+// This function reads the arguments for a random number test and runs it.
+// Every generator is compared unless the user picks some.
+int randomMode(int argc, char** argv)
+{
+	// Set all possible input parameters to their default values. The
+	// most threads defaults to one per online CPU.
+	string filename = DEFAULT_FILENAME;
+	unsigned int nThreads = sysconf(_SC_NPROCESSORS_ONLN);
+	unsigned int cellMsecs = DEFAULT_RANDOM_MSECS;
+	unsigned int csNsecs = 0, parNsecs = 0;
+	randomType generators[RANDOM_TYPES] = { RANDOM_XOSHIRO, RANDOM_RANDOM_R, RANDOM_RAND, RANDOM_SHARED_R };
+	unsigned int generatorCount = RANDOM_TYPES;
+
+	if((nThreads < MIN_THREADS) || (nThreads > MAX_THREADS))
+	{
+		nThreads = MAX_THREADS;
+	}
+
+	for(int i = 2; i < argc; i++)
+	{
+		if(argumentIs(argv[i], "f") && extractFilename(argv[i]))
+		{
+			// The user is specifying a file name.
+			filename = extractFilename(argv[i]);
+		}
+		else if(argumentIs(argv[i], "t"))
+		{
+			// Store the user-defined most threads.
+			unsigned int number = extractNumber(argv[i]);
+
+			// If the number is out of bounds, throw it out.
+			if((number >= MIN_THREADS) && (number <= MAX_THREADS))
+			{
+				nThreads = number;
+			}
+		}
+		else if(argumentIs(argv[i], "ms"))
+		{
+			// Store the user-defined time per cell.
+			cellMsecs = extractNumber(argv[i]);
+
+			// If the number is out of bounds, throw it out.
+			if((cellMsecs == 0) || (cellMsecs > MAX_RANDOM_MSECS))
+			{
+				cellMsecs = DEFAULT_RANDOM_MSECS;
+			}
+		}
+		else if(extractWork(argv[i], &csNsecs, &parNsecs))
+		{
+			// The user wants synthetic work between draws. There is
+			// no critical section, so -csns is read but not used.
+		}
+		else if(argumentIs(argv[i], "rngs"))
+		{
+			// The user is picking the generators to compare.
+			unsigned int count = randomListFromNames(extractText(argv[i]), generators);
+
+			if(count)
+			{
+				generatorCount = count;
+			}
+		}
+	}
+
+	// Append the file extension to the file name we are using.
+	filename += FILE_EXTENSION;
+
+	cout << "Random number test started!\n";
+
+	runRandomTest(filename.c_str(), generators, generatorCount, nThreads, cellMsecs, parNsecs);
+
+	cout << filename << " has been saved in the '"
+		 << SPREADSHEET_FOLDER << "' folder!\n\n";
+
+	return 0;
+}
+
+// This function reads the arguments for the tuner and runs it. The workload
+// is picked the same way as for the duration test, and every strategy but
+// none is tried unless the user picks some.
+int tuneMode(int argc, char** argv)
+{
+	// Set all possible input parameters to their default values. The
+	// most threads defaults to one per online CPU.
+	string filename = DEFAULT_FILENAME;
+	string kernelName = "increment";
+	unsigned int nThreads = sysconf(_SC_NPROCESSORS_ONLN);
+	unsigned int budget = DEFAULT_TUNE_BUDGET;
+	syncType strategies[SYNC_TYPES] = { SYNC_MUTEX, SYNC_SPINLOCK, SYNC_TAS, SYNC_ATOMIC };
+	unsigned int strategyCount = 4;
+	workloadConfig config;
+
+	if((nThreads < MIN_THREADS) || (nThreads > MAX_THREADS))
+	{
+		nThreads = MAX_THREADS;
+	}
+
+	for(int i = 2; i < argc; i++)
+	{
+		if(argumentIs(argv[i], "f") && extractFilename(argv[i]))
+		{
+			// The user is specifying a file name.
+			filename = extractFilename(argv[i]);
+		}
+		else if(argumentIs(argv[i], "t"))
+		{
+			// Store the user-defined most threads.
+			unsigned int number = extractNumber(argv[i]);
+
+			// If the number is out of bounds, throw it out.
+			if((number >= MIN_THREADS) && (number <= MAX_THREADS))
+			{
+				nThreads = number;
+			}
+		}
+		else if(argumentIs(argv[i], "budget"))
+		{
+			// Store the user-defined search budget.
+			budget = extractNumber(argv[i]);
+
+			// If the number is out of bounds, throw it out.
+			if((budget == 0) || (budget > MAX_BUDGET))
+			{
+				budget = DEFAULT_TUNE_BUDGET;
+			}
+		}
+		else if(argumentIs(argv[i], "workload") && extractFilename(argv[i]))
+		{
+			// The user is picking the kernel.
+			kernelName = extractFilename(argv[i]);
+		}
+		else if(extractWork(argv[i], &config.csNsecs, &config.parNsecs))
+		{
+			// The user wants synthetic work in the operations.
+		}
+		else if(argumentIs(argv[i], "sh"))
+		{
+			// The user wants shared variable usage.
+			config.shared = true;
+		}
+		else if(argumentIs(argv[i], "saf"))
+		{
+			// The user wants thread safety.
+			config.safe = true;
+		}
+		else if(argumentIs(argv[i], "syncs"))
+		{
+			// The user is picking the strategies to try.
+			unsigned int count = syncListFromNames(extractText(argv[i]), strategies);
+
+			if(count)
+			{
+				strategyCount = count;
+			}
+		}
+	}
+
+	// Append the file extension to the file name we are using.
+	filename += FILE_EXTENSION;
+
+	cout << "Tuner started!\n";
+
+	if(!runAutoTune(filename.c_str(), kernelName.c_str(), config, strategies, strategyCount, nThreads, budget))
+	{
+		cout << kernelName << " is not a workload that we know!\n";
+		return 1;
+	}
+
+	cout << filename << " has been saved in the '"
+		 << SPREADSHEET_FOLDER << "' folder!\n\n";
+
+	return 0;
+}
+
+// This function reads the arguments for the compare mode and runs it. The
+// baseline and candidate are binary results files in the spreadsheet folder,
+// named without their extension. It exits with 2 if there is a regression,
+// so that a script can stop on it, and 1 if the files can't be compared.
+int compareMode(int argc, char** argv)
+{
+	// Set all possible input parameters to their default values.
+	string filename = DEFAULT_FILENAME;
+	string baseName, candidateName;
+	unsigned int alpha = DEFAULT_ALPHA_PERCENT;
+	unsigned int threshold = DEFAULT_REGRESSION_PERCENT;
+
+	for(int i = 2; i < argc; i++)
+	{
+		if(argumentIs(argv[i], "f") && extractFilename(argv[i]))
+		{
+			// The user is specifying a file name.
+			filename = extractFilename(argv[i]);
+		}
+		else if(argumentIs(argv[i], "base") && extractFilename(argv[i]))
+		{
+			// The user is naming the baseline results.
+			baseName = extractFilename(argv[i]);
+		}
+		else if(argumentIs(argv[i], "cand") && extractFilename(argv[i]))
+		{
+			// The user is naming the candidate results.
+			candidateName = extractFilename(argv[i]);
+		}
+		else if(argumentIs(argv[i], "alpha"))
+		{
+			// Store the user-defined false discovery rate.
+			alpha = extractNumber(argv[i]);
+
+			// If the number is out of bounds, throw it out.
+			if((alpha == 0) || (alpha >= 100))
+			{
+				alpha = DEFAULT_ALPHA_PERCENT;
+			}
+		}
+		else if(argumentIs(argv[i], "threshold"))
+		{
+			// Store the user-defined slowdown that counts as a regression.
+			threshold = extractNumber(argv[i]);
+		}
+	}
+
+	if(baseName.empty() || candidateName.empty())
+	{
+		cout << "The compare mode needs a baseline (-base=name) and a candidate (-cand=name)!\n";
+		return 1;
+	}
+
+	// The results files live in the spreadsheet folder.
+	string basePath = SPREADSHEET_FOLDER;
+	basePath += "/";
+	basePath += baseName + BINARY_EXTENSION;
+
+	string candidatePath = SPREADSHEET_FOLDER;
+	candidatePath += "/";
+	candidatePath += candidateName + BINARY_EXTENSION;
+
+	// Append the file extension to the file name we are using.
+	filename += FILE_EXTENSION;
+
+	int regressions = compareResults(basePath.c_str(), candidatePath.c_str(), filename.c_str(), alpha, threshold);
+
+	if(regressions < 0)
+	{
+		return 1;
+	}
+
+	cout << filename << " has been saved in the '"
+		 << SPREADSHEET_FOLDER << "' folder!\n\n";
+
+	return ((regressions > 0) ? 2 : 0);
+}
+
+// This function reads the arguments for a thread local storage test and
+// runs it. Every way is compared unless the user picks some.
+int tlsMode(int argc, char** argv)
+{
+	// Set all possible input parameters to their default values. The
+	// most threads defaults to one per online CPU.
+	string filename = DEFAULT_FILENAME;
+	string modulePath = TLS_MODULE_PATH;
+	unsigned int nThreads = sysconf(_SC_NPROCESSORS_ONLN);
+	unsigned int cellMsecs = DEFAULT_TLS_MSECS;
+	tlsType mechanisms[TLS_TYPES] = { TLS_CONTEXT, TLS_THREAD_LOCAL, TLS_GETSPECIFIC, TLS_DYNAMIC };
+	unsigned int mechanismCount = TLS_TYPES;
+
+	if((nThreads < MIN_THREADS) || (nThreads > MAX_THREADS))
+	{
+		nThreads = MAX_THREADS;
+	}
+
+	for(int i = 2; i < argc; i++)
+	{
+		if(argumentIs(argv[i], "f") && extractFilename(argv[i]))
+		{
+			// The user is specifying a file name.
+			filename = extractFilename(argv[i]);
+		}
+		else if(argumentIs(argv[i], "t"))
+		{
+			// Store the user-defined most threads.
+			unsigned int number = extractNumber(argv[i]);
+
+			// If the number is out of bounds, throw it out.
+			if((number >= MIN_THREADS) && (number <= MAX_THREADS))
+			{
+				nThreads = number;
+			}
+		}
+		else if(argumentIs(argv[i], "ms"))
+		{
+			// Store the user-defined time per cell.
+			cellMsecs = extractNumber(argv[i]);
+
+			// If the number is out of bounds, throw it out.
+			if((cellMsecs == 0) || (cellMsecs > MAX_TLS_MSECS))
+			{
+				cellMsecs = DEFAULT_TLS_MSECS;
+			}
+		}
+		else if(argumentIs(argv[i], "ways"))
+		{
+			// The user is picking the ways to compare.
+			unsigned int count = tlsListFromNames(extractText(argv[i]), mechanisms);
+
+			if(count)
+			{
+				mechanismCount = count;
+			}
+		}
+		else if(argumentIs(argv[i], "module") && (*extractText(argv[i]) != '\0'))
+		{
+			// The user is saying where the shared object is.
+			modulePath = extractText(argv[i]);
+		}
+	}
+
+	// Append the file extension to the file name we are using.
+	filename += FILE_EXTENSION;
+
+	cout << "Thread local storage test started!\n";
+
+	runTlsTest(filename.c_str(), mechanisms, mechanismCount, nThreads, cellMsecs, modulePath.c_str());
+
+	cout << filename << " has been saved in the '"
+		 << SPREADSHEET_FOLDER << "' folder!\n\n";
+
+	return 0;
+}
+
+// This function reads the arguments for the scenario mode and runs it. The
+// scenario file comes after the '=' of -scenario, and every scenario in it
+// is run as an automatic test, one after another, in this process. What the
+// process has warmed up, like the result cache, the records of the data
+// workloads and the CPUs themselves, carries over from one scenario to the
+// next. Every cell of every scenario also goes into one combined file.
+int scenarioMode(int argc, char** argv)
+{
+	// Set all possible input parameters to their default values.
+	string filename = DEFAULT_FILENAME;
+	const char* path = extractText(argv[1]);
+	vector<scenarioSpec> scenarios;
+
+	for(int i = 2; i < argc; i++)
+	{
+		if(argumentIs(argv[i], "f") && extractFilename(argv[i]))
+		{
+			// The user is specifying a name for the combined file.
+			filename = extractFilename(argv[i]);
+		}
+	}
+
+	if(*path == '\0')
+	{
+		cout << "Which scenario file? Use -scenario=<file>.\n";
+		return 1;
+	}
+
+	// Read every scenario before running any of them, so that a mistake
+	// at the end of the file doesn't show up hours into the run.
+	if(!loadScenarios(path, scenarios))
+	{
+		return 1;
+	}
+
+	filename += SCENARIO_EXTENSION;
+
+	if(!enableCombinedResults(filename.c_str()))
+	{
+		cout << "WARNING: The combined results file could not be opened.\n";
+	}
+
+	cout << scenarios.size() << " scenario" << ((scenarios.size() == 1) ? "" : "s")
+	     << " loaded from " << path << ".\n\n";
+
+	unsigned long long startNsecs = timeStamp::monotonicNsecs();
+
+	for(unsigned int s = 0; s < scenarios.size(); s++)
+	{
+		// Build the arguments the way they would come from the command
+		// line, with the program name first.
+		vector<char*> arguments;
+		arguments.push_back(argv[0]);
+		for(unsigned int a = 0; a < scenarios[s].arguments.size(); a++)
+		{
+			arguments.push_back((char*)scenarios[s].arguments[a].c_str());
+		}
+
+		cout << "Scenario " << (s + 1) << " of " << scenarios.size() << ": " << scenarios[s].name << "\n";
+
+		setCombinedScenario(scenarios[s].name.c_str());
+		autoMode(arguments.size(), &arguments[0]);
+	}
+
+	finishCombinedResults();
+	releaseDataRecords();
+
+	cout << "All of the scenarios ran in "
+	     << (double)(timeStamp::monotonicNsecs() - startNsecs)/1000000000.0 << " seconds.\n";
+	cout << filename << " has been saved in the '"
+		 << SPREADSHEET_FOLDER << "' folder!\n\n";
+
+	return 0;
+}
+
+// This function reads the arguments for the live stats reader and runs it.
+// It prints every running test that publishes live stats (or just the one
+// given with -stats=pid), once, or every second with -watch.
+int statsMode(int argc, char** argv)
+{
+	int pid = atoi(extractText(argv[1]));
+	bool watch = false;
+	bool prometheus = false;
+
+	for(int i = 2; i < argc; i++)
+	{
+		if(argumentIs(argv[i], "watch"))
+		{
+			// The user wants to keep watching.
+			watch = true;
+		}
+		else if(argumentIs(argv[i], "prom"))
+		{
+			// The user wants it in a form that Prometheus can scrape.
+			prometheus = true;
+		}
+	}
+
+	while(true)
+	{
+		if(liveStatsPrint(pid, prometheus) == 0)
+		{
+			if(!prometheus)
+			{
+				cout << "No running tests are publishing live stats.\n";
+			}
+
+			return (watch ? 0 : 1);
+		}
+
+		if(!watch)
+		{
+			return 0;
+		}
+
+		cout << "\n";
+		cout.flush();
+		sleep(1);
+	}
+}